@@ -0,0 +1,239 @@
+#include "actionprogram.h"
+
+/**
+ * @brief Compact bytecode of an action sequence, executed by ActionVM.
+ *
+ * @details Every instruction is a fixed-size record of an opcode, a loop slot and four integer operands.
+ * Jump targets are instruction indices stored in operand d, so a finished program needs no further
+ * resolution and the interpreter never allocates. Point patterns used by SetPointPattern, area shapes used by
+ * SetPointShape and texts used by TypeText are stored next to the code and referenced by index.
+ */
+
+/**
+ * @brief Appends an instruction.
+ *
+ * @return The index of the new instruction, used to patch jump targets later.
+ */
+
+int ActionProgram::append(OpCode op, qint32 a, qint32 b, qint32 c, qint32 d, quint8 slot)
+{
+    Instruction instruction;
+    instruction.op = op;
+    instruction.slot = slot;
+    instruction.a = a;
+    instruction.b = b;
+    instruction.c = c;
+    instruction.d = d;
+    code.append(instruction);
+    return code.size() - 1;
+}
+
+/**
+ * @brief Returns the instruction at the given index for patching.
+ */
+
+Instruction& ActionProgram::at(int index)
+{
+    return code[index];
+}
+
+/**
+ * @brief Returns a pointer to the first instruction.
+ */
+
+const Instruction* ActionProgram::data() const
+{
+    return code.constData();
+}
+
+/**
+ * @brief Returns the number of instructions.
+ */
+
+int ActionProgram::size() const
+{
+    return code.size();
+}
+
+/**
+ * @brief Adds a point pattern for SetPointPattern instructions.
+ *
+ * @return The pattern index, or -1 if the program already holds maxPatterns patterns.
+ */
+
+int ActionProgram::addPattern(const PointPattern& pattern)
+{
+    if (patterns.size() >= maxPatterns)
+    {
+        return -1;
+    }
+    patterns.append(pattern);
+    return patterns.size() - 1;
+}
+
+/**
+ * @brief Returns the pattern with the given index for replacement.
+ */
+
+PointPattern& ActionProgram::pattern(int index)
+{
+    return patterns[index];
+}
+
+/**
+ * @brief Returns the pattern with the given index.
+ */
+
+const PointPattern& ActionProgram::pattern(int index) const
+{
+    return patterns.at(index);
+}
+
+/**
+ * @brief Returns the number of patterns.
+ */
+
+int ActionProgram::patternCount() const
+{
+    return patterns.size();
+}
+
+/**
+ * @brief Adds an area shape for SetPointShape instructions.
+ *
+ * @return The shape index, or -1 if the program already holds maxShapes shapes.
+ */
+
+int ActionProgram::addShape(const AreaSampler& shape)
+{
+    if (shapes.size() >= maxShapes)
+    {
+        return -1;
+    }
+    shapes.append(shape);
+    return shapes.size() - 1;
+}
+
+/**
+ * @brief Returns the shape with the given index.
+ */
+
+const AreaSampler& ActionProgram::shape(int index) const
+{
+    return shapes.at(index);
+}
+
+/**
+ * @brief Returns the number of shapes.
+ */
+
+int ActionProgram::shapeCount() const
+{
+    return shapes.size();
+}
+
+/**
+ * @brief Adds a translated text for TypeText instructions.
+ *
+ * @return The text index, or -1 if the program already holds maxTexts texts.
+ */
+
+int ActionProgram::addText(const KeySequence& text)
+{
+    if (texts.size() >= maxTexts)
+    {
+        return -1;
+    }
+    texts.append(text);
+    return texts.size() - 1;
+}
+
+/**
+ * @brief Returns the text with the given index.
+ */
+
+const KeySequence& ActionProgram::text(int index) const
+{
+    return texts.at(index);
+}
+
+/**
+ * @brief Returns the number of texts.
+ */
+
+int ActionProgram::textCount() const
+{
+    return texts.size();
+}
+
+/**
+ * @brief Checks whether the program contains the given opcode, e.g. to decide which resources a job needs.
+ */
+
+bool ActionProgram::uses(OpCode op) const
+{
+    for (const Instruction& instruction : code)
+    {
+        if (instruction.op == op)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Returns a 64-bit FNV-1a hash of all instructions, identifying the program e.g. in a checkpoint.
+ */
+
+quint64 ActionProgram::fingerprint() const
+{
+    quint64 hash = 0xCBF29CE484222325ULL;
+    auto mix = [&hash](quint32 value)
+    {
+        for (int shift = 0; shift < 32; shift += 8)
+        {
+            hash = (hash ^ ((value >> shift) & 0xFF)) * 0x100000001B3ULL;
+        }
+    };
+
+    for (const Instruction& instruction : code)
+    {
+        mix(static_cast<quint32>(instruction.op) | (static_cast<quint32>(instruction.slot) << 8));
+        mix(static_cast<quint32>(instruction.a));
+        mix(static_cast<quint32>(instruction.b));
+        mix(static_cast<quint32>(instruction.c));
+        mix(static_cast<quint32>(instruction.d));
+    }
+    for (const PointPattern& pattern : patterns)
+    {
+        quint64 patternHash = pattern.fingerprint();
+        mix(static_cast<quint32>(patternHash));
+        mix(static_cast<quint32>(patternHash >> 32));
+    }
+    for (const AreaSampler& shape : shapes)
+    {
+        quint64 shapeHash = shape.fingerprint();
+        mix(static_cast<quint32>(shapeHash));
+        mix(static_cast<quint32>(shapeHash >> 32));
+    }
+    for (const KeySequence& text : texts)
+    {
+        quint64 textHash = text.fingerprint();
+        mix(static_cast<quint32>(textHash));
+        mix(static_cast<quint32>(textHash >> 32));
+    }
+    return hash;
+}
+
+/**
+ * @brief Removes all instructions, keeping the allocated capacity.
+ */
+
+void ActionProgram::clear()
+{
+    code.resize(0);
+    patterns.clear();
+    shapes.clear();
+    texts.clear();
+}
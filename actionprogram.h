@@ -0,0 +1,78 @@
+#ifndef ACTIONPROGRAM_H
+#define ACTIONPROGRAM_H
+
+#include <QtGlobal>
+#include "areasampler.h"
+#include "keysequence.h"
+#include "pointpattern.h"
+#include <QVector>
+
+enum class OpCode : quint8 {
+    Halt,
+    Wait,
+    SetPoint,
+    SetPointCursor,
+    SetPointArea,
+    FindTarget,
+    WatchRegion,
+    IfPixel,
+    Move,
+    Glide,
+    Click,
+    ClickAt,
+    Press,
+    Release,
+    Key,
+    KeyDown,
+    KeyUp,
+    LoopBegin,
+    LoopEnd,
+    Jump,
+    SetPointPattern,
+    SetPointShape,
+    TypeText
+};
+
+struct Instruction {
+    OpCode op = OpCode::Halt;
+    quint8 slot = 0;
+    qint32 a = 0;
+    qint32 b = 0;
+    qint32 c = 0;
+    qint32 d = 0;
+};
+
+class ActionProgram
+{
+public:
+    static constexpr int maxLoopDepth = 8;
+    static constexpr int maxPatterns = 8;
+    static constexpr int maxShapes = 8;
+    static constexpr int maxTexts = 8;
+
+    int append(OpCode op, qint32 a = 0, qint32 b = 0, qint32 c = 0, qint32 d = 0, quint8 slot = 0);
+    Instruction& at(int index);
+    const Instruction* data() const;
+    int size() const;
+    int addPattern(const PointPattern& pattern);
+    PointPattern& pattern(int index);
+    const PointPattern& pattern(int index) const;
+    int patternCount() const;
+    int addShape(const AreaSampler& shape);
+    const AreaSampler& shape(int index) const;
+    int shapeCount() const;
+    int addText(const KeySequence& text);
+    const KeySequence& text(int index) const;
+    int textCount() const;
+    bool uses(OpCode op) const;
+    quint64 fingerprint() const;
+    void clear();
+
+private:
+    QVector<Instruction> code;
+    QVector<PointPattern> patterns;
+    QVector<AreaSampler> shapes;
+    QVector<KeySequence> texts;
+};
+
+#endif // ACTIONPROGRAM_H
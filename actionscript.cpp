@@ -0,0 +1,328 @@
+#include "actionscript.h"
+#include <QHash>
+#include <QRegularExpression>
+#include <QVector>
+
+/**
+ * @brief Compiles the small action language into ActionProgram bytecode.
+ *
+ * @details One command per line, '#' starts a comment, keywords are case-insensitive:
+ * - move X Y / glide X Y [MS] / drag X Y [MS]
+ * - click [X Y] [left|right|middle] [double] / press [BUTTON] / release [BUTTON]
+ * - wait MS [RANDOM_MS]
+ * - key KEY / keydown KEY / keyup KEY (F1-F12, letters, digits, enter, space, tab, esc, shift, ctrl, alt, arrows or a VK code)
+ * - type MS TEXT (TEXT is the rest of the line, typed verbatim with MS between characters; 0 types it at once)
+ * - loop [N] ... end (without N the loop runs until stopped)
+ * - ifpixel X Y #RRGGBB ... [else ...] end / iftarget ... [else ...] end
+ *
+ * All jump targets are resolved during compilation, so the interpreter only follows indices.
+ */
+
+/**
+ * @brief Compiles a script.
+ *
+ * @param source The script text.
+ * @param program Receives the bytecode; cleared first.
+ * @param errorMessage Receives a description of the first error, prefixed with its line number.
+ * @return True if the script compiled; otherwise, false.
+ */
+
+bool ActionScript::compile(const QString& source, ActionProgram& program, QString& errorMessage)
+{
+    program.clear();
+    QVector<Block> blocks;
+    int loopDepth = 0;
+    const QStringList lines = source.split('\n');
+
+    for (int lineIndex = 0; lineIndex < lines.size(); ++lineIndex)
+    {
+        QStringList tokens = lines.at(lineIndex).toLower().split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+        for (int i = 0; i < tokens.size(); ++i)
+        {
+            // '#' starts a comment, except for the color operand of ifpixel.
+            if (tokens.at(i).startsWith('#') && !(i == 3 && tokens.first() == "ifpixel"))
+            {
+                tokens.erase(tokens.begin() + i, tokens.end());
+                break;
+            }
+        }
+
+        if (tokens.isEmpty())
+        {
+            continue;
+        }
+
+        const QString& command = tokens.first();
+        QString lineError;
+        qint32 x = 0;
+        qint32 y = 0;
+
+        if (command == "move" || command == "glide" || command == "drag")
+        {
+            qint32 duration = 200;
+            if (tokens.size() < 3 || tokens.size() > 4 || !parseNumber(tokens.at(1), x) || !parseNumber(tokens.at(2), y)
+                || (tokens.size() == 4 && (command == "move" || !parseNumber(tokens.at(3), duration))))
+            {
+                lineError = QString("expected '%1 X Y%2'").arg(command, command == "move" ? "" : " [MS]");
+            } else if (command == "move")
+            {
+                program.append(OpCode::SetPoint, x, y);
+                program.append(OpCode::Move);
+            } else
+            {
+                if (command == "drag")
+                {
+                    program.append(OpCode::Press, 0);
+                }
+                program.append(OpCode::SetPoint, x, y);
+                program.append(OpCode::Glide, qMax(1, duration));
+                if (command == "drag")
+                {
+                    program.append(OpCode::Release, 0);
+                }
+            }
+        } else if (command == "click")
+        {
+            int next = 1;
+            bool hasPoint = tokens.size() >= 3 && parseNumber(tokens.at(1), x) && parseNumber(tokens.at(2), y);
+            if (hasPoint)
+            {
+                next = 3;
+            }
+
+            qint32 button = 0;
+            qint32 clicks = 1;
+            for (; next < tokens.size() && lineError.isEmpty(); ++next)
+            {
+                if (tokens.at(next) == "double")
+                {
+                    clicks = 2;
+                } else if (!parseButton(tokens.at(next), button))
+                {
+                    lineError = QString("unknown click option '%1'").arg(tokens.at(next));
+                }
+            }
+
+            if (lineError.isEmpty())
+            {
+                if (hasPoint)
+                {
+                    program.append(OpCode::SetPoint, x, y);
+                    program.append(OpCode::ClickAt, button, clicks);
+                } else
+                {
+                    program.append(OpCode::Click, button, clicks);
+                }
+            }
+        } else if (command == "press" || command == "release")
+        {
+            qint32 button = 0;
+            if (tokens.size() > 2 || (tokens.size() == 2 && !parseButton(tokens.at(1), button)))
+            {
+                lineError = QString("expected '%1 [left|right|middle]'").arg(command);
+            } else
+            {
+                program.append(command == "press" ? OpCode::Press : OpCode::Release, button);
+            }
+        } else if (command == "wait")
+        {
+            qint32 duration = 0;
+            qint32 randomExtra = 0;
+            if (tokens.size() < 2 || tokens.size() > 3 || !parseNumber(tokens.at(1), duration)
+                || (tokens.size() == 3 && !parseNumber(tokens.at(2), randomExtra)) || duration < 0 || randomExtra < 0)
+            {
+                lineError = "expected 'wait MS [RANDOM_MS]'";
+            } else
+            {
+                program.append(OpCode::Wait, duration, randomExtra);
+            }
+        } else if (command == "key" || command == "keydown" || command == "keyup")
+        {
+            qint32 virtualKey = 0;
+            if (tokens.size() != 2 || !parseKey(tokens.at(1), virtualKey))
+            {
+                lineError = QString("expected '%1 KEY'").arg(command);
+            } else
+            {
+                OpCode op = command == "key" ? OpCode::Key : (command == "keydown" ? OpCode::KeyDown : OpCode::KeyUp);
+                program.append(op, virtualKey);
+            }
+        } else if (command == "type")
+        {
+            static const QRegularExpression typePattern("^\\s*type\\s+(\\d+)\\s(.*)$", QRegularExpression::CaseInsensitiveOption);
+            QRegularExpressionMatch match = typePattern.match(lines.at(lineIndex));
+            int textIndex = match.hasMatch() ? program.addText(KeySequence::translate(match.captured(2))) : -1;
+            if (!match.hasMatch())
+            {
+                lineError = "expected 'type MS TEXT'";
+            } else if (textIndex < 0)
+            {
+                lineError = QString("at most %1 type commands are supported").arg(ActionProgram::maxTexts);
+            } else
+            {
+                program.append(OpCode::TypeText, textIndex, match.captured(1).toInt());
+            }
+        } else if (command == "loop")
+        {
+            qint32 count = infiniteRepetitions;
+            if (tokens.size() > 2 || (tokens.size() == 2 && (!parseNumber(tokens.at(1), count) || count < 0)))
+            {
+                lineError = "expected 'loop [N]'";
+            } else if (loopDepth >= ActionProgram::maxLoopDepth)
+            {
+                lineError = QString("loops can be nested at most %1 deep").arg(ActionProgram::maxLoopDepth);
+            } else
+            {
+                int index = program.append(OpCode::LoopBegin, count, 0, 0, 0, static_cast<quint8>(loopDepth));
+                blocks.append({true, index, -1});
+                ++loopDepth;
+            }
+        } else if (command == "ifpixel" || command == "iftarget")
+        {
+            qint32 color = 0;
+            if (command == "ifpixel" && (tokens.size() != 4 || !parseNumber(tokens.at(1), x) || !parseNumber(tokens.at(2), y) || !parseColor(tokens.at(3), color)))
+            {
+                lineError = "expected 'ifpixel X Y #RRGGBB'";
+            } else if (command == "iftarget" && tokens.size() != 1)
+            {
+                lineError = "expected 'iftarget'";
+            } else
+            {
+                int index = command == "ifpixel" ? program.append(OpCode::IfPixel, x, y, color)
+                                                 : program.append(OpCode::FindTarget);
+                blocks.append({false, index, -1});
+            }
+        } else if (command == "else")
+        {
+            if (blocks.isEmpty() || blocks.last().isLoop || blocks.last().elseJumpIndex >= 0)
+            {
+                lineError = "'else' without matching 'ifpixel' or 'iftarget'";
+            } else
+            {
+                Block& block = blocks.last();
+                block.elseJumpIndex = program.append(OpCode::Jump);
+                program.at(block.beginIndex).d = program.size();
+            }
+        } else if (command == "end")
+        {
+            if (blocks.isEmpty())
+            {
+                lineError = "'end' without matching block";
+            } else
+            {
+                Block block = blocks.takeLast();
+                if (block.isLoop)
+                {
+                    --loopDepth;
+                    program.append(OpCode::LoopEnd, 0, 0, 0, block.beginIndex + 1, static_cast<quint8>(loopDepth));
+                    program.at(block.beginIndex).d = program.size();
+                } else if (block.elseJumpIndex >= 0)
+                {
+                    program.at(block.elseJumpIndex).d = program.size();
+                } else
+                {
+                    program.at(block.beginIndex).d = program.size();
+                }
+            }
+        } else
+        {
+            lineError = QString("unknown command '%1'").arg(command);
+        }
+
+        if (!lineError.isEmpty())
+        {
+            errorMessage = QString("line %1: %2").arg(lineIndex + 1).arg(lineError);
+            program.clear();
+            return false;
+        }
+    }
+
+    if (!blocks.isEmpty())
+    {
+        errorMessage = "missing 'end'";
+        program.clear();
+        return false;
+    }
+
+    program.append(OpCode::Halt);
+    return true;
+}
+
+/**
+ * @brief Parses a decimal or 0x-prefixed hexadecimal integer.
+ */
+
+bool ActionScript::parseNumber(const QString& token, qint32& value)
+{
+    bool isNumber = false;
+    value = token.toInt(&isNumber, 0);
+    return isNumber;
+}
+
+/**
+ * @brief Parses a mouse button name.
+ */
+
+bool ActionScript::parseButton(const QString& token, qint32& button)
+{
+    static const QHash<QString, qint32> buttons = {{"left", 0}, {"right", 1}, {"middle", 2}};
+    if (!buttons.contains(token))
+    {
+        return false;
+    }
+    button = buttons.value(token);
+    return true;
+}
+
+/**
+ * @brief Parses a key name, a single letter or digit, or a numeric virtual key code.
+ */
+
+bool ActionScript::parseKey(const QString& token, qint32& virtualKey)
+{
+    static const QHash<QString, qint32> keys = {
+        {"enter", 0x0D}, {"space", 0x20}, {"tab", 0x09}, {"esc", 0x1B}, {"escape", 0x1B}, {"backspace", 0x08},
+        {"shift", 0x10}, {"ctrl", 0x11}, {"alt", 0x12}, {"left", 0x25}, {"up", 0x26}, {"right", 0x27}, {"down", 0x28}
+    };
+
+    if (keys.contains(token))
+    {
+        virtualKey = keys.value(token);
+        return true;
+    }
+
+    if (token.length() == 1 && token.at(0).isLetterOrNumber() && token.at(0).unicode() < 0x80)
+    {
+        virtualKey = token.at(0).toUpper().unicode();
+        return true;
+    }
+
+    if (token.length() >= 2 && token.length() <= 3 && token.startsWith('f'))
+    {
+        bool isNumber = false;
+        int functionKey = token.mid(1).toInt(&isNumber);
+        if (isNumber && functionKey >= 1 && functionKey <= 12)
+        {
+            virtualKey = 0x70 + functionKey - 1;
+            return true;
+        }
+    }
+
+    return parseNumber(token, virtualKey) && virtualKey > 0 && virtualKey < 256;
+}
+
+/**
+ * @brief Parses a #RRGGBB color.
+ */
+
+bool ActionScript::parseColor(const QString& token, qint32& color)
+{
+    if (token.length() != 7 || !token.startsWith('#'))
+    {
+        return false;
+    }
+
+    bool isNumber = false;
+    color = token.mid(1).toInt(&isNumber, 16);
+    return isNumber;
+}
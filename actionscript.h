@@ -0,0 +1,28 @@
+#ifndef ACTIONSCRIPT_H
+#define ACTIONSCRIPT_H
+
+#include "actionprogram.h"
+#include <QString>
+#include <QStringList>
+
+class ActionScript
+{
+public:
+    static constexpr qint32 infiniteRepetitions = 2000000000;
+
+    static bool compile(const QString& source, ActionProgram& program, QString& errorMessage);
+    static bool parseKey(const QString& token, qint32& virtualKey);
+
+private:
+    struct Block {
+        bool isLoop;
+        int beginIndex;
+        int elseJumpIndex;
+    };
+
+    static bool parseNumber(const QString& token, qint32& value);
+    static bool parseButton(const QString& token, qint32& button);
+    static bool parseColor(const QString& token, qint32& color);
+};
+
+#endif // ACTIONSCRIPT_H
@@ -0,0 +1,396 @@
+#include "actionvm.h"
+#include <QtMath>
+#include <algorithm>
+#include <iterator>
+
+/**
+ * @brief Interpreter for ActionProgram bytecode, driven by the click scheduler.
+ *
+ * @details run() executes instructions until the program has to wait and returns the absolute deadline
+ * (steady clock nanoseconds) of the next step. Deadlines are advanced from the previous deadline instead of
+ * from the wake-up time, so late wake-ups do not accumulate drift; a deadline that already lies in the past is
+ * moved to the present so a stalled scheduler never fires a burst of catch-up clicks. Curved movements are
+ * emitted one precomputed point per glideStep. The point register, loop counters and random state are plain
+ * members, so executing a program never allocates, and they can be copied out as a State for checkpoints. All input goes through an ActionSink, which keeps the
+ * interpreter free of platform code and lets it run against a fake sink and a virtual clock.
+ */
+
+ActionVM::ActionVM()
+    : program(nullptr)
+    ,programCounter(0)
+    ,loopCounters{}
+    ,patternPositions{}
+    ,typingPosition(0)
+    ,isGliding(false)
+    ,halted(true)
+    ,deadline(0)
+    ,randomState(0)
+    ,executedCount(0)
+    ,iterations(0)
+{
+}
+
+/**
+ * @brief Selects the program to execute and seeds the random generator used for random waits, areas and paths.
+ *
+ * @param program The program; must stay alive and unchanged while the VM runs it.
+ * @param seed The random seed.
+ */
+
+void ActionVM::load(const ActionProgram *program, quint64 seed)
+{
+    this->program = program;
+    randomState = seed;
+    halted = true;
+}
+
+/**
+ * @brief Restarts the loaded program; the first instruction runs at the given time.
+ */
+
+void ActionVM::reset(qint64 now)
+{
+    programCounter = 0;
+    isGliding = false;
+    halted = program == nullptr;
+    deadline = now;
+    executedCount = 0;
+    iterations = 0;
+    std::fill(std::begin(patternPositions), std::end(patternPositions), 0);
+    typingPosition = 0;
+    path.clear();
+}
+
+/**
+ * @brief Checks whether the program has finished.
+ */
+
+bool ActionVM::isHalted() const
+{
+    return halted;
+}
+
+/**
+ * @brief Returns the number of instructions executed since the last reset.
+ */
+
+quint64 ActionVM::getExecutedCount() const
+{
+    return executedCount;
+}
+
+/**
+ * @brief Returns how often the outermost loop completed since the last reset, e.g. the repetitions of a job.
+ */
+
+quint64 ActionVM::getIterations() const
+{
+    return iterations;
+}
+
+/**
+ * @brief Copies the execution state, so a run can be continued later with restoreState().
+ *
+ * @param state Receives the state.
+ * @param now The current time; the remaining wait is stored relative to it.
+ *
+ * @details Call it between two run() calls. An unfinished glide is not stored: the program counter still points
+ * at the Glide instruction, so a restored program glides again from the cursor position of that moment.
+ */
+
+void ActionVM::saveState(State& state, qint64 now) const
+{
+    state.programCounter = programCounter;
+    for (int i = 0; i < ActionProgram::maxLoopDepth; ++i)
+    {
+        state.loopCounters[i] = loopCounters[i];
+    }
+    state.pointX = point.x();
+    state.pointY = point.y();
+    state.randomState = randomState;
+    state.iterations = iterations;
+    state.remainingWait = qMax<qint64>(0, deadline - now);
+    for (int i = 0; i < ActionProgram::maxPatterns; ++i)
+    {
+        state.patternPositions[i] = patternPositions[i];
+    }
+    state.typingPosition = typingPosition;
+}
+
+/**
+ * @brief Continues the loaded program from a saved state.
+ *
+ * @param state The state saved by saveState() for the same program.
+ * @param now The current time; the stored remaining wait starts from it.
+ */
+
+void ActionVM::restoreState(const State& state, qint64 now)
+{
+    reset(now);
+    programCounter = qBound(0, state.programCounter, program ? program->size() : 0);
+    for (int i = 0; i < ActionProgram::maxLoopDepth; ++i)
+    {
+        loopCounters[i] = state.loopCounters[i];
+    }
+    point = QPoint(state.pointX, state.pointY);
+    randomState = state.randomState;
+    iterations = state.iterations;
+    deadline = now + state.remainingWait;
+    for (int i = 0; i < ActionProgram::maxPatterns; ++i)
+    {
+        patternPositions[i] = state.patternPositions[i];
+    }
+    typingPosition = qMax(0, state.typingPosition);
+}
+
+/**
+ * @brief Executes instructions until the program waits or halts.
+ *
+ * @param now The current steady clock time in nanoseconds.
+ * @param sink Receives all input actions.
+ * @return The deadline of the next step, or -1 once the program has halted.
+ */
+
+qint64 ActionVM::run(qint64 now, ActionSink& sink)
+{
+    if (halted)
+    {
+        return -1;
+    }
+
+    if (isGliding)
+    {
+        if (!path.atEnd())
+        {
+            sink.moveTo(path.next());
+            return advanceDeadline(glideStep, now);
+        }
+        isGliding = false;
+        ++programCounter;
+    }
+
+    const Instruction *code = program->data();
+    const int size = program->size();
+
+    for (int budget = maxInstructionsPerRun; budget > 0; --budget)
+    {
+        if (programCounter >= size)
+        {
+            halted = true;
+            return -1;
+        }
+
+        const Instruction& instruction = code[programCounter];
+        ++executedCount;
+
+        switch (instruction.op)
+        {
+        case OpCode::Halt:
+            halted = true;
+            return -1;
+        case OpCode::Wait:
+        {
+            qint64 interval = instruction.a;
+            if (instruction.b > 0)
+            {
+                interval += static_cast<qint64>(nextRandom() % (static_cast<quint64>(instruction.b) + 1));
+            }
+            ++programCounter;
+            return advanceDeadline(interval * 1000000, now);
+        }
+        case OpCode::SetPoint:
+            point = QPoint(instruction.a, instruction.b);
+            ++programCounter;
+            break;
+        case OpCode::SetPointCursor:
+            point = sink.cursorPosition();
+            ++programCounter;
+            break;
+        case OpCode::SetPointArea:
+        {
+            double first = nextUnit();
+            double second = nextUnit();
+            point = randomPointWithinCircle(QPoint(instruction.a, instruction.b), instruction.c, first, second);
+            ++programCounter;
+            break;
+        }
+        case OpCode::SetPointShape:
+        {
+            double first = nextUnit();
+            double second = nextUnit();
+            double third = nextUnit();
+            point = QPoint(instruction.b, instruction.c) + program->shape(instruction.a).sample(first, second, third);
+            ++programCounter;
+            break;
+        }
+        case OpCode::SetPointPattern:
+        {
+            // Produces the next point of the sweep; a finished sweep rewinds and takes the jump.
+            const PointPattern& pattern = program->pattern(instruction.a);
+            quint64& position = patternPositions[instruction.a];
+            if (position < pattern.size())
+            {
+                point = pattern.at(position++);
+                ++programCounter;
+            } else
+            {
+                position = 0;
+                programCounter = instruction.d;
+            }
+            break;
+        }
+        case OpCode::FindTarget:
+            programCounter = sink.locateTarget(point) ? programCounter + 1 : instruction.d;
+            break;
+        case OpCode::WatchRegion:
+            programCounter = sink.regionChanged() ? programCounter + 1 : instruction.d;
+            break;
+        case OpCode::IfPixel:
+            programCounter = (sink.pixelAt(QPoint(instruction.a, instruction.b)) & 0xFFFFFF) == (static_cast<QRgb>(instruction.c) & 0xFFFFFF)
+                                 ? programCounter + 1 : instruction.d;
+            break;
+        case OpCode::Move:
+            sink.moveTo(point);
+            ++programCounter;
+            break;
+        case OpCode::Glide:
+        {
+            double first = nextUnit();
+            double second = nextUnit();
+            path.build(sink.cursorPosition(), point, instruction.a, static_cast<int>(glideStep / 1000000), first * 2.0 - 1.0, second * 2.0 - 1.0);
+            isGliding = true;
+            sink.moveTo(path.next());
+            return advanceDeadline(glideStep, now);
+        }
+        case OpCode::Click:
+            sink.click(instruction.a, instruction.b);
+            ++programCounter;
+            break;
+        case OpCode::ClickAt:
+            sink.clickAt(point, instruction.a, instruction.b);
+            ++programCounter;
+            break;
+        case OpCode::Press:
+            sink.setButton(instruction.a, true);
+            ++programCounter;
+            break;
+        case OpCode::Release:
+            sink.setButton(instruction.a, false);
+            ++programCounter;
+            break;
+        case OpCode::Key:
+        {
+            const KeyStroke strokes[] = {{static_cast<quint16>(instruction.a), false, false}, {static_cast<quint16>(instruction.a), false, true}};
+            sink.sendKeys(strokes, 2);
+            ++programCounter;
+            break;
+        }
+        case OpCode::TypeText:
+        {
+            // Types the whole text in one batch, or one character per step with the delay in between.
+            const KeySequence& text = program->text(instruction.a);
+            if (instruction.b <= 0)
+            {
+                sink.sendKeys(text.strokes(), text.strokeCount());
+                ++programCounter;
+                break;
+            }
+            if (typingPosition < text.characterCount())
+            {
+                int begin = text.characterBegin(typingPosition);
+                sink.sendKeys(text.strokes() + begin, text.characterEnd(typingPosition) - begin);
+                ++typingPosition;
+            }
+            if (typingPosition < text.characterCount())
+            {
+                return advanceDeadline(static_cast<qint64>(instruction.b) * 1000000, now);
+            }
+            typingPosition = 0;
+            ++programCounter;
+            break;
+        }
+        case OpCode::KeyDown:
+            sink.sendKey(instruction.a, true);
+            ++programCounter;
+            break;
+        case OpCode::KeyUp:
+            sink.sendKey(instruction.a, false);
+            ++programCounter;
+            break;
+        case OpCode::LoopBegin:
+            loopCounters[instruction.slot] = instruction.a;
+            programCounter = instruction.a > 0 ? programCounter + 1 : instruction.d;
+            break;
+        case OpCode::LoopEnd:
+            if (instruction.slot == 0)
+            {
+                ++iterations;
+            }
+            programCounter = --loopCounters[instruction.slot] > 0 ? instruction.d : programCounter + 1;
+            break;
+        case OpCode::Jump:
+            programCounter = instruction.d;
+            break;
+        }
+    }
+
+    return advanceDeadline(yieldInterval, now);
+}
+
+/**
+ * @brief Moves the deadline forward by the interval without letting it fall behind the current time.
+ */
+
+qint64 ActionVM::advanceDeadline(qint64 interval, qint64 now)
+{
+    deadline += interval;
+    if (deadline < now)
+    {
+        deadline = now;
+    }
+    return deadline;
+}
+
+/**
+ * @brief Returns the next value of the splitmix64 generator.
+ */
+
+quint64 ActionVM::nextRandom()
+{
+    quint64 value = (randomState += 0x9E3779B97F4A7C15ULL);
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+/**
+ * @brief Returns a random value in range 0..1 (exclusive).
+ */
+
+double ActionVM::nextUnit()
+{
+    return (nextRandom() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @brief Generates a random point within a circle given its center and radius.
+ *
+ * @param center The center point of the circle.
+ * @param radius The radius of the circle.
+ * @param angleFraction Random value in range 0..1 selecting the angle.
+ * @param distanceFraction Random value in range 0..1 selecting the distance from the center.
+ * @return Returns a random point within the specified circle.
+ *
+ * @details Uses polar coordinates: the angle and the distance within the radius are drawn independently
+ * and converted to Cartesian coordinates (x, y) relative to the center.
+ */
+
+QPoint ActionVM::randomPointWithinCircle(const QPoint& center, int radius, double angleFraction, double distanceFraction)
+{
+    qreal randomAngle = angleFraction * 2 * M_PI;
+    qreal randomDistance = distanceFraction * radius;
+    int randomX = center.x() + static_cast<int>(randomDistance * qCos(randomAngle));
+    int randomY = center.y() + static_cast<int>(randomDistance * qSin(randomAngle));
+
+    return QPoint(randomX, randomY);
+}
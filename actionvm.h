@@ -0,0 +1,81 @@
+#ifndef ACTIONVM_H
+#define ACTIONVM_H
+
+#include "actionprogram.h"
+#include "cursorpath.h"
+#include <QPoint>
+#include <QRgb>
+
+class ActionSink
+{
+public:
+    enum Button { Left = 0, Right = 1, Middle = 2 };
+
+    virtual ~ActionSink() = default;
+
+    virtual QPoint cursorPosition() = 0;
+    virtual void moveTo(const QPoint& point) = 0;
+    virtual void click(int button, int clicks) = 0;
+    virtual void clickAt(const QPoint& point, int button, int clicks) = 0;
+    virtual void setButton(int button, bool isDown) = 0;
+    virtual void sendKey(int virtualKey, bool isDown) = 0;
+    virtual void sendKeys(const KeyStroke *strokes, int count) = 0;
+    virtual bool locateTarget(QPoint& target) = 0;
+    virtual bool regionChanged() = 0;
+    virtual QRgb pixelAt(const QPoint& point) = 0;
+};
+
+class ActionVM
+{
+public:
+    static constexpr qint64 glideStep = 5000000;
+
+    struct State {
+        qint32 programCounter;
+        qint32 loopCounters[ActionProgram::maxLoopDepth];
+        qint32 pointX;
+        qint32 pointY;
+        quint64 randomState;
+        quint64 iterations;
+        qint64 remainingWait;
+        quint64 patternPositions[ActionProgram::maxPatterns];
+        qint32 typingPosition;
+    };
+
+    ActionVM();
+
+    void load(const ActionProgram *program, quint64 seed);
+    void reset(qint64 now);
+    qint64 run(qint64 now, ActionSink& sink);
+    bool isHalted() const;
+    quint64 getExecutedCount() const;
+    quint64 getIterations() const;
+    void saveState(State& state, qint64 now) const;
+    void restoreState(const State& state, qint64 now);
+
+    static QPoint randomPointWithinCircle(const QPoint& center, int radius, double angleFraction, double distanceFraction);
+
+private:
+    static constexpr int maxInstructionsPerRun = 4096;
+    static constexpr qint64 yieldInterval = 1000000;
+
+    const ActionProgram *program;
+    int programCounter;
+    qint32 loopCounters[ActionProgram::maxLoopDepth];
+    quint64 patternPositions[ActionProgram::maxPatterns];
+    int typingPosition;
+    QPoint point;
+    CursorPath path;
+    bool isGliding;
+    bool halted;
+    qint64 deadline;
+    quint64 randomState;
+    quint64 executedCount;
+    quint64 iterations;
+
+    quint64 nextRandom();
+    double nextUnit();
+    qint64 advanceDeadline(qint64 interval, qint64 now);
+};
+
+#endif // ACTIONVM_H
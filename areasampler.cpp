@@ -0,0 +1,372 @@
+#include "areasampler.h"
+#include <QtMath>
+
+/**
+ * @brief Uniform random points inside a click area of arbitrary shape.
+ *
+ * @details All preprocessing happens when the sampler is built, so sample() costs the same constant time for a
+ * rectangle as for a polygon with hundreds of vertices or a full-screen mask:
+ * - Rectangle and Ellipse are sampled directly (the ellipse as a stretched disk with a square-root radius).
+ * - Polygon is split into triangles by ear clipping. A triangle is picked from an alias table weighted by the
+ *   triangle areas and a point inside it is drawn from two uniforms, folding the far half of the parallelogram back.
+ * - Mask is split into horizontal runs of set pixels. A run is picked from an alias table weighted by the run
+ *   lengths and a pixel inside it is drawn uniformly; this is the constant-time form of row prefix sums.
+ * Rectangles and ellipses are relative to their center, polygons and masks to the origin of their coordinates.
+ */
+
+namespace
+{
+/**
+ * @brief Returns twice the signed area of the triangle a, b, c; positive if it turns counterclockwise.
+ */
+
+qint64 cross(const QPoint& a, const QPoint& b, const QPoint& c)
+{
+    return static_cast<qint64>(b.x() - a.x()) * (c.y() - a.y()) - static_cast<qint64>(b.y() - a.y()) * (c.x() - a.x());
+}
+
+quint64 mixHash(quint64 hash, quint64 value)
+{
+    return (hash ^ value) * 0x100000001B3ULL;
+}
+}
+
+/**
+ * @brief Creates a rectangle of the given size centered on the origin.
+ */
+
+AreaSampler AreaSampler::rectangle(const QSize& size)
+{
+    AreaSampler sampler;
+    sampler.kind = Rectangle;
+    sampler.size = size;
+    sampler.hash = mixHash(mixHash(mixHash(0xCBF29CE484222325ULL, Rectangle), static_cast<quint32>(size.width())), static_cast<quint32>(size.height()));
+    return sampler;
+}
+
+/**
+ * @brief Creates an ellipse with the given bounding size centered on the origin.
+ */
+
+AreaSampler AreaSampler::ellipse(const QSize& size)
+{
+    AreaSampler sampler;
+    sampler.kind = Ellipse;
+    sampler.size = size;
+    sampler.hash = mixHash(mixHash(mixHash(0xCBF29CE484222325ULL, Ellipse), static_cast<quint32>(size.width())), static_cast<quint32>(size.height()));
+    return sampler;
+}
+
+/**
+ * @brief Creates a polygon sampler by triangulating a simple polygon.
+ *
+ * @param vertices The vertices in either orientation; the closing edge is implied.
+ * @param sampler Receives the sampler.
+ * @return False if the polygon has no area or intersects itself.
+ */
+
+bool AreaSampler::polygon(const QVector<QPoint>& vertices, AreaSampler& sampler)
+{
+    QVector<QPoint> ring;
+    for (const QPoint& vertex : vertices)
+    {
+        if (ring.isEmpty() || ring.last() != vertex)
+        {
+            ring.append(vertex);
+        }
+    }
+    while (ring.size() > 1 && ring.first() == ring.last())
+    {
+        ring.removeLast();
+    }
+    if (ring.size() < 3)
+    {
+        return false;
+    }
+
+    qint64 doubleArea = 0;
+    for (int i = 0; i < ring.size(); ++i)
+    {
+        const QPoint& from = ring.at(i);
+        const QPoint& to = ring.at((i + 1) % ring.size());
+        doubleArea += static_cast<qint64>(from.x()) * to.y() - static_cast<qint64>(to.x()) * from.y();
+    }
+    if (doubleArea == 0)
+    {
+        return false;
+    }
+    qint64 orientation = doubleArea > 0 ? 1 : -1;
+
+    AreaSampler result;
+    result.kind = Polygon;
+    QVector<double> weights;
+    QVector<int> remaining;
+    for (int i = 0; i < ring.size(); ++i)
+    {
+        remaining.append(i);
+    }
+
+    // Ear clipping: cut off a convex corner whose triangle contains no other vertex until one triangle is left.
+    while (remaining.size() > 3)
+    {
+        bool isClipped = false;
+        int count = remaining.size();
+        for (int i = 0; i < count; ++i)
+        {
+            const QPoint& previous = ring.at(remaining.at((i + count - 1) % count));
+            const QPoint& current = ring.at(remaining.at(i));
+            const QPoint& next = ring.at(remaining.at((i + 1) % count));
+            qint64 turn = cross(previous, current, next) * orientation;
+            if (turn == 0)
+            {
+                remaining.removeAt(i);
+                isClipped = true;
+                break;
+            }
+            if (turn < 0)
+            {
+                continue;
+            }
+
+            bool isEar = true;
+            for (int j = 0; j < count && isEar; ++j)
+            {
+                const QPoint& other = ring.at(remaining.at(j));
+                if (other == previous || other == current || other == next)
+                {
+                    continue;
+                }
+                isEar = cross(previous, current, other) * orientation < 0 || cross(current, next, other) * orientation < 0
+                        || cross(next, previous, other) * orientation < 0;
+            }
+            if (isEar)
+            {
+                Triangle triangle{previous, current - previous, next - previous};
+                result.triangles.append(triangle);
+                weights.append(static_cast<double>(turn));
+                remaining.removeAt(i);
+                isClipped = true;
+                break;
+            }
+        }
+        if (!isClipped)
+        {
+            return false;
+        }
+    }
+
+    const QPoint& first = ring.at(remaining.at(0));
+    const QPoint& second = ring.at(remaining.at(1));
+    const QPoint& third = ring.at(remaining.at(2));
+    qint64 lastArea = qAbs(cross(first, second, third));
+    if (lastArea > 0)
+    {
+        result.triangles.append(Triangle{first, second - first, third - first});
+        weights.append(static_cast<double>(lastArea));
+    }
+    if (result.triangles.isEmpty())
+    {
+        return false;
+    }
+
+    result.buildAliasTable(weights);
+    quint64 hash = mixHash(0xCBF29CE484222325ULL, Polygon);
+    for (const QPoint& vertex : ring)
+    {
+        hash = mixHash(hash, (static_cast<quint64>(static_cast<quint32>(vertex.x())) << 32) | static_cast<quint32>(vertex.y()));
+    }
+    result.hash = hash;
+    sampler = result;
+    return true;
+}
+
+/**
+ * @brief Creates a mask sampler from an image.
+ *
+ * @param image The mask; pixel (x, y) is the point (x, y). With an alpha channel the opaque pixels belong to the
+ * area, otherwise the bright ones, so both a transparent layer painted over a screenshot and a white-on-black
+ * mask work.
+ * @param sampler Receives the sampler.
+ * @return False if no pixel belongs to the area.
+ */
+
+bool AreaSampler::mask(const QImage& image, AreaSampler& sampler)
+{
+    QImage pixels = image.convertToFormat(QImage::Format_ARGB32);
+    bool hasAlpha = image.hasAlphaChannel();
+
+    AreaSampler result;
+    result.kind = Mask;
+    result.size = pixels.size();
+    QVector<double> weights;
+    quint64 hash = mixHash(0xCBF29CE484222325ULL, Mask);
+
+    for (int y = 0; y < pixels.height(); ++y)
+    {
+        const QRgb *line = reinterpret_cast<const QRgb *>(pixels.constScanLine(y));
+        int runStart = -1;
+        for (int x = 0; x <= pixels.width(); ++x)
+        {
+            bool isSet = x < pixels.width() && (hasAlpha ? qAlpha(line[x]) >= 128 : qGray(line[x]) >= 128);
+            if (isSet && runStart < 0)
+            {
+                runStart = x;
+            } else if (!isSet && runStart >= 0)
+            {
+                result.runs.append(Run{runStart, y, x - runStart});
+                weights.append(static_cast<double>(x - runStart));
+                hash = mixHash(hash, (static_cast<quint64>(static_cast<quint32>(y)) << 32) | static_cast<quint32>(runStart));
+                hash = mixHash(hash, static_cast<quint32>(x - runStart));
+                runStart = -1;
+            }
+        }
+    }
+    if (result.runs.isEmpty())
+    {
+        return false;
+    }
+
+    result.buildAliasTable(weights);
+    result.hash = hash;
+    sampler = result;
+    return true;
+}
+
+/**
+ * @brief Returns the shape of the area.
+ */
+
+AreaSampler::Kind AreaSampler::getKind() const
+{
+    return kind;
+}
+
+/**
+ * @brief Returns true if the sampler holds no area, e.g. when default-constructed.
+ */
+
+bool AreaSampler::isEmpty() const
+{
+    switch (kind)
+    {
+    case Rectangle:
+    case Ellipse:
+        return size.isEmpty();
+    case Polygon:
+        return triangles.isEmpty();
+    case Mask:
+        return runs.isEmpty();
+    }
+    return true;
+}
+
+/**
+ * @brief Draws a uniformly distributed point inside the area.
+ *
+ * @param first, second, third Independent uniform numbers in [0, 1).
+ */
+
+QPoint AreaSampler::sample(double first, double second, double third) const
+{
+    switch (kind)
+    {
+    case Rectangle:
+        return QPoint(static_cast<int>(first * size.width()) - size.width() / 2, static_cast<int>(second * size.height()) - size.height() / 2);
+    case Ellipse:
+    {
+        double radius = qSqrt(first);
+        double angle = 2.0 * M_PI * second;
+        return QPoint(qRound(size.width() * 0.5 * radius * qCos(angle)), qRound(size.height() * 0.5 * radius * qSin(angle)));
+    }
+    case Polygon:
+    {
+        const Triangle& triangle = triangles.at(pick(first));
+        if (second + third > 1.0)
+        {
+            second = 1.0 - second;
+            third = 1.0 - third;
+        }
+        QPointF point = triangle.origin + triangle.firstEdge * second + triangle.secondEdge * third;
+        return point.toPoint();
+    }
+    case Mask:
+    {
+        const Run& run = runs.at(pick(first));
+        return QPoint(run.x + qMin(static_cast<int>(second * run.length), run.length - 1), run.y);
+    }
+    }
+    return QPoint();
+}
+
+/**
+ * @brief Returns a hash of the shape, identifying the sampler in a program fingerprint.
+ */
+
+quint64 AreaSampler::fingerprint() const
+{
+    return hash;
+}
+
+/**
+ * @brief Builds the alias table for picking an element with probability proportional to its weight (Vose's method).
+ */
+
+void AreaSampler::buildAliasTable(const QVector<double>& weights)
+{
+    int count = weights.size();
+    double total = 0.0;
+    for (double weight : weights)
+    {
+        total += weight;
+    }
+
+    probability.resize(count);
+    alias.resize(count);
+    QVector<int> small;
+    QVector<int> large;
+    for (int i = 0; i < count; ++i)
+    {
+        probability[i] = weights.at(i) * count / total;
+        alias[i] = i;
+        if (probability.at(i) < 1.0)
+        {
+            small.append(i);
+        } else
+        {
+            large.append(i);
+        }
+    }
+
+    while (!small.isEmpty() && !large.isEmpty())
+    {
+        int less = small.takeLast();
+        int more = large.last();
+        alias[less] = more;
+        probability[more] -= 1.0 - probability.at(less);
+        if (probability.at(more) < 1.0)
+        {
+            large.removeLast();
+            small.append(more);
+        }
+    }
+    for (int index : large)
+    {
+        probability[index] = 1.0;
+    }
+    for (int index : small)
+    {
+        probability[index] = 1.0;
+    }
+}
+
+/**
+ * @brief Picks an element from the alias table; one uniform number selects both the column and the coin.
+ */
+
+int AreaSampler::pick(double value) const
+{
+    int count = probability.size();
+    double scaled = value * count;
+    int column = qMin(static_cast<int>(scaled), count - 1);
+    return scaled - column < probability.at(column) ? column : alias.at(column);
+}
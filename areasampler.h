@@ -0,0 +1,55 @@
+#ifndef AREASAMPLER_H
+#define AREASAMPLER_H
+
+#include <QImage>
+#include <QPoint>
+#include <QPointF>
+#include <QSize>
+#include <QVector>
+
+class AreaSampler
+{
+public:
+    enum Kind : quint8 {
+        Rectangle,
+        Ellipse,
+        Polygon,
+        Mask
+    };
+
+    static AreaSampler rectangle(const QSize& size);
+    static AreaSampler ellipse(const QSize& size);
+    static bool polygon(const QVector<QPoint>& vertices, AreaSampler& sampler);
+    static bool mask(const QImage& image, AreaSampler& sampler);
+
+    Kind getKind() const;
+    bool isEmpty() const;
+    QPoint sample(double first, double second, double third) const;
+    quint64 fingerprint() const;
+
+private:
+    struct Triangle {
+        QPointF origin;
+        QPointF firstEdge;
+        QPointF secondEdge;
+    };
+
+    struct Run {
+        qint32 x;
+        qint32 y;
+        qint32 length;
+    };
+
+    Kind kind = Rectangle;
+    QSize size;
+    QVector<Triangle> triangles;
+    QVector<Run> runs;
+    QVector<double> probability;
+    QVector<qint32> alias;
+    quint64 hash = 0;
+
+    void buildAliasTable(const QVector<double>& weights);
+    int pick(double value) const;
+};
+
+#endif // AREASAMPLER_H
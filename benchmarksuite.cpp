@@ -0,0 +1,765 @@
+#include "benchmarksuite.h"
+#include "actionvm.h"
+#include "clickjob.h"
+#include "hotkeyfilter.h"
+#include "jobcheckpoint.h"
+#include "schedulingpolicy.h"
+#include "stoptoken.h"
+#include "targetfinder.h"
+#include "tracer.h"
+#include <QElapsedTimer>
+#include <QImage>
+#include <QJsonArray>
+#include <QMap>
+#include <QRandomGenerator>
+#include <QSettings>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QVector>
+#include <QtMath>
+#include <algorithm>
+#include <atomic>
+
+/**
+ * @brief Microbenchmarks of the engine's hot paths.
+ *
+ * @details Every case is calibrated until one round takes at least minimumRoundTime and then measured in several
+ * rounds; the median time per operation is reported, which is robust against the occasional preempted round.
+ * Results are plain JSON so they can be stored as a baseline and compared on later runs with compare().
+ */
+
+namespace
+{
+class NullSink : public ActionSink
+{
+public:
+    QPoint cursorPosition() override { return QPoint(); }
+    void moveTo(const QPoint&) override {}
+    void click(int, int) override {}
+    void clickAt(const QPoint&, int, int) override {}
+    void setButton(int, bool) override {}
+    void sendKey(int, bool) override {}
+    void sendKeys(const KeyStroke *, int) override {}
+    bool locateTarget(QPoint&) override { return true; }
+    bool regionChanged() override { return true; }
+    QRgb pixelAt(const QPoint&) override { return 0; }
+};
+
+const char *const profileKeys[] = {
+    "LineEdit_AreaEnabled", "LineEdit_RepeatTimes", "LineEdit_Minutes", "LineEdit_Seconds", "LineEdit_Milliseconds",
+    "LineEdit_X", "LineEdit_Y", "LineEdit_CaptureRate", "LineEdit_MoveDuration", "CheckBox_CurvedMovement",
+    "CheckBox_RunScript", "PlainTextEdit_Script", "TimeEdit_From", "TimeEdit_Till", "RadioButton_ChoosenLocation",
+    "RadioButton_DoublePress", "RadioButton_FixedClickInterval", "RadioButton_InfiniteClick",
+    "RadioButton_LocationAtCursor", "RadioButton_RandomClickInterval", "RadioButton_RandomWithinArea",
+    "RadioButton_RepeatTimes", "RadioButton_SinglePress", "RadioButton_TargetImage", "RadioButton_WatchRegion",
+    "RadioButton_DragPress", "TemplatePath", "vkCode"
+};
+
+volatile int benchmarkSink = 0;
+}
+
+/**
+ * @brief Runs all benchmark cases.
+ *
+ * @return A JSON object with one entry per case, each holding the median and minimum time per operation in nanoseconds.
+ */
+
+QJsonObject BenchmarkSuite::run()
+{
+    QJsonObject cases;
+    cases["randomPointWithinCircle"] = benchmarkRandomPoint();
+    cases["polygonSampling"] = benchmarkPolygonSampling();
+    cases["maskSampling"] = benchmarkMaskSampling();
+    cases["intervalSampling"] = benchmarkIntervalSampling();
+    cases["singlePointLoop"] = benchmarkSinglePointLoop();
+    cases["gridSweep"] = benchmarkGridSweep();
+    cases["spiralSweep"] = benchmarkSpiralSweep();
+    cases["polylineSweep"] = benchmarkPolylineSweep();
+    cases["targetSearch"] = benchmarkTargetSearch();
+    cases["textTranslation"] = benchmarkTextTranslation();
+    cases["typingDispatch"] = benchmarkTypingDispatch();
+    cases["runPlan"] = benchmarkRunPlan();
+    cases["hotkeyProcessing"] = benchmarkHotkeyProcessing();
+    cases["signalDelivery"] = benchmarkSignalDelivery();
+    cases["stopWake"] = benchmarkStopWake();
+    cases["timerWake"] = benchmarkTimerWake();
+    cases["checkpointSave"] = benchmarkCheckpointSave();
+    cases["traceRecord"] = benchmarkTraceRecord();
+    cases["profileSave"] = benchmarkProfileSave();
+    cases["profileLoad"] = benchmarkProfileLoad();
+
+    QJsonObject result;
+    result["cases"] = cases;
+    return result;
+}
+
+/**
+ * @brief Compares a result with a stored baseline.
+ *
+ * @param current The result of run().
+ * @param baseline A previously stored result of run().
+ * @param threshold Allowed slowdown as a fraction, e.g. 0.1 for 10 %.
+ * @return One line per case that got slower than the threshold allows or reports an invalid measurement; empty if
+ * there is no regression.
+ */
+
+QStringList BenchmarkSuite::compare(const QJsonObject& current, const QJsonObject& baseline, double threshold)
+{
+    QStringList regressions;
+    QJsonObject currentCases = current["cases"].toObject();
+    QJsonObject baselineCases = baseline["cases"].toObject();
+
+    for (auto it = baselineCases.constBegin(); it != baselineCases.constEnd(); ++it)
+    {
+        if (!currentCases.contains(it.key()))
+        {
+            continue;
+        }
+
+        if (!currentCases[it.key()].toObject().value("valid").toBool(true))
+        {
+            regressions.append(QString("%1: invalid measurement").arg(it.key()));
+            continue;
+        }
+
+        double before = it.value().toObject()["nsPerOp"].toDouble();
+        double after = currentCases[it.key()].toObject()["nsPerOp"].toDouble();
+        if (before > 0.0 && after > before * (1.0 + threshold))
+        {
+            regressions.append(QString("%1: %2 ns -> %3 ns (+%4 %)").arg(it.key()).arg(before, 0, 'f', 1).arg(after, 0, 'f', 1)
+                                   .arg((after / before - 1.0) * 100.0, 0, 'f', 1));
+        }
+    }
+    return regressions;
+}
+
+/**
+ * @brief Calibrates and measures one case.
+ *
+ * @param body Executes the operation the given number of times.
+ * @param initialIterations Iterations of the first calibration round.
+ */
+
+QJsonObject BenchmarkSuite::measure(const std::function<void(qint64)>& body, qint64 initialIterations)
+{
+    return measureTimed([&body](qint64 iterations)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        body(iterations);
+        return timer.nsecsElapsed();
+    }, initialIterations);
+}
+
+/**
+ * @brief Calibrates and measures one case that times itself.
+ *
+ * @param body Executes the operation the given number of times and returns the nanoseconds spent on it, so
+ * preparation between the operations can be left out.
+ * @param initialIterations Iterations of the first calibration round.
+ */
+
+QJsonObject BenchmarkSuite::measureTimed(const std::function<qint64(qint64)>& body, qint64 initialIterations)
+{
+    qint64 iterations = qMax<qint64>(1, initialIterations);
+
+    while (body(iterations) < minimumRoundTime)
+    {
+        iterations *= 2;
+    }
+
+    QVector<double> samples;
+    for (int round = 0; round < rounds; ++round)
+    {
+        samples.append(static_cast<double>(body(iterations)) / iterations);
+    }
+    std::sort(samples.begin(), samples.end());
+
+    QJsonObject result;
+    result["nsPerOp"] = samples.at(rounds / 2);
+    result["minNsPerOp"] = samples.first();
+    result["iterations"] = static_cast<double>(iterations);
+    return result;
+}
+
+/**
+ * @brief Sampling of a random point within the click area.
+ */
+
+QJsonObject BenchmarkSuite::benchmarkRandomPoint()
+{
+    return measure([](qint64 iterations)
+    {
+        double fraction = 0.0;
+        int sum = 0;
+        for (qint64 i = 0; i < iterations; ++i)
+        {
+            fraction += 0.618033988749895;
+            fraction -= static_cast<int>(fraction);
+            sum += ActionVM::randomPointWithinCircle(QPoint(500, 500), 50, fraction, 1.0 - fraction).x();
+        }
+        benchmarkSink = sum;
+    }, 1024);
+}
+
+/**
+ * @brief Sampling of a random point within a star-shaped polygon with 256 vertices.
+ */
+
+QJsonObject BenchmarkSuite::benchmarkPolygonSampling()
+{
+    QVector<QPoint> vertices;
+    for (int i = 0; i < 256; ++i)
+    {
+        double angle = 2.0 * M_PI * i / 256;
+        double radius = (i % 2) ? 200.0 : 400.0;
+        vertices.append(QPoint(qRound(500 + radius * qCos(angle)), qRound(500 + radius * qSin(angle))));
+    }
+    AreaSampler sampler;
+    AreaSampler::polygon(vertices, sampler);
+    return measureSampling(sampler);
+}
+
+/**
+ * @brief Sampling of a random point within a full HD mask of diagonal stripes.
+ */
+
+QJsonObject BenchmarkSuite::benchmarkMaskSampling()
+{
+    QImage image(1920, 1080, QImage::Format_Grayscale8);
+    for (int y = 0; y < image.height(); ++y)
+    {
+        uchar *line = image.scanLine(y);
+        for (int x = 0; x < image.width(); ++x)
+        {
+            line[x] = ((x + y) / 7) % 3 == 0 ? 255 : 0;
+        }
+    }
+    AreaSampler sampler;
+    AreaSampler::mask(image, sampler);
+    return measureSampling(sampler);
+}
+
+/**
+ * @brief Measures drawing points from an area sampler.
+ */
+
+QJsonObject BenchmarkSuite::measureSampling(const AreaSampler& sampler)
+{
+    return measure([&sampler](qint64 iterations)
+    {
+        double fraction = 0.0;
+        int sum = 0;
+        for (qint64 i = 0; i < iterations; ++i)
+        {
+            fraction += 0.618033988749895;
+            fraction -= static_cast<int>(fraction);
+            sum += sampler.sample(fraction, 1.0 - fraction, fraction * fraction).x();
+        }
+        benchmarkSink = sum;
+    }, 1024);
+}
+
+/**
+ * @brief Sampling of the randomized click interval, one wait instruction of the VM per operation.
+ */
+
+QJsonObject BenchmarkSuite::benchmarkIntervalSampling()
+{
+    return measure([](qint64 iterations)
+    {
+        ActionProgram program;
+        int loopBegin = program.append(OpCode::LoopBegin, static_cast<qint32>(qMin<qint64>(iterations, 2000000000)));
+        program.append(OpCode::Wait, 10, 5);
+        program.append(OpCode::LoopEnd, 0, 0, 0, loopBegin + 1);
+        program.at(loopBegin).d = program.size();
+        program.append(OpCode::Halt);
+
+        NullSink sink;
+        ActionVM vm;
+        vm.load(&program, 1);
+        vm.reset(0);
+        qint64 now = 0;
+        while (now >= 0)
+        {
+            now = vm.run(now, sink);
+        }
+    }, 1024);
+}
+
+/**
+ * @brief Clicks of a job at a chosen location, one click per operation. Baseline for the pattern sweeps.
+ */
+
+QJsonObject BenchmarkSuite::benchmarkSinglePointLoop()
+{
+    ClickJob job;
+    job.locationType = 'c';
+    job.location = QPoint(500, 500);
+    return measureClickJob(job, 1);
+}
+
+/**
+ * @brief Clicks of a 32 x 32 grid sweep, one click per operation.
+ */
+
+QJsonObject BenchmarkSuite::benchmarkGridSweep()
+{
+    ClickJob job;
+    job.locationType = 'p';
+    job.pattern = PointPattern::grid(QPoint(100, 100), 32, 32, 10);
+    return measureClickJob(job, 1024);
+}
+
+/**
+ * @brief Clicks of a 1024 point spiral sweep, one click per operation.
+ */
+
+QJsonObject BenchmarkSuite::benchmarkSpiralSweep()
+{
+    ClickJob job;
+    job.locationType = 'p';
+    job.pattern = PointPattern::spiral(QPoint(500, 500), 10, 1024);
+    return measureClickJob(job, 1024);
+}
+
+/**
+ * @brief Clicks of a one pixel spaced sweep along an eight segment zigzag, one click per operation.
+ */
+
+QJsonObject BenchmarkSuite::benchmarkPolylineSweep()
+{
+    QVector<QPoint> vertices;
+    for (int i = 0; i <= 8; ++i)
+    {
+        vertices.append(QPoint(100 + i * 128, (i % 2) ? 228 : 100));
+    }
+    ClickJob job;
+    job.locationType = 'p';
+    job.pattern = PointPattern::polyline(vertices, 1);
+    return measureClickJob(job, static_cast<qint64>(job.pattern.size()));
+}
+
+/**
+ * @brief Locating a 64 x 64 template in a full HD frame, one search per operation; should take a few milliseconds.
+ *
+ * @details The frame is random texture in 4 x 4 pixel cells, so only the true location scores high and the coarse
+ * pyramid levels cannot settle on a wrong candidate. The template is cut from the frame. Whether the search found
+ * the template at the right place is reported as well, since a fast search that misses is worthless.
+ */
+
+QJsonObject BenchmarkSuite::benchmarkTargetSearch()
+{
+    QRandomGenerator random(1);
+    QImage frame(1920, 1080, QImage::Format_RGB32);
+    QVector<QRgb> cells((frame.width() / 4) * (frame.height() / 4));
+    for (QRgb& cell : cells)
+    {
+        cell = random.generate() | 0xff000000;
+    }
+    for (int y = 0; y < frame.height(); ++y)
+    {
+        QRgb *line = reinterpret_cast<QRgb *>(frame.scanLine(y));
+        for (int x = 0; x < frame.width(); ++x)
+        {
+            line[x] = cells.at((y / 4) * (frame.width() / 4) + x / 4);
+        }
+    }
+
+    QRect target(1203, 617, 64, 64);
+    TargetFinder finder;
+    finder.setTemplateImage(frame.copy(target));
+
+    QPoint center;
+    double score = 0.0;
+    bool found = finder.locate(frame, center, score) && (center - target.center()).manhattanLength() <= 2;
+
+    QJsonObject result = measure([&finder, &frame](qint64 iterations)
+    {
+        QPoint center;
+        double score = 0.0;
+        int sum = 0;
+        for (qint64 i = 0; i < iterations; ++i)
+        {
+            finder.locate(frame, center, score);
+            sum += center.x();
+        }
+        benchmarkSink = sum;
+    });
+    result["found"] = found;
+    result["score"] = score;
+    return result;
+}
+
+/**
+ * @brief Translating a text into key strokes for the current keyboard layout, one character per operation.
+ */
+
+QJsonObject BenchmarkSuite::benchmarkTextTranslation()
+{
+    const QString text = benchmarkText();
+    return measure([&text](qint64 iterations)
+    {
+        int strokes = 0;
+        for (qint64 done = 0; done < iterations; done += text.size())
+        {
+            strokes += KeySequence::translate(text).strokeCount();
+        }
+        benchmarkSink = strokes;
+    }, 1024);
+}
+
+/**
+ * @brief Dispatching a pre-translated text at zero delay through the VM, one character per operation: the VM hands
+ * the whole text to a sink that discards it. This covers the VM's share of typing only; the SendInput call that
+ * MouseManager makes for the batch is not part of it, since it would type into the focused window. Also reported
+ * as dispatched characters per second.
+ */
+
+QJsonObject BenchmarkSuite::benchmarkTypingDispatch()
+{
+    ClickJob job;
+    job.actionType = 't';
+    job.text = KeySequence::translate(benchmarkText());
+    QJsonObject result = measureClickJob(job, job.text.characterCount());
+    result["dispatchedCharactersPerSecond"] = 1e9 / result["nsPerOp"].toDouble();
+    return result;
+}
+
+/**
+ * @brief Returns 1024 characters of mixed text: letters, digits, punctuation, line breaks and non-ASCII characters.
+ */
+
+QString BenchmarkSuite::benchmarkText()
+{
+    const QString sample = QString::fromUtf8("The quick brown fox jumps over 13 lazy dogs; \xc3\xa9t\xc3\xa9 \xe2\x82\xac" "5!\n");
+    QString text;
+    while (text.size() < 1024)
+    {
+        text += sample;
+    }
+    text.truncate(1024);
+    return text;
+}
+
+/**
+ * @brief Measures a compiled click job running in the VM without input injection.
+ *
+ * @param job The job; its repetitions are set from the iteration count.
+ * @param clicksPerRepetition The number of clicks of one repetition, so that one operation is one click.
+ */
+
+QJsonObject BenchmarkSuite::measureClickJob(ClickJob job, qint64 clicksPerRepetition)
+{
+    job.timeToClick = 1;
+    return measure([job, clicksPerRepetition](qint64 iterations)
+    {
+        ClickJob sized = job;
+        sized.repetitions = static_cast<int>(qBound<qint64>(1, iterations / clicksPerRepetition, 2000000000));
+
+        ActionProgram program;
+        sized.compile(program);
+
+        NullSink sink;
+        ActionVM vm;
+        vm.load(&program, 1);
+        vm.reset(0);
+        qint64 now = 0;
+        while (now >= 0)
+        {
+            now = vm.run(now, sink);
+        }
+    }, 1024);
+}
+
+/**
+ * @brief Building the run plan when a job starts: the option lookups of InputManager::updateUserData and the
+ * translation of the job into a program.
+ */
+
+QJsonObject BenchmarkSuite::benchmarkRunPlan()
+{
+    QMap<QString, QString> radioButtonValues = {
+        {"RepetitionMode", "repeat"}, {"PressType", "double press"}, {"LocationOption", "random within area"}
+    };
+
+    return measure([&radioButtonValues](qint64 iterations)
+    {
+        ActionProgram program;
+        ClickJob job;
+        for (qint64 i = 0; i < iterations; ++i)
+        {
+            job.repetitions = radioButtonValues["RepetitionMode"].toLower() != "repeat" ? 2000000000 : 100;
+            job.clickType = radioButtonValues["PressType"].at(0);
+            job.locationType = radioButtonValues["LocationOption"].at(0);
+            job.timeToClick = 100 + static_cast<int>(i & 7);
+            job.compile(program);
+        }
+        benchmarkSink = program.size();
+    }, 256);
+}
+
+/**
+ * @brief The hotkey decision made for every system-wide keyboard event in HookWorker::inputEvent.
+ */
+
+QJsonObject BenchmarkSuite::benchmarkHotkeyProcessing()
+{
+    return measure([](qint64 iterations)
+    {
+        HotkeyFilter filter;
+        filter.setVkCode(0x75);
+        int triggered = 0;
+        for (qint64 i = 0; i < iterations; ++i)
+        {
+            // Mostly unrelated keys, with a press and release of the hotkey every 16 events.
+            int virtualKey = (i & 15) < 2 ? 0x75 : 0x41 + static_cast<int>(i & 15);
+            triggered += filter.process((i & 1) == 0, virtualKey);
+        }
+        benchmarkSink = triggered;
+    }, 4096);
+}
+
+/**
+ * @brief Queued signal delivery to an object living on another thread, the path every command to
+ * WindowsHookManager takes.
+ */
+
+QJsonObject BenchmarkSuite::benchmarkSignalDelivery()
+{
+    QThread thread;
+    QObject receiver;
+    receiver.moveToThread(&thread);
+    thread.start();
+
+    std::atomic<qint64> delivered(0);
+    QJsonObject result = measure([&receiver, &delivered](qint64 iterations)
+    {
+        delivered.store(0);
+        for (qint64 i = 0; i < iterations; ++i)
+        {
+            QMetaObject::invokeMethod(&receiver, [&delivered]()
+            {
+                delivered.fetch_add(1, std::memory_order_relaxed);
+            }, Qt::QueuedConnection);
+        }
+        while (delivered.load() < iterations)
+        {
+            QThread::yieldCurrentThread();
+        }
+    }, 256);
+
+    thread.quit();
+    thread.wait();
+    return result;
+}
+
+/**
+ * @brief Time from a stop request until an idle engine thread, sleeping in its event loop, handles the wake-up.
+ */
+
+QJsonObject BenchmarkSuite::benchmarkStopWake()
+{
+    QThread thread;
+    QObject receiver;
+    receiver.moveToThread(&thread);
+    thread.start();
+
+    StopToken token;
+    std::atomic<qint64> woken(0);
+    token.setWakeHandler([&receiver, &woken]()
+    {
+        QMetaObject::invokeMethod(&receiver, [&woken]()
+        {
+            woken.fetch_add(1, std::memory_order_release);
+        }, Qt::QueuedConnection);
+    });
+
+    QJsonObject result = measure([&token, &woken](qint64 iterations)
+    {
+        for (qint64 i = 0; i < iterations; ++i)
+        {
+            qint64 before = woken.load(std::memory_order_acquire);
+            token.arm();
+            token.requestStop();
+            while (woken.load(std::memory_order_acquire) == before)
+            {
+                QThread::yieldCurrentThread();
+            }
+            token.finish();
+        }
+    }, 16);
+
+    thread.quit();
+    thread.wait();
+    return result;
+}
+
+/**
+ * @brief How late a thread running under the scheduling policy wakes up from a 1 ms sleep.
+ *
+ * @details The thread applies the scheduler role of the policy and holds the timer resolution like a running job,
+ * so running the benchmark with different --priority, --scheduler-cpu and --no-timer-resolution options shows
+ * the effect of the policy. Not a per-operation cost: nsPerOp is the median lateness, and the report of the
+ * policy, including its fallbacks, is part of the result.
+ */
+
+QJsonObject BenchmarkSuite::benchmarkTimerWake()
+{
+    SchedulingPolicy *policy = SchedulingPolicy::getInstance();
+    QVector<qint64> lateness;
+    lateness.reserve(timerWakeSamples);
+
+    QThread *thread = QThread::create([policy, &lateness]()
+    {
+        policy->applyToCurrentThread(SchedulingPolicy::Scheduler);
+        policy->beginTimerResolution();
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < timerWakeSamples; ++i)
+        {
+            qint64 deadline = timer.nsecsElapsed() + static_cast<qint64>(timerWakeInterval) * 1000;
+            QThread::usleep(timerWakeInterval);
+            lateness.append(qMax<qint64>(0, timer.nsecsElapsed() - deadline));
+        }
+        policy->endTimerResolution();
+    });
+    thread->start(QThread::TimeCriticalPriority);
+    thread->wait();
+    delete thread;
+
+    std::sort(lateness.begin(), lateness.end());
+    QJsonObject result;
+    result["nsPerOp"] = static_cast<double>(lateness.at(lateness.size() / 2));
+    result["minNsPerOp"] = static_cast<double>(lateness.first());
+    result["p99Ns"] = static_cast<double>(lateness.at(lateness.size() * 99 / 100));
+    result["maxNs"] = static_cast<double>(lateness.last());
+    result["iterations"] = static_cast<double>(lateness.size());
+    result["policy"] = QJsonArray::fromStringList(policy->getReport());
+    return result;
+}
+
+/**
+ * @brief Saving the VM state of a running job into the memory-mapped checkpoint, as done after every wake-up.
+ */
+
+QJsonObject BenchmarkSuite::benchmarkCheckpointSave()
+{
+    QTemporaryDir directory;
+    JobCheckpoint checkpoint;
+    checkpoint.open(directory.filePath("checkpoint.bin"));
+
+    ClickJob job;
+    job.repetitions = 2000000000;
+    ActionProgram program;
+    job.compile(program);
+    ActionVM vm;
+    vm.load(&program, 1);
+    vm.reset(0);
+    quint64 fingerprint = program.fingerprint();
+
+    return measure([&vm, &checkpoint, fingerprint](qint64 iterations)
+    {
+        ActionVM::State state;
+        for (qint64 i = 0; i < iterations; ++i)
+        {
+            vm.saveState(state, i);
+            checkpoint.save(fingerprint, state);
+        }
+    }, 1024);
+}
+
+/**
+ * @brief Recording one trace event into the thread's buffer, with the writer thread draining it into a file.
+ *
+ * @details A round records far more events than a buffer holds, while the writer only drains every flushInterval,
+ * so the events are recorded in batches of half a buffer and the buffer is drained between them, untimed. Otherwise
+ * most calls would take the cheaper drop path. Any dropped record makes the measurement invalid.
+ */
+
+QJsonObject BenchmarkSuite::benchmarkTraceRecord()
+{
+    QTemporaryDir directory;
+    Tracer *tracer = Tracer::getInstance();
+    tracer->start(directory.filePath("benchmark.trace"));
+    quint64 droppedBefore = tracer->getDroppedCount();
+
+    QJsonObject result = measureTimed([tracer](qint64 iterations)
+    {
+        constexpr qint64 batch = TraceBuffer::capacity / 2;
+        QElapsedTimer timer;
+        qint64 elapsed = 0;
+        for (qint64 first = 0; first < iterations; first += batch)
+        {
+            qint64 last = qMin(iterations, first + batch);
+            timer.start();
+            for (qint64 i = first; i < last; ++i)
+            {
+                Tracer::record(Tracer::Schedule, i, 0);
+            }
+            elapsed += timer.nsecsElapsed();
+            tracer->drain();
+        }
+        return elapsed;
+    }, 1024);
+
+    quint64 dropped = tracer->getDroppedCount() - droppedBefore;
+    tracer->stop();
+    result["dropped"] = static_cast<double>(dropped);
+    result["valid"] = dropped == 0;
+    return result;
+}
+
+/**
+ * @brief Saving a profile with the same keys as MainWindow, including the write to disk.
+ */
+
+QJsonObject BenchmarkSuite::benchmarkProfileSave()
+{
+    QTemporaryDir directory;
+    QString path = directory.filePath("profile.ini");
+
+    return measure([&path](qint64 iterations)
+    {
+        for (qint64 i = 0; i < iterations; ++i)
+        {
+            QSettings settings(path, QSettings::IniFormat);
+            for (const char *key : profileKeys)
+            {
+                settings.setValue(key, QString::number(i));
+            }
+            settings.sync();
+        }
+    });
+}
+
+/**
+ * @brief Loading a profile with the same keys as MainWindow.
+ */
+
+QJsonObject BenchmarkSuite::benchmarkProfileLoad()
+{
+    QTemporaryDir directory;
+    QString path = directory.filePath("profile.ini");
+    {
+        QSettings settings(path, QSettings::IniFormat);
+        for (const char *key : profileKeys)
+        {
+            settings.setValue(key, "100");
+        }
+    }
+
+    return measure([&path](qint64 iterations)
+    {
+        int sum = 0;
+        for (qint64 i = 0; i < iterations; ++i)
+        {
+            QSettings settings(path, QSettings::IniFormat);
+            for (const char *key : profileKeys)
+            {
+                sum += settings.value(key).toString().length();
+            }
+        }
+        benchmarkSink = sum;
+    });
+}
@@ -0,0 +1,52 @@
+#ifndef BENCHMARKSUITE_H
+#define BENCHMARKSUITE_H
+
+#include "areasampler.h"
+#include "clickjob.h"
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <functional>
+
+class BenchmarkSuite
+{
+public:
+    QJsonObject run();
+
+    static QStringList compare(const QJsonObject& current, const QJsonObject& baseline, double threshold);
+
+private:
+    static constexpr int rounds = 5;
+    static constexpr qint64 minimumRoundTime = 50000000;
+    static constexpr int timerWakeSamples = 500;
+    static constexpr unsigned long timerWakeInterval = 1000;
+
+    QJsonObject measure(const std::function<void(qint64)>& body, qint64 initialIterations = 1);
+    QJsonObject measureTimed(const std::function<qint64(qint64)>& body, qint64 initialIterations = 1);
+    QJsonObject measureClickJob(ClickJob job, qint64 clicksPerRepetition);
+
+    QJsonObject benchmarkRandomPoint();
+    QJsonObject benchmarkPolygonSampling();
+    QJsonObject benchmarkMaskSampling();
+    QJsonObject measureSampling(const AreaSampler& sampler);
+    QJsonObject benchmarkIntervalSampling();
+    QJsonObject benchmarkSinglePointLoop();
+    QJsonObject benchmarkGridSweep();
+    QJsonObject benchmarkSpiralSweep();
+    QJsonObject benchmarkPolylineSweep();
+    QJsonObject benchmarkTargetSearch();
+    QJsonObject benchmarkTextTranslation();
+    QJsonObject benchmarkTypingDispatch();
+    static QString benchmarkText();
+    QJsonObject benchmarkRunPlan();
+    QJsonObject benchmarkHotkeyProcessing();
+    QJsonObject benchmarkSignalDelivery();
+    QJsonObject benchmarkStopWake();
+    QJsonObject benchmarkTimerWake();
+    QJsonObject benchmarkCheckpointSave();
+    QJsonObject benchmarkTraceRecord();
+    QJsonObject benchmarkProfileSave();
+    QJsonObject benchmarkProfileLoad();
+};
+
+#endif // BENCHMARKSUITE_H
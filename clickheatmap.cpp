@@ -0,0 +1,108 @@
+#include "clickheatmap.h"
+#include <QPainter>
+#include <QtMath>
+
+/**
+ * @brief Heatmap of the locations the running job clicked, shown on the statistics tab.
+ *
+ * @details Clicks are accumulated into a density grid of cellSize x cellSize desktop pixels. The grid is only
+ * turned into an image when refresh() finds new clicks, so repaints follow the dashboard's capped polling rate and
+ * not the click rate. The view is zoomed to the cells that were hit, so a small click area fills the widget.
+ * Densities are colored on a logarithmic scale from blue to red.
+ */
+
+ClickHeatmap::ClickHeatmap(QWidget *parent)
+    : QWidget{parent}
+{
+    setMinimumHeight(120);
+}
+
+/**
+ * @brief Clears the heatmap for a new run.
+ *
+ * @param desktop The virtual desktop the click locations lie in.
+ */
+
+void ClickHeatmap::reset(const QRect& desktop)
+{
+    this->desktop = desktop;
+    columns = qMax(1, (desktop.width() + cellSize - 1) / cellSize);
+    rows = qMax(1, (desktop.height() + cellSize - 1) / cellSize);
+    density.fill(0, columns * rows);
+    peak = 0;
+    occupied = QRect();
+    image = QImage();
+    isDirty = false;
+    update();
+}
+
+/**
+ * @brief Adds one click; locations outside the desktop are ignored.
+ */
+
+void ClickHeatmap::addClick(const QPoint& point)
+{
+    if (!desktop.contains(point))
+    {
+        return;
+    }
+
+    int column = (point.x() - desktop.left()) / cellSize;
+    int row = (point.y() - desktop.top()) / cellSize;
+    quint32& cell = density[row * columns + column];
+    peak = qMax(peak, ++cell);
+    occupied |= QRect(column, row, 1, 1);
+    isDirty = true;
+}
+
+/**
+ * @brief Redraws the heatmap if clicks were added since the last call.
+ */
+
+void ClickHeatmap::refresh()
+{
+    if (!isDirty)
+    {
+        return;
+    }
+    isDirty = false;
+
+    QRect view = occupied.adjusted(-margin, -margin, margin, margin).intersected(QRect(0, 0, columns, rows));
+    image = QImage(view.size(), QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    double scale = 1.0 / qLn(1.0 + peak);
+
+    for (int y = 0; y < view.height(); ++y)
+    {
+        QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+        const quint32 *cells = density.constData() + (view.top() + y) * columns + view.left();
+        for (int x = 0; x < view.width(); ++x)
+        {
+            if (cells[x] != 0)
+            {
+                double intensity = qLn(1.0 + cells[x]) * scale;
+                line[x] = QColor::fromHsvF(0.66 * (1.0 - intensity), 1.0, 0.4 + 0.6 * intensity).rgba();
+            }
+        }
+    }
+    update();
+}
+
+/**
+ * @brief Paints the heatmap scaled to the widget, keeping the aspect ratio of the desktop.
+ */
+
+void ClickHeatmap::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().base());
+    if (image.isNull())
+    {
+        return;
+    }
+
+    QSize target = image.size().scaled(size(), Qt::KeepAspectRatio);
+    QRect area(QPoint((width() - target.width()) / 2, (height() - target.height()) / 2), target);
+    painter.drawImage(area, image);
+}
@@ -0,0 +1,36 @@
+#ifndef CLICKHEATMAP_H
+#define CLICKHEATMAP_H
+
+#include <QImage>
+#include <QRect>
+#include <QVector>
+#include <QWidget>
+
+class ClickHeatmap : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit ClickHeatmap(QWidget *parent = nullptr);
+
+    void reset(const QRect& desktop);
+    void addClick(const QPoint& point);
+    void refresh();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    static constexpr int cellSize = 4;
+    static constexpr int margin = 4;
+
+    QRect desktop;
+    int columns = 0;
+    int rows = 0;
+    QVector<quint32> density;
+    quint32 peak = 0;
+    QRect occupied;
+    bool isDirty = false;
+    QImage image;
+};
+
+#endif // CLICKHEATMAP_H
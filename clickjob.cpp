@@ -0,0 +1,139 @@
+#include "clickjob.h"
+#include "actionvm.h"
+
+/**
+ * @brief Settings of a job configured in the main window and their translation into an ActionProgram.
+ *
+ * @details Kept free of platform code, so the live scheduler and the EngineSimulator execute exactly the same
+ * program for the same settings.
+ */
+
+/**
+ * @brief Translates the job settings into an ActionProgram.
+ *
+ * @param program Receives the bytecode; cleared first.
+ *
+ * @details The program is one loop over the configured repetitions. For the timed modes the body waits the
+ * click interval, resolves the point (fixed, random within the area or the located target; a target that is
+ * not found retries without counting a repetition) and performs the action. The watch mode polls the region
+ * every watchInterval and only reaches the action, followed by the click interval, once the region changed.
+ * With isClickFirst the timed modes wait after the action instead, so the first action fires the moment the
+ * program starts (used by scheduled starts); a target that is not found then waits in a retry block after Halt.
+ * The pattern mode sweeps the pattern inside the body and counts one repetition per complete sweep. The random
+ * area mode samples the shape at shapeOrigin if one is set and the circle of radius area otherwise.
+ */
+
+void ClickJob::compile(ActionProgram& program) const
+{
+    bool isWatch = locationType == 'w';
+    bool isPattern = locationType == 'p';
+    bool waitsFirst = !isWatch && !isClickFirst;
+
+    program.clear();
+    int loopBegin = program.append(OpCode::LoopBegin, repetitions);
+    int body = program.size();
+
+    int patternIndex = -1;
+    if (isPattern)
+    {
+        patternIndex = program.append(OpCode::SetPointPattern, program.addPattern(pattern));
+    }
+
+    if (isWatch)
+    {
+        program.append(OpCode::Wait, watchInterval);
+        program.append(OpCode::WatchRegion, 0, 0, 0, body);
+    } else if (waitsFirst)
+    {
+        program.append(OpCode::Wait, timeToClick, addRandomTime);
+    }
+
+    bool hasPoint = true;
+    int targetIndex = -1;
+    if (locationType == 'c' || isWatch)
+    {
+        program.append(OpCode::SetPoint, location.x(), location.y());
+    } else if (locationType == 'r' && !shape.isEmpty())
+    {
+        program.append(OpCode::SetPointShape, program.addShape(shape), shapeOrigin.x(), shapeOrigin.y());
+    } else if (locationType == 'r')
+    {
+        program.append(OpCode::SetPointArea, location.x(), location.y(), area);
+    } else if (locationType == 't')
+    {
+        targetIndex = program.append(OpCode::FindTarget, 0, 0, 0, body);
+    } else if (!isPattern)
+    {
+        hasPoint = false;
+    }
+
+    appendAction(program, hasPoint);
+
+    if (!waitsFirst)
+    {
+        program.append(OpCode::Wait, timeToClick, addRandomTime);
+    }
+
+    if (isPattern)
+    {
+        program.append(OpCode::Jump, 0, 0, 0, body);
+        program.at(patternIndex).d = program.size();
+    }
+
+    program.append(OpCode::LoopEnd, 0, 0, 0, body);
+    program.at(loopBegin).d = program.size();
+    program.append(OpCode::Halt);
+
+    if (isClickFirst && targetIndex >= 0)
+    {
+        program.at(targetIndex).d = program.size();
+        program.append(OpCode::Wait, timeToClick, addRandomTime);
+        program.append(OpCode::Jump, 0, 0, 0, body);
+    }
+}
+
+/**
+ * @brief Appends the instructions of the configured action: the press type of a mouse action, or a key press
+ * ('p'), a key held for holdDuration ('h') or the typed text ('t'). Key actions ignore the point; the location
+ * modes still decide when they fire, e.g. once the target is found.
+ *
+ * @param program The program being built.
+ * @param hasPoint Whether the point register holds the action location; otherwise, the current cursor position is used.
+ */
+
+void ClickJob::appendAction(ActionProgram& program, bool hasPoint) const
+{
+    int clicks = clickType == 'd' ? 2 : 1;
+
+    if (actionType == 'p')
+    {
+        program.append(OpCode::Key, virtualKey);
+    } else if (actionType == 'h')
+    {
+        program.append(OpCode::KeyDown, virtualKey);
+        program.append(OpCode::Wait, holdDuration);
+        program.append(OpCode::KeyUp, virtualKey);
+    } else if (actionType == 't')
+    {
+        program.append(OpCode::TypeText, program.addText(text), characterDelay);
+    } else if (clickType == 'h')
+    {
+        if (!hasPoint)
+        {
+            program.append(OpCode::SetPointCursor);
+        }
+        program.append(OpCode::Press, ActionSink::Left);
+        program.append(OpCode::Glide, isCurvedMovement ? moveDuration : movementStep);
+        program.append(OpCode::Release, ActionSink::Left);
+    } else if (hasPoint)
+    {
+        if (isCurvedMovement)
+        {
+            program.append(OpCode::Glide, moveDuration);
+        }
+        program.append(OpCode::ClickAt, ActionSink::Left, clicks);
+    } else
+    {
+        program.append(OpCode::Click, ActionSink::Left, clicks);
+    }
+}
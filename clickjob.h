@@ -0,0 +1,40 @@
+#ifndef CLICKJOB_H
+#define CLICKJOB_H
+
+#include "actionprogram.h"
+#include "areasampler.h"
+#include "keysequence.h"
+#include "pointpattern.h"
+#include <QChar>
+#include <QPoint>
+
+struct ClickJob {
+    static constexpr int watchInterval = 5;
+    static constexpr int movementStep = 5;
+
+    QChar locationType = 'l';
+    QChar clickType = 's';
+    int timeToClick = 100;
+    int addRandomTime = 0;
+    int repetitions = 1;
+    int area = 0;
+    QPoint location;
+    bool isCurvedMovement = false;
+    int moveDuration = 200;
+    bool isClickFirst = false;
+    PointPattern pattern;
+    AreaSampler shape;
+    QPoint shapeOrigin;
+    QChar actionType = 'm';
+    int virtualKey = 0x20;
+    int holdDuration = 100;
+    KeySequence text;
+    int characterDelay = 0;
+
+    void compile(ActionProgram& program) const;
+
+private:
+    void appendAction(ActionProgram& program, bool hasPoint) const;
+};
+
+#endif // CLICKJOB_H
@@ -0,0 +1,125 @@
+#include "cursorpath.h"
+#include <QtMath>
+
+/**
+ * @brief Precomputed cursor path from the current position to a target along a curved, human-like trajectory.
+ *
+ * @details The geometry is a cubic Bezier curve whose two control points are pushed sideways by a random amount,
+ * and the progress along it follows the minimum-jerk profile 10t^3 - 15t^4 + 6t^5 (slow start, fast middle,
+ * slow arrival). All points are generated by build() into a buffer that keeps its capacity between paths, and
+ * the profile table is only rebuilt when the number of steps changes, so emitting the steps with next() costs
+ * neither allocation nor floating point math.
+ */
+
+CursorPath::CursorPath()
+    : position(0)
+{
+}
+
+/**
+ * @brief Generates the path points.
+ *
+ * @param start The current cursor position.
+ * @param end The target position, always the last point of the path.
+ * @param duration The travel time in milliseconds.
+ * @param stepInterval The time between two emitted points in milliseconds.
+ * @param firstBend Sideways offset of the first control point, in range -1..1 of the maximal curvature.
+ * @param secondBend Sideways offset of the second control point, in range -1..1 of the maximal curvature.
+ */
+
+void CursorPath::build(const QPoint& start, const QPoint& end, int duration, int stepInterval, double firstBend, double secondBend)
+{
+    int steps = qMax(1, duration / qMax(1, stepInterval));
+    if (profile.size() != steps)
+    {
+        buildProfile(steps);
+    }
+
+    double deltaX = end.x() - start.x();
+    double deltaY = end.y() - start.y();
+    double length = qSqrt(deltaX * deltaX + deltaY * deltaY);
+    double normalX = length > 0.0 ? -deltaY / length : 0.0;
+    double normalY = length > 0.0 ? deltaX / length : 0.0;
+    double firstOffset = qBound(-1.0, firstBend, 1.0) * maxCurvature * length;
+    double secondOffset = qBound(-1.0, secondBend, 1.0) * maxCurvature * length;
+
+    double firstX = start.x() + deltaX * 0.3 + normalX * firstOffset;
+    double firstY = start.y() + deltaY * 0.3 + normalY * firstOffset;
+    double secondX = start.x() + deltaX * 0.7 + normalX * secondOffset;
+    double secondY = start.y() + deltaY * 0.7 + normalY * secondOffset;
+
+    points.resize(steps);
+    for (int i = 0; i < steps; ++i)
+    {
+        double s = profile.at(i);
+        double inverse = 1.0 - s;
+        double a = inverse * inverse * inverse;
+        double b = 3.0 * inverse * inverse * s;
+        double c = 3.0 * inverse * s * s;
+        double d = s * s * s;
+        points[i] = QPoint(qRound(a * start.x() + b * firstX + c * secondX + d * end.x()),
+                           qRound(a * start.y() + b * firstY + c * secondY + d * end.y()));
+    }
+    points[steps - 1] = end;
+    position = 0;
+}
+
+/**
+ * @brief Fills the minimum-jerk progress table for the given number of steps.
+ */
+
+void CursorPath::buildProfile(int steps)
+{
+    profile.resize(steps);
+    for (int i = 0; i < steps; ++i)
+    {
+        double t = static_cast<double>(i + 1) / steps;
+        profile[i] = t * t * t * (10.0 - 15.0 * t + 6.0 * t * t);
+    }
+}
+
+/**
+ * @brief Drops the remaining points, keeping the buffers for the next path.
+ */
+
+void CursorPath::clear()
+{
+    points.resize(0);
+    position = 0;
+}
+
+/**
+ * @brief Checks whether all points have been emitted.
+ */
+
+bool CursorPath::atEnd() const
+{
+    return position >= points.size();
+}
+
+/**
+ * @brief Returns the next point of the path; must not be called when atEnd() is true.
+ */
+
+QPoint CursorPath::next()
+{
+    return points.at(position++);
+}
+
+/**
+ * @brief Returns the target of the path.
+ */
+
+QPoint CursorPath::getEnd() const
+{
+    return points.isEmpty() ? QPoint() : points.last();
+}
+
+/**
+ * @brief Returns the number of points in the path.
+ */
+
+int CursorPath::size() const
+{
+    return points.size();
+}
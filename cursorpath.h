@@ -0,0 +1,29 @@
+#ifndef CURSORPATH_H
+#define CURSORPATH_H
+
+#include <QPoint>
+#include <QVector>
+
+class CursorPath
+{
+public:
+    CursorPath();
+
+    void build(const QPoint& start, const QPoint& end, int duration, int stepInterval, double firstBend, double secondBend);
+    void clear();
+    bool atEnd() const;
+    QPoint next();
+    QPoint getEnd() const;
+    int size() const;
+
+private:
+    static constexpr double maxCurvature = 0.15;
+
+    QVector<QPoint> points;
+    QVector<double> profile;
+    int position;
+
+    void buildProfile(int steps);
+};
+
+#endif // CURSORPATH_H
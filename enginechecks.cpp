@@ -0,0 +1,549 @@
+#include "enginechecks.h"
+#include "engineclock.h"
+#include "framesource.h"
+#include "inputinjector.h"
+#include "mousemanager.h"
+#include "regionwatcher.h"
+#include "screenlayout.h"
+#include "stoptoken.h"
+#include <QCoreApplication>
+#include <QDeadlineTimer>
+#include <QDialog>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QLabel>
+#include <QRandomGenerator>
+#include <QSettings>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
+#include <atomic>
+#include <functional>
+
+/**
+ * @brief Functional checks of the real clicking engine that can run without user interaction.
+ *
+ * @details The engine checks run a MouseManager on its own time-critical thread, as the InputManager does, with a
+ * RecordingInjector in place of SendInput, so nothing reaches the system and every injection is recorded, and with a
+ * checkpoint file in a temporary directory, so the user's crash checkpoint is left alone. The checks report their
+ * measurements and every failed expectation. The GUI load check shows a window for a few seconds; its limit is a
+ * timing limit and can be missed on an overloaded machine, the others are exact.
+ */
+
+namespace
+{
+class EngineUnderTest
+{
+public:
+    EngineUnderTest(EngineClock *clock, InputInjector *injector)
+    {
+        thread.setObjectName("ClickEngine");
+        engine = new MouseManager();
+        engine->moveToThread(&thread);
+        QObject::connect(&thread, &QThread::finished, engine, &QObject::deleteLater);
+        QObject::connect(engine, &MouseManager::finished, engine, [this]()
+        {
+            ++finishes;
+        });
+        thread.start(QThread::TimeCriticalPriority);
+        QString checkpointPath = directory.filePath("checkpoint.bin");
+        invoke([this, clock, injector, checkpointPath]()
+        {
+            engine->setClock(clock);
+            engine->setInjector(injector);
+            engine->setCheckpointPath(checkpointPath);
+        });
+    }
+
+    ~EngineUnderTest()
+    {
+        thread.quit();
+        thread.wait();
+    }
+
+    void invoke(const std::function<void()>& call)
+    {
+        QMetaObject::invokeMethod(engine, call, Qt::BlockingQueuedConnection);
+    }
+
+    void start(int clickTime, int randomTime, QChar type, int repetitions, const QPoint& location)
+    {
+        invoke([this, clickTime, randomTime, type, repetitions, location]()
+        {
+            engine->runClickingApplication(clickTime, randomTime, type, repetitions, 'c', location, 0);
+        });
+    }
+
+    bool waitFor(const std::function<bool()>& condition, int timeout)
+    {
+        QDeadlineTimer deadline(timeout);
+        invoke([]() {});
+        while (!condition())
+        {
+            if (deadline.hasExpired())
+            {
+                return false;
+            }
+            QThread::msleep(1);
+            invoke([]() {});
+        }
+        return true;
+    }
+
+    MouseManager *engine;
+    std::atomic<int> finishes{0};
+
+private:
+    QThread thread;
+    QTemporaryDir directory;
+};
+
+volatile int loadSink = 0;
+}
+
+/**
+ * @brief Runs all checks.
+ *
+ * @return One JSON object per check and the list of failed expectations.
+ */
+
+EngineChecks::Result EngineChecks::run()
+{
+    Result result;
+    result.checks["stopGuarantee"] = checkStopGuarantee(result.failures);
+    result.checks["virtualSchedule"] = checkVirtualSchedule(result.failures);
+    result.checks["regionWatcher"] = checkRegionWatcher(result.failures);
+    result.checks["guiLoad"] = checkGuiLoad(result.failures);
+    return result;
+}
+
+/**
+ * @brief Checks that no input is injected later than 1 ms after a stop request from another thread.
+ *
+ * @details A job without click interval injects as fast as the engine thread runs. After a random delay the
+ * calling thread requests the stop, like the hook thread does for the hotkey. The last non-release injection is
+ * compared with the request time; releases are allowed afterwards so nothing stays pressed. Every trial must have
+ * clicked before the request, so the check cannot pass without exercising the race.
+ */
+
+QJsonObject EngineChecks::checkStopGuarantee(QStringList& failures)
+{
+    SteadyClock clock;
+    RecordingInjector injector(clock);
+    qint64 lastPress = 0;
+    quint64 clicks = 0;
+    injector.setHandler([&lastPress, &clicks](const RecordingInjector::Record& record)
+    {
+        if (!record.isRelease)
+        {
+            lastPress = record.time;
+            clicks += record.buttonDowns;
+        }
+    });
+
+    StopToken *stopToken = StopToken::getInstance();
+    EngineUnderTest engine(&clock, &injector);
+    QRandomGenerator random(1);
+    qint64 maxOvershoot = 0;
+    quint64 totalClicks = 0;
+
+    for (int trial = 0; trial < stopTrials; ++trial)
+    {
+        engine.invoke([&lastPress, &clicks]()
+        {
+            lastPress = 0;
+            clicks = 0;
+        });
+        engine.start(0, 0, 's', 2000000000, QPoint(100, 100));
+        QThread::usleep(1000 + random.bounded(19000));
+
+        stopToken->requestStop();
+        qint64 requestTime = stopToken->getRequestTime();
+        if (!engine.waitFor([stopToken]() { return !stopToken->isRunning(); }, 1000))
+        {
+            failures.append("stopGuarantee: the engine did not stop within 1 s");
+            break;
+        }
+
+        if (clicks == 0 || requestTime == 0)
+        {
+            failures.append(QString("stopGuarantee: trial %1 did not click before the stop request").arg(trial));
+            continue;
+        }
+        totalClicks += clicks;
+        qint64 overshoot = lastPress - requestTime;
+        maxOvershoot = qMax(maxOvershoot, overshoot);
+        if (overshoot > maxStopOvershoot)
+        {
+            failures.append(QString("stopGuarantee: trial %1 injected %2 ms after the stop request").arg(trial).arg(overshoot / 1e6, 0, 'f', 3));
+        }
+    }
+
+    QJsonObject json;
+    json["trials"] = stopTrials;
+    json["clicks"] = static_cast<double>(totalClicks);
+    json["maxOvershootMs"] = maxOvershoot / 1e6;
+    return json;
+}
+
+/**
+ * @brief Checks the schedules of the real engine on a VirtualClock, where hours of clicking take seconds.
+ *
+ * @details The engine's timer fires at once with the clock moved to its deadline, so every click lands exactly on
+ * its scheduled time and the intervals between injections are the intervals the job asked for:
+ * - fixed: 1000 single clicks 100 ms apart, all at the configured location;
+ * - random: 100000 clicks with intervals between 10 and 20 ms, about 25 minutes of virtual time;
+ * - double: every repetition of a double click injects both presses at once;
+ * - stopHotkey: a stop requested from within the 500th injection ends an endless job after exactly 500 clicks and
+ *   is not reported as finished;
+ * - runDuration: a 1 s run duration with 100 ms intervals clicks 9 times and stops exactly on time.
+ * Every job but the stopped one must emit finished exactly once. The throughput of the scheduler is reported.
+ */
+
+QJsonObject EngineChecks::checkVirtualSchedule(QStringList& failures)
+{
+    VirtualClock clock;
+    RecordingInjector injector(clock);
+    QVector<RecordingInjector::Record> records;
+    int stopAfter = 0;
+    StopToken *stopToken = StopToken::getInstance();
+    injector.setHandler([&records, &stopAfter, stopToken](const RecordingInjector::Record& record)
+    {
+        records.append(record);
+        if (records.size() == stopAfter)
+        {
+            stopToken->requestStop();
+        }
+    });
+
+    EngineUnderTest engine(&clock, &injector);
+    QVector<double> stopErrors;
+    QObject::connect(engine.engine, &MouseManager::scheduleMeasured, engine.engine, [&stopErrors](const QString& event, double error)
+    {
+        if (event == "stop")
+        {
+            stopErrors.append(error);
+        }
+    });
+
+    QPoint location(200, 150);
+    QPoint position = ScreenLayout::toAbsolute(*ScreenLayout::getInstance()->snapshot(), location);
+    QJsonObject json;
+
+    auto runJob = [&](const QString& name, int clickTime, int randomTime, QChar type, int repetitions, int runDuration, int stopAt,
+                      int expectedClicks)
+    {
+        engine.invoke([&]()
+        {
+            records.clear();
+            records.reserve(expectedClicks);
+            stopErrors.clear();
+            stopAfter = stopAt;
+            engine.engine->setSchedule(0, runDuration);
+        });
+        engine.finishes = 0;
+        int expectedFinishes = stopAt > 0 ? 0 : 1;
+
+        QElapsedTimer wallTime;
+        wallTime.start();
+        engine.start(clickTime, randomTime, type, repetitions, location);
+        if (!engine.waitFor([&]() { return engine.finishes >= expectedFinishes && !stopToken->isRunning(); }, jobTimeout))
+        {
+            failures.append(QString("virtualSchedule: %1 did not end within %2 s").arg(name).arg(jobTimeout / 1000));
+            stopToken->requestStop();
+            engine.waitFor([stopToken]() { return !stopToken->isRunning(); }, jobTimeout);
+        }
+        qint64 elapsed = wallTime.nsecsElapsed();
+        engine.invoke([]() {});
+        int finishes = engine.finishes;
+
+        int downsPerClick = type == 'd' ? 2 : 1;
+        qint64 minInterval = clickTime * 1000000LL;
+        qint64 maxInterval = (clickTime + randomTime) * 1000000LL;
+        int badIntervals = 0;
+        int badClicks = 0;
+        for (int i = 0; i < records.size(); ++i)
+        {
+            const RecordingInjector::Record& record = records.at(i);
+            if (record.buttonDowns != downsPerClick || !record.hasPosition || record.position != position)
+            {
+                ++badClicks;
+            }
+            qint64 interval = i > 0 ? record.time - records.at(i - 1).time : minInterval;
+            if (interval < minInterval || interval > maxInterval)
+            {
+                ++badIntervals;
+            }
+        }
+
+        if (records.size() != expectedClicks)
+        {
+            failures.append(QString("virtualSchedule: %1 clicked %2 times instead of %3").arg(name).arg(records.size()).arg(expectedClicks));
+        }
+        if (badClicks > 0)
+        {
+            failures.append(QString("virtualSchedule: %1 injected %2 clicks with the wrong presses or position").arg(name).arg(badClicks));
+        }
+        if (badIntervals > 0)
+        {
+            failures.append(QString("virtualSchedule: %1 had %2 intervals outside %3-%4 ms").arg(name).arg(badIntervals).arg(clickTime).arg(clickTime + randomTime));
+        }
+        if (finishes != expectedFinishes)
+        {
+            failures.append(QString("virtualSchedule: %1 emitted finished %2 times instead of %3").arg(name).arg(finishes).arg(expectedFinishes));
+        }
+
+        QJsonObject job;
+        job["clicks"] = records.size();
+        job["virtualTimeMs"] = records.isEmpty() ? 0.0 : (records.last().time - records.first().time) / 1e6;
+        job["wallTimeMs"] = elapsed / 1e6;
+        job["clicksPerSecond"] = records.size() / qMax(1e-9, elapsed / 1e9);
+        json[name] = job;
+    };
+
+    runJob("fixed", 100, 0, 's', 1000, 0, 0, 1000);
+    runJob("random", 10, 10, 's', 100000, 0, 0, 100000);
+    runJob("double", 50, 0, 'd', 100, 0, 0, 100);
+    runJob("stopHotkey", 10, 0, 's', 2000000000, 0, 500, 500);
+    runJob("runDuration", 100, 0, 's', 2000000000, 1000, 0, 9);
+    if (stopErrors.size() != 1 || stopErrors.first() != 0.0)
+    {
+        failures.append("virtualSchedule: runDuration did not report one scheduled stop exactly on time");
+    }
+
+    engine.invoke([&engine]()
+    {
+        engine.engine->setSchedule(0, 0);
+    });
+    return json;
+}
+
+/**
+ * @brief Checks the change detection of the watch mode on frames replayed by a SyntheticFrameSource.
+ *
+ * @details The watched region is 70 x 40 pixels, so its right column and bottom row of blocks are partial. The
+ * frames are grabbed and handed to the RegionWatcher exactly as the capture thread and the engine do:
+ * - the first frame is the baseline and an unchanged frame does not trigger;
+ * - a change outside the watched region does not trigger;
+ * - a one-pixel change in the partial bottom-right block triggers once and reports that block;
+ * - the same frame again does not trigger, changing it back triggers again;
+ * - a one-pixel change in the top-left block triggers and reports block 0;
+ * - after reset() the next frame is a new baseline.
+ */
+
+QJsonObject EngineChecks::checkRegionWatcher(QStringList& failures)
+{
+    QRect region(40, 30, 70, 40);
+    QImage base(200, 120, QImage::Format_RGB32);
+    for (int y = 0; y < base.height(); ++y)
+    {
+        for (int x = 0; x < base.width(); ++x)
+        {
+            base.setPixel(x, y, qRgb((x * 7) & 0xff, (y * 13) & 0xff, (x * y) & 0xff));
+        }
+    }
+    QImage outside = base;
+    outside.setPixel(region.right() + 5, region.top(), qRgb(255, 0, 0));
+    QImage bottomRight = base;
+    bottomRight.setPixel(region.left() + 68, region.top() + 35, qRgb(255, 0, 0));
+    QImage topLeft = base;
+    topLeft.setPixel(region.left() + 5, region.top() + 5, qRgb(255, 0, 0));
+
+    struct Step {
+        const char *name;
+        bool isChanged;
+        int changedBlock;
+    };
+    const Step steps[] = {
+        {"baseline", false, -1},
+        {"unchanged", false, -1},
+        {"changeOutsideRegion", false, -1},
+        {"changeInPartialBlock", true, 14},
+        {"sameFrameAgain", false, -1},
+        {"changeBack", true, 14},
+        {"changeInFirstBlock", true, 0},
+        {"baselineAfterReset", false, -1},
+        {"unchangedAfterReset", false, -1}
+    };
+    const int stepCount = sizeof(steps) / sizeof(steps[0]);
+
+    SyntheticFrameSource source(QVector<QImage>{base, base, outside, bottomRight, bottomRight, base, topLeft, base, base});
+    CaptureBuffer buffer;
+    if (!source.allocate(buffer, region.size()))
+    {
+        failures.append("regionWatcher: the capture buffer could not be allocated");
+        return QJsonObject();
+    }
+
+    RegionWatcher watcher;
+    int triggers = 0;
+    for (int i = 0; i < stepCount; ++i)
+    {
+        if (i == 7)
+        {
+            watcher.reset();
+        }
+        if (!source.grab(buffer, region))
+        {
+            failures.append(QString("regionWatcher: frame %1 could not be grabbed").arg(i));
+            break;
+        }
+
+        QImage frame(buffer.bits, region.width(), region.height(), buffer.stride, QImage::Format_RGB32);
+        bool isChanged = watcher.processFrame(frame);
+        triggers += isChanged ? 1 : 0;
+        if (isChanged != steps[i].isChanged || watcher.getChangedBlock() != steps[i].changedBlock)
+        {
+            failures.append(QString("regionWatcher: %1 returned %2 with block %3, expected %4 with block %5").arg(steps[i].name)
+                                .arg(isChanged ? "true" : "false").arg(watcher.getChangedBlock())
+                                .arg(steps[i].isChanged ? "true" : "false").arg(steps[i].changedBlock));
+        }
+    }
+    source.release(buffer);
+
+    if (triggers != 3)
+    {
+        failures.append(QString("regionWatcher: %1 triggers instead of 3").arg(triggers));
+    }
+
+    QJsonObject json;
+    json["frames"] = stepCount;
+    json["triggers"] = triggers;
+    return json;
+}
+
+/**
+ * @brief Checks that load on the GUI thread does not make the engine's clicks late.
+ *
+ * @details The engine runs a job with a 5 ms interval on the steady clock, first while the calling thread idles and
+ * then while it does what the main window does under load: synchronous repaints of a visible window, QSettings
+ * writes and reads synced to an ini file, and the nested event loop of a modal dialog, as the hotkey dialog runs
+ * it. The lateness the engine measures itself (MouseManager::timingUpdated) is averaged over each phase; the first
+ * one-second window of a phase is skipped because it overlaps the previous phase. The check fails if the mean
+ * lateness under load exceeds the idle mean by more than maxGuiLoadDelta milliseconds.
+ */
+
+QJsonObject EngineChecks::checkGuiLoad(QStringList& failures)
+{
+    SteadyClock clock;
+    RecordingInjector injector(clock);
+    QVector<double> meanLateness;
+    QVector<double> maxLateness;
+
+    EngineUnderTest engine(&clock, &injector);
+    QObject::connect(engine.engine, &MouseManager::timingUpdated, engine.engine, [&meanLateness, &maxLateness](double mean, double max)
+    {
+        meanLateness.append(mean);
+        maxLateness.append(max);
+    });
+
+    QTemporaryDir directory;
+    QSettings settings(directory.filePath("load.ini"), QSettings::IniFormat);
+    QWidget window;
+    QLabel label(&window);
+    window.resize(480, 320);
+    label.resize(window.size());
+    window.show();
+
+    auto loadGuiThread = [&window, &label, &settings]()
+    {
+        for (int i = 0; i < 20; ++i)
+        {
+            label.setText(QString("Repaint %1").arg(i));
+            window.repaint();
+        }
+        for (int i = 0; i < 200; ++i)
+        {
+            settings.setValue(QString("Key%1").arg(i), QString("Value %1").arg(i));
+        }
+        settings.sync();
+        int length = 0;
+        for (int i = 0; i < 200; ++i)
+        {
+            length += settings.value(QString("Key%1").arg(i)).toString().size();
+        }
+        loadSink = length;
+
+        QDialog dialog(&window);
+        QTimer::singleShot(30, &dialog, &QDialog::accept);
+        dialog.exec();
+    };
+
+    auto measurePhase = [&](bool isLoaded)
+    {
+        engine.invoke([&meanLateness, &maxLateness]()
+        {
+            meanLateness.clear();
+            maxLateness.clear();
+        });
+        QElapsedTimer phase;
+        phase.start();
+        while (phase.elapsed() < guiLoadPhase)
+        {
+            if (isLoaded)
+            {
+                loadGuiThread();
+            } else
+            {
+                QThread::msleep(10);
+            }
+            QCoreApplication::processEvents();
+        }
+        engine.invoke([]() {});
+
+        double mean = 0.0;
+        double max = 0.0;
+        int windows = 0;
+        for (int i = 1; i < meanLateness.size(); ++i)
+        {
+            mean += meanLateness.at(i);
+            max = qMax(max, maxLateness.at(i));
+            ++windows;
+        }
+
+        QJsonObject json;
+        json["windows"] = windows;
+        json["meanLatenessMs"] = windows > 0 ? mean / windows : 0.0;
+        json["maxLatenessMs"] = max;
+        return json;
+    };
+
+    engine.start(guiLoadInterval, 0, 's', 2000000000, QPoint(100, 100));
+    QJsonObject idle = measurePhase(false);
+    QJsonObject loaded = measurePhase(true);
+    StopToken *stopToken = StopToken::getInstance();
+    stopToken->requestStop();
+    engine.waitFor([stopToken]() { return !stopToken->isRunning(); }, jobTimeout);
+    window.hide();
+
+    double delta = loaded["meanLatenessMs"].toDouble() - idle["meanLatenessMs"].toDouble();
+    if (idle["windows"].toInt() == 0 || loaded["windows"].toInt() == 0)
+    {
+        failures.append("guiLoad: the engine reported no timing during a phase");
+    } else if (delta > maxGuiLoadDelta)
+    {
+        failures.append(QString("guiLoad: GUI load made the clicks %1 ms later on average").arg(delta, 0, 'f', 3));
+    }
+
+    QJsonObject json;
+    json["intervalMs"] = guiLoadInterval;
+    json["idle"] = idle;
+    json["loaded"] = loaded;
+    json["meanLatenessDeltaMs"] = delta;
+    json["maxLatenessDeltaMs"] = loaded["maxLatenessMs"].toDouble() - idle["maxLatenessMs"].toDouble();
+    return json;
+}
+
+/**
+ * @brief Converts the result into a JSON object.
+ */
+
+QJsonObject EngineChecks::Result::toJson() const
+{
+    QJsonObject json;
+    json["checks"] = checks;
+    json["failures"] = QJsonArray::fromStringList(failures);
+    json["passed"] = failures.isEmpty();
+    return json;
+}
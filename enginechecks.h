@@ -0,0 +1,33 @@
+#ifndef ENGINECHECKS_H
+#define ENGINECHECKS_H
+
+#include <QJsonObject>
+#include <QStringList>
+
+class EngineChecks
+{
+public:
+    struct Result {
+        QJsonObject checks;
+        QStringList failures;
+
+        QJsonObject toJson() const;
+    };
+
+    Result run();
+
+private:
+    static constexpr int stopTrials = 20;
+    static constexpr qint64 maxStopOvershoot = 1000000;
+    static constexpr int jobTimeout = 60000;
+    static constexpr int guiLoadInterval = 5;
+    static constexpr qint64 guiLoadPhase = 4000;
+    static constexpr double maxGuiLoadDelta = 1.0;
+
+    QJsonObject checkStopGuarantee(QStringList& failures);
+    QJsonObject checkVirtualSchedule(QStringList& failures);
+    QJsonObject checkRegionWatcher(QStringList& failures);
+    QJsonObject checkGuiLoad(QStringList& failures);
+};
+
+#endif // ENGINECHECKS_H
@@ -0,0 +1,104 @@
+#include "engineclock.h"
+#include <QDeadlineTimer>
+
+/**
+ * @brief Time source of the clicking engine in steady nanoseconds.
+ *
+ * @details The live engine reads the monotonic system clock; the EngineSimulator substitutes a VirtualClock
+ * that only moves when the simulation jumps to the next deadline. A MouseManager driven by a VirtualClock jumps
+ * the same way: every timer it arms fires at once, with the clock moved to the time the timer was meant for.
+ */
+
+/**
+ * @brief Returns the interval a timer is armed with to serve a wake-up time.
+ *
+ * @param wakeTime The time in nanoseconds the timer is meant for.
+ * @param interval The interval in milliseconds computed for this clock.
+ * @return The interval unchanged.
+ */
+
+int EngineClock::timerInterval(qint64 wakeTime, int interval)
+{
+    Q_UNUSED(wakeTime);
+    return interval;
+}
+
+/**
+ * @brief Tells the clock that the timer armed through timerInterval() fired or was stopped.
+ */
+
+void EngineClock::timerReleased()
+{
+}
+
+/**
+ * @brief Returns the monotonic system time in nanoseconds.
+ */
+
+qint64 SteadyClock::now() const
+{
+    return QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs();
+}
+
+/**
+ * @brief Returns the simulated time in nanoseconds.
+ */
+
+qint64 VirtualClock::now() const
+{
+    return current;
+}
+
+/**
+ * @brief Moves the simulated time to the wake-up time, so the timer can fire at once.
+ *
+ * @return 0.
+ *
+ * @details Every call counts as an armed timer until timerReleased() is called for it. The engine owns a single
+ * timer, so more than one armed at a time means a wake-up was silently replaced; getMaxActiveTimers() reports it.
+ */
+
+int VirtualClock::timerInterval(qint64 wakeTime, int interval)
+{
+    Q_UNUSED(interval);
+    advanceTo(wakeTime);
+    ++activeTimers;
+    maxActiveTimers = qMax(maxActiveTimers, activeTimers);
+    return 0;
+}
+
+/**
+ * @brief Counts an armed timer as fired or stopped.
+ */
+
+void VirtualClock::timerReleased()
+{
+    activeTimers = qMax(0, activeTimers - 1);
+}
+
+/**
+ * @brief Moves the simulated time forward; earlier times are ignored so the clock stays monotonic.
+ */
+
+void VirtualClock::advanceTo(qint64 time)
+{
+    current = qMax(current, time);
+}
+
+/**
+ * @brief Returns how many timers are armed and have neither fired nor been stopped.
+ */
+
+int VirtualClock::getActiveTimers() const
+{
+    return activeTimers;
+}
+
+/**
+ * @brief Returns the largest number of timers that were armed at the same time.
+ */
+
+int VirtualClock::getMaxActiveTimers() const
+{
+    return maxActiveTimers;
+}
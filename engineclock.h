@@ -0,0 +1,38 @@
+#ifndef ENGINECLOCK_H
+#define ENGINECLOCK_H
+
+#include <QtGlobal>
+
+class EngineClock
+{
+public:
+    virtual ~EngineClock() = default;
+
+    virtual qint64 now() const = 0;
+    virtual int timerInterval(qint64 wakeTime, int interval);
+    virtual void timerReleased();
+};
+
+class SteadyClock : public EngineClock
+{
+public:
+    qint64 now() const override;
+};
+
+class VirtualClock : public EngineClock
+{
+public:
+    qint64 now() const override;
+    int timerInterval(qint64 wakeTime, int interval) override;
+    void timerReleased() override;
+    void advanceTo(qint64 time);
+    int getActiveTimers() const;
+    int getMaxActiveTimers() const;
+
+private:
+    qint64 current = 0;
+    int activeTimers = 0;
+    int maxActiveTimers = 0;
+};
+
+#endif // ENGINECLOCK_H
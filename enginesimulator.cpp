@@ -0,0 +1,291 @@
+#include "enginesimulator.h"
+#include "actionvm.h"
+#include "engineclock.h"
+#include <QElapsedTimer>
+#include <algorithm>
+#include <limits>
+
+/**
+ * @brief Discrete-event simulator for the clicking engine.
+ *
+ * @details Runs an ActionProgram on the ActionVM against a VirtualClock and a recording ActionSink. Instead of
+ * sleeping, the simulation jumps straight to the earliest pending event: the next VM deadline or a scheduled
+ * hotkey press, which stops a running program or restarts a stopped one exactly like the start/stop hotkey.
+ * Schedules of millions of clicks spanning hours of virtual time complete in milliseconds, and the wall time
+ * spent yields throughput figures for the scheduler logic without any injection cost.
+ */
+
+namespace
+{
+class RecordingSink : public ActionSink
+{
+public:
+    RecordingSink(const VirtualClock& clock, EngineSimulator::Result& result)
+        : clock(clock)
+        ,result(result)
+    {
+    }
+
+    QPoint cursor;
+    int targetHitInterval = 1;
+    QPoint targetPoint;
+    int regionChangeInterval = 1;
+    QRgb pixelColor = 0;
+    int heldButtons = 0;
+
+    QPoint cursorPosition() override
+    {
+        return cursor;
+    }
+
+    void moveTo(const QPoint& point) override
+    {
+        cursor = point;
+        ++result.moves;
+    }
+
+    void click(int, int clicks) override
+    {
+        recordClick(clicks);
+    }
+
+    void clickAt(const QPoint& point, int, int clicks) override
+    {
+        cursor = point;
+        recordClick(clicks);
+    }
+
+    void setButton(int button, bool isDown) override
+    {
+        ++result.buttonTransitions;
+        heldButtons = isDown ? (heldButtons | (1 << button)) : (heldButtons & ~(1 << button));
+    }
+
+    void sendKey(int, bool) override
+    {
+        ++result.keys;
+    }
+
+    void sendKeys(const KeyStroke *, int count) override
+    {
+        result.keys += count;
+    }
+
+    bool locateTarget(QPoint& target) override
+    {
+        ++result.targetSearches;
+        target = targetPoint;
+        return ++targetSearches % qMax(1, targetHitInterval) == 0;
+    }
+
+    bool regionChanged() override
+    {
+        return ++regionPolls % qMax(1, regionChangeInterval) == 0;
+    }
+
+    QRgb pixelAt(const QPoint&) override
+    {
+        return pixelColor;
+    }
+
+    void releaseHeldButtons()
+    {
+        for (int button = Left; button <= Middle; ++button)
+        {
+            if (heldButtons & (1 << button))
+            {
+                setButton(button, false);
+            }
+        }
+    }
+
+private:
+    const VirtualClock& clock;
+    EngineSimulator::Result& result;
+    quint64 targetSearches = 0;
+    quint64 regionPolls = 0;
+    qint64 lastClickTime = -1;
+    qint64 intervalSum = 0;
+    quint64 intervalCount = 0;
+
+    void recordClick(int clicks)
+    {
+        result.clicks += clicks;
+
+        qint64 now = clock.now();
+        if (lastClickTime >= 0)
+        {
+            qint64 interval = now - lastClickTime;
+            result.minClickInterval = intervalCount == 0 ? interval : qMin(result.minClickInterval, interval);
+            result.maxClickInterval = qMax(result.maxClickInterval, interval);
+            intervalSum += interval;
+            ++intervalCount;
+            result.meanClickInterval = static_cast<double>(intervalSum) / intervalCount;
+        }
+        lastClickTime = now;
+    }
+};
+}
+
+/**
+ * @brief Schedules a press of the start/stop hotkey.
+ *
+ * @param time Virtual time of the press in nanoseconds since the start of the simulation.
+ */
+
+void EngineSimulator::scheduleHotkey(qint64 time)
+{
+    hotkeyTimes.append(time);
+}
+
+/**
+ * @brief Sets the simulated cursor position at the start of the run.
+ */
+
+void EngineSimulator::setCursorPosition(const QPoint& position)
+{
+    cursorPosition = position;
+}
+
+/**
+ * @brief Makes every n-th target search succeed at the given point.
+ */
+
+void EngineSimulator::setTargetHitInterval(int searches, const QPoint& target)
+{
+    targetHitInterval = searches;
+    targetPoint = target;
+}
+
+/**
+ * @brief Makes every n-th poll of the watched region report a change.
+ */
+
+void EngineSimulator::setRegionChangeInterval(int polls)
+{
+    regionChangeInterval = polls;
+}
+
+/**
+ * @brief Sets the color returned for every pixel test.
+ */
+
+void EngineSimulator::setPixelColor(QRgb color)
+{
+    pixelColor = color;
+}
+
+/**
+ * @brief Runs the program until the end time, processing deadlines and hotkey presses in time order.
+ *
+ * @param program The program to execute.
+ * @param seed The random seed of the VM, so runs are reproducible.
+ * @param endTime Virtual time in nanoseconds after which the simulation ends.
+ * @return Counters of everything the program injected plus virtual and wall time.
+ */
+
+EngineSimulator::Result EngineSimulator::run(const ActionProgram& program, quint64 seed, qint64 endTime)
+{
+    constexpr qint64 never = std::numeric_limits<qint64>::max();
+
+    Result result;
+    VirtualClock clock;
+    RecordingSink sink(clock, result);
+    sink.cursor = cursorPosition;
+    sink.targetHitInterval = targetHitInterval;
+    sink.targetPoint = targetPoint;
+    sink.regionChangeInterval = regionChangeInterval;
+    sink.pixelColor = pixelColor;
+
+    QVector<qint64> hotkeys = hotkeyTimes;
+    std::sort(hotkeys.begin(), hotkeys.end());
+    int nextHotkey = 0;
+
+    ActionVM vm;
+    vm.load(&program, seed);
+    vm.reset(0);
+    result.starts = 1;
+    bool isRunning = true;
+    qint64 deadline = 0;
+
+    QElapsedTimer wallClock;
+    wallClock.start();
+
+    while (true)
+    {
+        qint64 hotkeyTime = nextHotkey < hotkeys.size() ? hotkeys.at(nextHotkey) : never;
+        qint64 vmTime = isRunning ? deadline : never;
+        qint64 eventTime = qMin(hotkeyTime, vmTime);
+        if (eventTime == never || eventTime > endTime)
+        {
+            break;
+        }
+
+        clock.advanceTo(eventTime);
+
+        if (hotkeyTime <= vmTime)
+        {
+            ++nextHotkey;
+            if (isRunning)
+            {
+                isRunning = false;
+                ++result.stops;
+                sink.releaseHeldButtons();
+            } else
+            {
+                vm.reset(eventTime);
+                isRunning = true;
+                deadline = eventTime;
+                result.halted = false;
+                ++result.starts;
+            }
+            continue;
+        }
+
+        quint64 executedBefore = vm.getExecutedCount();
+        deadline = vm.run(eventTime, sink);
+        result.instructions += vm.getExecutedCount() - executedBefore;
+        ++result.wakeUps;
+
+        if (deadline < 0)
+        {
+            isRunning = false;
+            result.halted = true;
+        }
+    }
+
+    result.virtualTime = clock.now();
+    result.wallTime = wallClock.nsecsElapsed();
+    return result;
+}
+
+/**
+ * @brief Converts the result into a JSON object, including throughput figures of the scheduler logic.
+ */
+
+QJsonObject EngineSimulator::Result::toJson() const
+{
+    double wallSeconds = qMax<qint64>(1, wallTime) / 1e9;
+
+    QJsonObject json;
+    json["clicks"] = static_cast<double>(clicks);
+    json["moves"] = static_cast<double>(moves);
+    json["buttonTransitions"] = static_cast<double>(buttonTransitions);
+    json["keys"] = static_cast<double>(keys);
+    json["targetSearches"] = static_cast<double>(targetSearches);
+    json["instructions"] = static_cast<double>(instructions);
+    json["wakeUps"] = static_cast<double>(wakeUps);
+    json["starts"] = starts;
+    json["stops"] = stops;
+    json["halted"] = halted;
+    json["virtualTimeMs"] = virtualTime / 1e6;
+    json["wallTimeMs"] = wallTime / 1e6;
+    json["minClickIntervalMs"] = minClickInterval / 1e6;
+    json["maxClickIntervalMs"] = maxClickInterval / 1e6;
+    json["meanClickIntervalMs"] = meanClickInterval / 1e6;
+    json["instructionsPerSecond"] = instructions / wallSeconds;
+    json["clicksPerSecond"] = clicks / wallSeconds;
+    json["wakeUpsPerSecond"] = wakeUps / wallSeconds;
+    json["speedup"] = virtualTime / 1e9 / wallSeconds;
+    return json;
+}
@@ -0,0 +1,50 @@
+#ifndef ENGINESIMULATOR_H
+#define ENGINESIMULATOR_H
+
+#include "actionprogram.h"
+#include <QJsonObject>
+#include <QPoint>
+#include <QRgb>
+#include <QVector>
+
+class EngineSimulator
+{
+public:
+    struct Result {
+        quint64 clicks = 0;
+        quint64 moves = 0;
+        quint64 buttonTransitions = 0;
+        quint64 keys = 0;
+        quint64 targetSearches = 0;
+        quint64 instructions = 0;
+        quint64 wakeUps = 0;
+        int stops = 0;
+        int starts = 0;
+        bool halted = false;
+        qint64 virtualTime = 0;
+        qint64 wallTime = 0;
+        qint64 minClickInterval = 0;
+        qint64 maxClickInterval = 0;
+        double meanClickInterval = 0.0;
+
+        QJsonObject toJson() const;
+    };
+
+    void scheduleHotkey(qint64 time);
+    void setCursorPosition(const QPoint& position);
+    void setTargetHitInterval(int searches, const QPoint& target);
+    void setRegionChangeInterval(int polls);
+    void setPixelColor(QRgb color);
+
+    Result run(const ActionProgram& program, quint64 seed, qint64 endTime);
+
+private:
+    QVector<qint64> hotkeyTimes;
+    QPoint cursorPosition;
+    int targetHitInterval = 1;
+    QPoint targetPoint;
+    int regionChangeInterval = 1;
+    QRgb pixelColor = 0;
+};
+
+#endif // ENGINESIMULATOR_H
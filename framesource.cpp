@@ -0,0 +1,195 @@
+#include "framesource.h"
+#include <cstring>
+
+/**
+ * @brief Frame sources fill the capture buffers owned by ScreenCapture.
+ *
+ * @details GdiFrameSource backs every buffer with a DIB section, so BitBlt writes the screen pixels straight
+ * into memory that consumers read without further copies (the Windows counterpart of an XShm segment).
+ * SyntheticFrameSource replays prepared images or image files and is meant for tests and offline measurements.
+ */
+
+GdiFrameSource::GdiFrameSource()
+    : screenContext(nullptr)
+{
+}
+
+GdiFrameSource::~GdiFrameSource()
+{
+    if (screenContext != nullptr)
+    {
+        ReleaseDC(nullptr, screenContext);
+        screenContext = nullptr;
+    }
+}
+
+/**
+ * @brief Creates a top-down 32-bit DIB section and a memory DC that stays selected to it.
+ *
+ * @param buffer The buffer that receives the DIB section memory.
+ * @param size The largest region the buffer has to hold.
+ * @return True if the native objects were created; otherwise, false.
+ */
+
+bool GdiFrameSource::allocate(CaptureBuffer& buffer, const QSize& size)
+{
+    if (screenContext == nullptr)
+    {
+        screenContext = GetDC(nullptr);
+    }
+
+    BITMAPINFO info = {};
+    info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    info.bmiHeader.biWidth = size.width();
+    info.bmiHeader.biHeight = -size.height();
+    info.bmiHeader.biPlanes = 1;
+    info.bmiHeader.biBitCount = 32;
+    info.bmiHeader.biCompression = BI_RGB;
+
+    void *bits = nullptr;
+    HBITMAP bitmap = CreateDIBSection(screenContext, &info, DIB_RGB_COLORS, &bits, nullptr, 0);
+    if (bitmap == nullptr)
+    {
+        return false;
+    }
+
+    HDC memoryContext = CreateCompatibleDC(screenContext);
+    SelectObject(memoryContext, bitmap);
+
+    buffer.bits = static_cast<uchar*>(bits);
+    buffer.stride = size.width() * 4;
+    buffer.capacity = size;
+    buffer.nativeBitmap = bitmap;
+    buffer.nativeContext = memoryContext;
+    return true;
+}
+
+/**
+ * @brief Destroys the memory DC and the DIB section of a buffer.
+ */
+
+void GdiFrameSource::release(CaptureBuffer& buffer)
+{
+    if (buffer.nativeContext != nullptr)
+    {
+        DeleteDC(static_cast<HDC>(buffer.nativeContext));
+    }
+    if (buffer.nativeBitmap != nullptr)
+    {
+        DeleteObject(static_cast<HBITMAP>(buffer.nativeBitmap));
+    }
+    buffer = CaptureBuffer();
+}
+
+/**
+ * @brief Copies the given virtual desktop region into the buffer's DIB section.
+ *
+ * @param buffer The destination buffer.
+ * @param region The region in virtual desktop pixels; must fit into the buffer capacity.
+ * @return True on success; otherwise, false.
+ */
+
+bool GdiFrameSource::grab(CaptureBuffer& buffer, const QRect& region)
+{
+    if (buffer.nativeContext == nullptr || region.width() > buffer.capacity.width() || region.height() > buffer.capacity.height())
+    {
+        return false;
+    }
+
+    HDC memoryContext = static_cast<HDC>(buffer.nativeContext);
+    if (!BitBlt(memoryContext, 0, 0, region.width(), region.height(), screenContext, region.x(), region.y(), SRCCOPY))
+    {
+        return false;
+    }
+    GdiFlush();
+
+    buffer.region = region;
+    return true;
+}
+
+/**
+ * @brief Creates a source that cycles through the given frames.
+ */
+
+SyntheticFrameSource::SyntheticFrameSource(const QVector<QImage>& frames)
+    : frames(frames)
+    ,nextFrame(0)
+{
+}
+
+/**
+ * @brief Creates a source that cycles through recorded frames loaded from image files.
+ */
+
+SyntheticFrameSource::SyntheticFrameSource(const QStringList& imagePaths)
+    : nextFrame(0)
+{
+    for (const QString& path : imagePaths)
+    {
+        QImage frame(path);
+        if (!frame.isNull())
+        {
+            frames.append(frame.convertToFormat(QImage::Format_RGB32));
+        }
+    }
+}
+
+/**
+ * @brief Allocates plain heap memory for a buffer.
+ */
+
+bool SyntheticFrameSource::allocate(CaptureBuffer& buffer, const QSize& size)
+{
+    buffer.stride = size.width() * 4;
+    buffer.bits = new uchar[static_cast<size_t>(buffer.stride) * size.height()];
+    buffer.capacity = size;
+    return true;
+}
+
+/**
+ * @brief Frees the memory of a buffer.
+ */
+
+void SyntheticFrameSource::release(CaptureBuffer& buffer)
+{
+    delete[] buffer.bits;
+    buffer = CaptureBuffer();
+}
+
+/**
+ * @brief Copies the region of the next prepared frame into the buffer; pixels outside the frame are black.
+ */
+
+bool SyntheticFrameSource::grab(CaptureBuffer& buffer, const QRect& region)
+{
+    if (frames.isEmpty() || region.width() > buffer.capacity.width() || region.height() > buffer.capacity.height())
+    {
+        return false;
+    }
+
+    const QImage& frame = frames.at(nextFrame);
+    nextFrame = (nextFrame + 1) % frames.size();
+
+    QImage source = frame.format() == QImage::Format_RGB32 ? frame : frame.convertToFormat(QImage::Format_RGB32);
+    for (int y = 0; y < region.height(); ++y)
+    {
+        uchar *row = buffer.bits + y * buffer.stride;
+        std::memset(row, 0, region.width() * 4);
+
+        int sourceY = region.y() + y;
+        if (sourceY < 0 || sourceY >= source.height())
+        {
+            continue;
+        }
+
+        int firstX = qMax(0, region.x());
+        int lastX = qMin(source.width(), region.x() + region.width());
+        if (firstX < lastX)
+        {
+            std::memcpy(row + (firstX - region.x()) * 4, source.constScanLine(sourceY) + firstX * 4, (lastX - firstX) * 4);
+        }
+    }
+
+    buffer.region = region;
+    return true;
+}
@@ -0,0 +1,62 @@
+#ifndef FRAMESOURCE_H
+#define FRAMESOURCE_H
+
+#include <QImage>
+#include <QRect>
+#include <QStringList>
+#include <QVector>
+#include <Windows.h>
+
+struct CaptureBuffer {
+    uchar *bits = nullptr;
+    int stride = 0;
+    QSize capacity;
+    QRect region;
+    quint64 sequence = 0;
+    qint64 timestamp = 0;
+    int references = 0;
+    bool isWriting = false;
+    void *nativeBitmap = nullptr;
+    void *nativeContext = nullptr;
+};
+
+class FrameSource
+{
+public:
+    virtual ~FrameSource() = default;
+
+    virtual bool allocate(CaptureBuffer& buffer, const QSize& size) = 0;
+    virtual void release(CaptureBuffer& buffer) = 0;
+    virtual bool grab(CaptureBuffer& buffer, const QRect& region) = 0;
+};
+
+class GdiFrameSource : public FrameSource
+{
+public:
+    GdiFrameSource();
+    ~GdiFrameSource();
+
+    bool allocate(CaptureBuffer& buffer, const QSize& size) override;
+    void release(CaptureBuffer& buffer) override;
+    bool grab(CaptureBuffer& buffer, const QRect& region) override;
+
+private:
+    HDC screenContext;
+};
+
+class SyntheticFrameSource : public FrameSource
+{
+public:
+    explicit SyntheticFrameSource(const QVector<QImage>& frames);
+    explicit SyntheticFrameSource(const QStringList& imagePaths);
+
+    bool allocate(CaptureBuffer& buffer, const QSize& size) override;
+    void release(CaptureBuffer& buffer) override;
+    bool grab(CaptureBuffer& buffer, const QRect& region) override;
+
+private:
+    QVector<QImage> frames;
+    int nextFrame;
+};
+
+#endif // FRAMESOURCE_H
@@ -1,16 +1,18 @@
 #include "GlobalMouseHook.h"
 
 /**
- * @brief The GlobalMouseHook class manages mouse events globally through a Windows hook.
+ * @brief The GlobalMouseHook class provides global mouse events as Qt signals while it is started.
  *
- * This class sets up a low-level mouse hook (WH_MOUSE_LL) to capture and handle mouse events,
- * including movements, left and right button clicks.
+ * This class registers as mouse consumer of the InputListener, which captures mouse events system-wide
+ * (including movements, left and right button clicks) on its own thread.
  *
- * @details It utilizes SetWindowsHookEx to establish the hook and emits signals for specific
- * mouse events, allowing external handling.
+ * @details The consumer is only registered between start() and stop(), and the listener only installs its
+ * low-level mouse hook while a consumer needs mouse events, so outside of coordinate picking no mouse event of
+ * the system passes through this application. Button signals are emitted on the listener thread, so connected
+ * slots of other threads run queued. Movements only update an atomic position; with the preview enabled, a timer
+ * on the thread of this object publishes it through mouseMoved at most every previewInterval milliseconds.
  */
 
-HHOOK GlobalMouseHook::mouseHook = nullptr;
 GlobalMouseHook* GlobalMouseHook::instance = nullptr;
 
 GlobalMouseHook* GlobalMouseHook::getInstance()
@@ -24,52 +26,113 @@ GlobalMouseHook* GlobalMouseHook::getInstance()
 
 GlobalMouseHook::GlobalMouseHook(QObject *parent) : QObject(parent)
 {
-    mouseHook = SetWindowsHookEx(WH_MOUSE_LL, mouseProc, GetModuleHandle(NULL), 0);
+    previewTimer.setInterval(previewInterval);
+    connect(&previewTimer, &QTimer::timeout, this, &GlobalMouseHook::publishPreview);
 }
 
 GlobalMouseHook::~GlobalMouseHook()
 {
-    if (mouseHook != nullptr)
+    stop();
+    if (instance == this)
     {
-        UnhookWindowsHookEx(mouseHook);
-        mouseHook = nullptr;
+        instance = nullptr;
     }
 }
 
 /**
- * @brief Callback function for processing low-level mouse events.
+ * @brief Starts receiving global mouse events; call on the thread of this object.
  *
- * @param nCode A hook code. If less than zero, the function must return the result of
- * calling the next hook procedure in the hook chain.
- * @param wParam The identifier of the mouse message.
- * @param lParam A pointer to an MSLLHOOKSTRUCT structure that contains details of the event.
+ * @param isPreview Whether the cursor position is published through mouseMoved while the hook runs.
+ */
+
+void GlobalMouseHook::start(bool isPreview)
+{
+    if (!isStarted)
+    {
+        isStarted = true;
+        position.store(noPosition, std::memory_order_relaxed);
+        previewedPosition = noPosition;
+        InputListener::getInstance()->addConsumer(this, InputListener::MouseEvents);
+    }
+
+    if (isPreview)
+    {
+        previewTimer.start();
+    } else
+    {
+        previewTimer.stop();
+    }
+}
+
+/**
+ * @brief Stops receiving global mouse events; the listener removes its mouse hook if nothing else needs it.
+ */
+
+void GlobalMouseHook::stop()
+{
+    previewTimer.stop();
+    if (isStarted)
+    {
+        isStarted = false;
+        InputListener::getInstance()->removeConsumer(this);
+    }
+}
+
+/**
+ * @brief Checks whether global mouse events are being received.
+ */
+
+bool GlobalMouseHook::isActive() const
+{
+    return isStarted;
+}
+
+/**
+ * @brief Processes a global mouse event.
  *
- * @details This function is called when a low-level mouse event occurs. It interprets
- * and handles different mouse events such as mouse movements, left button clicks, and right button clicks.
- * Upon receiving a particular mouse event, it emits corresponding signals to notify the connected slots.
+ * @param event The mouse event.
  *
- * @return The result of calling the next hook procedure in the hook chain.
+ * @details This function is called when a mouse event occurs. Movements only store the position; button
+ * presses emit the corresponding signals to notify the connected slots.
  */
 
-LRESULT CALLBACK GlobalMouseHook::mouseProc(int nCode, WPARAM wParam, LPARAM lParam)
+void GlobalMouseHook::inputEvent(const InputEvent& event)
 {
-    if (nCode >= 0)
+    switch (event.type)
     {
-        MSLLHOOKSTRUCT *pMouseStruct = reinterpret_cast<MSLLHOOKSTRUCT*>(lParam);
-        switch (wParam)
+    case InputEvent::MouseMove:
+        position.store((static_cast<quint64>(static_cast<quint32>(event.position.x())) << 32) | static_cast<quint32>(event.position.y()),
+                       std::memory_order_relaxed);
+        break;
+    case InputEvent::ButtonDown:
+        if (event.code == 0)
+        {
+            emit leftButtonClicked();
+        } else if (event.code == 1)
+        {
+            emit rightButtonClicked();
+        } else
         {
-        case WM_MOUSEMOVE:
-            emit getInstance()->mouseMoved(pMouseStruct->pt.x, pMouseStruct->pt.y);
-            break;
-        case WM_LBUTTONDOWN:
-            getInstance()-> emit leftButtonClicked();
-            break;
-        case WM_RBUTTONDOWN:
-            emit getInstance()->rightButtonClicked();
-            break;
-        default:
-            break;
+            emit middleButtonClicked();
         }
+        break;
+    default:
+        break;
     }
-    return CallNextHookEx(mouseHook, nCode, wParam, lParam);
+}
+
+/**
+ * @brief Publishes the latest cursor position if it changed since the last preview.
+ */
+
+void GlobalMouseHook::publishPreview()
+{
+    quint64 current = position.load(std::memory_order_relaxed);
+    if (current == previewedPosition)
+    {
+        return;
+    }
+
+    previewedPosition = current;
+    emit mouseMoved(static_cast<qint32>(current >> 32), static_cast<qint32>(current & 0xFFFFFFFF));
 }
@@ -1,17 +1,25 @@
 #ifndef GLOBALMOUSEHOOK_H
 #define GLOBALMOUSEHOOK_H
 
+#include "inputlistener.h"
 #include <QObject>
 #include <QThread>
-#include <Windows.h>
+#include <QTimer>
+#include <atomic>
 
-class GlobalMouseHook : public QObject {
+class GlobalMouseHook : public QObject, public InputConsumer {
     Q_OBJECT
 
 public:
+    static constexpr int previewInterval = 50;
+
     explicit GlobalMouseHook(QObject *parent = nullptr);
     ~GlobalMouseHook();
     static GlobalMouseHook* getInstance();
+    void start(bool isPreview);
+    void stop();
+    bool isActive() const;
+    void inputEvent(const InputEvent& event) override;
 
 signals:
     void mouseMoved(int x, int y);
@@ -20,10 +28,14 @@ signals:
     void middleButtonClicked();
 
 private:
-    static HHOOK mouseHook;
+    static constexpr quint64 noPosition = ~quint64(0);
     static GlobalMouseHook* instance;
-    static LRESULT CALLBACK mouseProc(int nCode, WPARAM wParam, LPARAM lParam);
-    static GlobalMouseHook* mouseHookInstance;
+    QTimer previewTimer;
+    std::atomic<quint64> position{noPosition};
+    quint64 previewedPosition = noPosition;
+    bool isStarted = false;
+
+    void publishPreview();
 };
 
 #endif // GLOBALMOUSEHOOK_H
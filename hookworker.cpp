@@ -1,45 +1,36 @@
 #include "hookworker.h"
+#include "stoptoken.h"
 #include "qdebug.h"
 
 /**
- * @brief The HookWorker class manages a Windows low-level keyboard hook to monitor and respond to keyboard events globally.
+ * @brief The HookWorker class monitors global keyboard events and responds to the start/stop hotkey.
  *
- * This class sets up and controls a low-level keyboard hook (WH_KEYBOARD_LL) for capturing keyboard events like key presses and releases.
+ * This class consumes the keyboard events of the InputListener, which captures them system-wide on its own thread.
  * It enables the detection and handling of specific key sequences in the system.
  *
- * @details The HookWorker class initializes and manages a single instance of a global keyboard hook.
+ * @details The HookWorker class registers a single instance as keyboard consumer of the InputListener.
  * It listens to keyboard events (key down and key up) and triggers specific actions based on a defined virtual key code (VKCode).
- * The class also provides functionalities to stop and resume the keyboard hook.
+ * The class also provides functionalities to stop and resume the hotkey detection.
  */
 
 HookWorker* HookWorker::instance = nullptr;
 
-HookWorker::HookWorker(QObject *parent) : QObject(parent),
-    globalKeyboardHook(nullptr),
-    isRunning(true),
-    vkCode(117),
-    isHookBlocked(false)
+HookWorker::HookWorker(QObject *parent) : QObject(parent)
 {
     if(!instance)
     {
         instance = this;
-
-        if (!globalKeyboardHook)
-        {
-            globalKeyboardHook = SetWindowsHookEx(WH_KEYBOARD_LL, KeyboardProc, NULL, 0);
-        }
+        InputListener::getInstance()->addConsumer(this, InputListener::KeyboardEvents);
     }
 }
 
 HookWorker::~HookWorker()
 {
-    if (globalKeyboardHook != NULL)
+    if (instance == this)
     {
-        UnhookWindowsHookEx(globalKeyboardHook);
-        globalKeyboardHook = NULL;
+        InputListener::getInstance()->removeConsumer(this);
+        instance = nullptr;
     }
-
-    instance = nullptr;
 }
 
 /**
@@ -49,7 +40,7 @@ HookWorker::~HookWorker()
 
 void HookWorker::stopHook(bool running)
 {
-    isRunning = running;
+    hotkeyFilter.setEnabled(running);
 }
 
 /**
@@ -68,7 +59,7 @@ void HookWorker::processHooks()
 
 void HookWorker::setVkCode(int newVKCode)
 {
-    vkCode = newVKCode;
+    hotkeyFilter.setVkCode(newVKCode);
 }
 
 /**
@@ -78,7 +69,7 @@ void HookWorker::setVkCode(int newVKCode)
 
 int HookWorker::getCurrentVKCode()
 {
-    return vkCode;
+    return hotkeyFilter.getVkCode();
 }
 
 /**
@@ -88,61 +79,26 @@ int HookWorker::getCurrentVKCode()
 
 void HookWorker::blockHook(bool block)
 {
-    isHookBlocked = block;
+    hotkeyFilter.setBlocked(block);
 }
 
 /**
- * @brief Handles low-level keyboard events through a Windows hook, monitoring specific key sequences
- * and controlling hook blocking until the required key sequence is released.
+ * @brief Handles global keyboard events, monitoring specific key sequences
+ * and blocking the hotkey until the required key sequence is released.
  *
- * @details This function captures keyboard events, allowing identification of when a user presses down and releases a specific key.
- * It blocks the hook until the required key sequence is released during WM_KEYUP,
+ * @details Called on the InputListener thread for every key press and release in the system. A running job is
+ * stopped right here through the StopToken; the queued signal only updates the application state afterwards.
+ * The hotkey is blocked after a press until the key is released,
  * ensuring accurate detection of key presses and releases.
  *
- * @param nCode The hook code indicating the action that should be taken.
- * @param wParam The type of keyboard message (e.g., WM_KEYDOWN, WM_KEYUP).
- * @param lParam A pointer to a KBDLLHOOKSTRUCT structure containing details about the keyboard event.
- * @return Returns the result of the next hook in the chain.
+ * @param event The keyboard event.
  */
 
-LRESULT CALLBACK HookWorker::KeyboardProc(int nCode, WPARAM wParam, LPARAM lParam)
+void HookWorker::inputEvent(const InputEvent& event)
 {
-    HookWorker* instance = getInstance();
-
-    if (instance == nullptr) {
-        return CallNextHookEx(nullptr, nCode, wParam, lParam);
-    }
-
-    if(instance->isRunning)
+    if (hotkeyFilter.process(event.type == InputEvent::KeyDown, event.code))
     {
-        if (nCode >= 0 && (wParam == WM_KEYDOWN || wParam == WM_KEYUP))
-        {
-            int vkCode = instance->getCurrentVKCode();
-
-            if (wParam == WM_KEYDOWN && !instance->isHookBlocked)
-            {
-                KBDLLHOOKSTRUCT* pKeyBoard = reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
-                int pressedKey = pKeyBoard->vkCode;
-
-                if (pressedKey == vkCode)
-                {
-                    instance->blockHook(true);
-                    emit instance->processHooks();
-                }
-            } else if (wParam == WM_KEYUP)
-            {
-                KBDLLHOOKSTRUCT* pKeyBoard = reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
-                int releasedKey = pKeyBoard->vkCode;
-
-                if (releasedKey == vkCode)
-                {
-                    instance->blockHook(false);
-                } else
-                {
-                    return CallNextHookEx(nullptr, nCode, wParam, lParam);
-                }
-            }
-        }
+        StopToken::getInstance()->requestStop();
+        processHooks();
     }
-    return CallNextHookEx(nullptr, nCode, wParam, lParam);
 }
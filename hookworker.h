@@ -1,11 +1,12 @@
 #ifndef HOOKWORKER_H
 #define HOOKWORKER_H
 
+#include "hotkeyfilter.h"
+#include "inputlistener.h"
 #include <QObject>
-#include <windows.h>
 #include <QMap>
 
-class HookWorker : public QObject
+class HookWorker : public QObject, public InputConsumer
 {
     Q_OBJECT
 public:
@@ -17,19 +18,15 @@ public:
     int getCurrentVKCode();
     void setVkCode(int newVKCode);
     void stopHook(bool run);
+    void inputEvent(const InputEvent& event) override;
 
     static HookWorker* getInstance() {
         return instance;
     }
 
 private:
-    HHOOK globalKeyboardHook;
     static HookWorker* instance;
-    static LRESULT CALLBACK KeyboardProc(int nCode, WPARAM wParam, LPARAM lParam);
-    bool isRunning;
-
-    int vkCode = 117;
-    bool isHookBlocked;
+    HotkeyFilter hotkeyFilter;
 
 signals:
     void keyboardEventTriggered();
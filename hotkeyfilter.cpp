@@ -0,0 +1,71 @@
+#include "hotkeyfilter.h"
+
+/**
+ * @brief Decides which keyboard events trigger the start/stop hotkey.
+ *
+ * @details A press of the hotkey fires once and blocks further presses until the key is released, so holding
+ * the key (auto-repeat) does not toggle the application repeatedly. Kept free of platform code so the decision
+ * made for every system-wide key event can be benchmarked on its own. The settings are changed from the GUI and
+ * hook manager threads while process() runs on the input listener thread, so every field is atomic; the fields
+ * are independent of each other, so relaxed ordering is enough.
+ */
+
+/**
+ * @brief Sets the Virtual Key (VK) code of the hotkey.
+ */
+
+void HotkeyFilter::setVkCode(int newVKCode)
+{
+    vkCode.store(newVKCode, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Returns the Virtual Key (VK) code of the hotkey.
+ */
+
+int HotkeyFilter::getVkCode() const
+{
+    return vkCode.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Enables or disables the hotkey, e.g. while the hotkey dialog is open.
+ */
+
+void HotkeyFilter::setEnabled(bool enabled)
+{
+    isEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Blocks or unblocks hotkey presses until the next release.
+ */
+
+void HotkeyFilter::setBlocked(bool blocked)
+{
+    isBlocked.store(blocked, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Processes one key event.
+ *
+ * @param isKeyDown Whether the key was pressed or released.
+ * @param virtualKey The Virtual Key (VK) code of the event.
+ * @return True if the event triggers the hotkey; otherwise, false.
+ */
+
+bool HotkeyFilter::process(bool isKeyDown, int virtualKey)
+{
+    if (!isEnabled.load(std::memory_order_relaxed) || virtualKey != vkCode.load(std::memory_order_relaxed))
+    {
+        return false;
+    }
+
+    if (isKeyDown)
+    {
+        return !isBlocked.exchange(true, std::memory_order_relaxed);
+    }
+
+    isBlocked.store(false, std::memory_order_relaxed);
+    return false;
+}
@@ -0,0 +1,22 @@
+#ifndef HOTKEYFILTER_H
+#define HOTKEYFILTER_H
+
+#include <atomic>
+
+class HotkeyFilter
+{
+public:
+    void setVkCode(int newVKCode);
+    int getVkCode() const;
+    void setEnabled(bool enabled);
+    void setBlocked(bool blocked);
+
+    bool process(bool isKeyDown, int virtualKey);
+
+private:
+    std::atomic<int> vkCode{117};
+    std::atomic<bool> isEnabled{true};
+    std::atomic<bool> isBlocked{false};
+};
+
+#endif // HOTKEYFILTER_H
@@ -0,0 +1,126 @@
+#include "injectionlatency.h"
+#include "tracer.h"
+
+/**
+ * @brief Measures how long injected input takes until the system delivers it.
+ *
+ * @details Every injection carries a tag (the high 16 bits) and a sequence number (the low 16 bits) in its extra
+ * info, and its send time is kept in a small slot table indexed by the sequence. The input backends recognize the
+ * tag on delivered events and mark them as injected; the InputListener hands those events only to this consumer,
+ * never to the user input consumers. The delay between sending and delivery is smoothed with an exponentially
+ * weighted moving average (weight 1/8) that the scheduler uses to fire early. Send times are written by the engine
+ * thread and consumed by the listener thread through atomics, so neither side ever waits for the other.
+ */
+
+InjectionLatency* InjectionLatency::getInstance()
+{
+    static InjectionLatency instance;
+    return &instance;
+}
+
+/**
+ * @brief Checks whether extra info of a delivered event carries the injection tag.
+ *
+ * @param extraInfo The extra info attached to the event by its sender.
+ * @param sequence Receives the sequence number of the injection.
+ * @return True if the event was injected by this application; otherwise, false.
+ */
+
+bool InjectionLatency::isTagged(quintptr extraInfo, quint16& sequence)
+{
+    if ((extraInfo & tagMask) != tag)
+    {
+        return false;
+    }
+    sequence = static_cast<quint16>(extraInfo & 0xFFFF);
+    return true;
+}
+
+/**
+ * @brief Records the send time of an injection and returns the tag to attach to its events.
+ *
+ * @param sendTime Steady clock time right before the input is sent, in nanoseconds.
+ */
+
+quint32 InjectionLatency::tagInjection(qint64 sendTime)
+{
+    quint32 sequence = nextSequence.fetch_add(1, std::memory_order_relaxed) & 0xFFFF;
+    sendTimes[sequence % slotCount].store(sendTime, std::memory_order_release);
+    return tag | sequence;
+}
+
+/**
+ * @brief Starts or stops receiving delivered injections; while measuring, the listener captures mouse events.
+ */
+
+void InjectionLatency::setMeasuring(bool enabled)
+{
+    if (enabled == isMeasuring)
+    {
+        return;
+    }
+
+    isMeasuring = enabled;
+    if (enabled)
+    {
+        InputListener::getInstance()->addConsumer(this, InputListener::InjectedEvents);
+    } else
+    {
+        InputListener::getInstance()->removeConsumer(this);
+    }
+}
+
+/**
+ * @brief Returns the smoothed delivery latency in nanoseconds, or 0 before the first sample.
+ */
+
+qint64 InjectionLatency::getEstimate() const
+{
+    return estimate.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Returns how much earlier the scheduler should inject: the estimate, limited to maxLead.
+ */
+
+qint64 InjectionLatency::getLead() const
+{
+    return qMin(getEstimate(), maxLead);
+}
+
+/**
+ * @brief Returns the number of measured deliveries.
+ */
+
+quint64 InjectionLatency::getSampleCount() const
+{
+    return sampleCount.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Updates the estimate with a delivered injection.
+ *
+ * @details Only the first delivered event of an injection is measured; its slot is cleared, so the remaining
+ * events of the same SendInput batch and stale sequence numbers are ignored. Samples above maxLatency (a stalled
+ * listener thread) are discarded.
+ */
+
+void InjectionLatency::inputEvent(const InputEvent& event)
+{
+    qint64 sendTime = sendTimes[event.injectionSequence % slotCount].exchange(0, std::memory_order_acq_rel);
+    if (sendTime == 0)
+    {
+        return;
+    }
+
+    qint64 sample = event.timestamp - sendTime;
+    Tracer::record(Tracer::InjectedEvent, event.injectionSequence, sample);
+    if (sample < 0 || sample > maxLatency)
+    {
+        return;
+    }
+
+    qint64 current = estimate.load(std::memory_order_relaxed);
+    estimate.store(sampleCount.load(std::memory_order_relaxed) == 0 ? sample : current + (sample - current) / 8, std::memory_order_relaxed);
+    sampleCount.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,37 @@
+#ifndef INJECTIONLATENCY_H
+#define INJECTIONLATENCY_H
+
+#include "inputlistener.h"
+#include <QtGlobal>
+#include <atomic>
+
+class InjectionLatency : public InputConsumer
+{
+public:
+    static constexpr quint32 tag = 0x4D430000;
+    static constexpr quint32 tagMask = 0xFFFF0000;
+    static constexpr qint64 maxLatency = 50000000;
+    static constexpr qint64 maxLead = 5000000;
+
+    static InjectionLatency* getInstance();
+    static bool isTagged(quintptr extraInfo, quint16& sequence);
+
+    quint32 tagInjection(qint64 sendTime);
+    void setMeasuring(bool enabled);
+    qint64 getEstimate() const;
+    qint64 getLead() const;
+    quint64 getSampleCount() const;
+
+    void inputEvent(const InputEvent& event) override;
+
+private:
+    static constexpr int slotCount = 256;
+
+    std::atomic<qint64> sendTimes[slotCount] = {};
+    std::atomic<quint32> nextSequence{0};
+    std::atomic<qint64> estimate{0};
+    std::atomic<quint64> sampleCount{0};
+    bool isMeasuring = false;
+};
+
+#endif // INJECTIONLATENCY_H
@@ -0,0 +1,276 @@
+#include "inputbackend.h"
+#include "injectionlatency.h"
+#include <QDeadlineTimer>
+#include <QFile>
+#include <QTextStream>
+
+/**
+ * @brief Event sources of the InputListener.
+ *
+ * @details All backends are started, stopped and reconfigured on the listener thread, and they produce events on
+ * that thread only, so each backend is the single producer of the listener's ring:
+ * - Win32InputBackend installs the low-level keyboard hook when started and the low-level mouse hook only while
+ *   mouse events are captured; the listener thread's event loop pumps their messages. Events whose extra info
+ *   carries the InjectionLatency tag are marked as injected by this application.
+ * - ReplayInputBackend plays a recorded text file back with its original timing, for reproducible tests.
+ */
+
+namespace
+{
+qint64 currentTime()
+{
+    return QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs();
+}
+}
+
+#if defined(Q_OS_WIN)
+
+Win32InputBackend* Win32InputBackend::active = nullptr;
+
+/**
+ * @brief Installs the low-level keyboard hook on the calling (listener) thread.
+ */
+
+bool Win32InputBackend::start(InputListener *listener)
+{
+    this->listener = listener;
+    active = this;
+    keyboardHook = SetWindowsHookEx(WH_KEYBOARD_LL, keyboardProc, GetModuleHandle(NULL), 0);
+    return keyboardHook != nullptr;
+}
+
+/**
+ * @brief Removes all hooks.
+ */
+
+void Win32InputBackend::stop()
+{
+    setMouseCapture(false);
+    if (keyboardHook != nullptr)
+    {
+        UnhookWindowsHookEx(keyboardHook);
+        keyboardHook = nullptr;
+    }
+    active = nullptr;
+}
+
+/**
+ * @brief Installs or removes the low-level mouse hook, which otherwise adds latency to every mouse event in the system.
+ */
+
+void Win32InputBackend::setMouseCapture(bool enabled)
+{
+    if (enabled && mouseHook == nullptr)
+    {
+        mouseHook = SetWindowsHookEx(WH_MOUSE_LL, mouseProc, GetModuleHandle(NULL), 0);
+    } else if (!enabled && mouseHook != nullptr)
+    {
+        UnhookWindowsHookEx(mouseHook);
+        mouseHook = nullptr;
+    }
+}
+
+QString Win32InputBackend::getName() const
+{
+    return "win32";
+}
+
+/**
+ * @brief Low-level keyboard hook: queues key presses and releases and passes the event on.
+ */
+
+LRESULT CALLBACK Win32InputBackend::keyboardProc(int nCode, WPARAM wParam, LPARAM lParam)
+{
+    if (nCode >= 0 && active != nullptr && (wParam == WM_KEYDOWN || wParam == WM_KEYUP))
+    {
+        KBDLLHOOKSTRUCT* pKeyBoard = reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
+
+        InputEvent event;
+        event.type = wParam == WM_KEYDOWN ? InputEvent::KeyDown : InputEvent::KeyUp;
+        event.code = static_cast<int>(pKeyBoard->vkCode);
+        event.timestamp = currentTime();
+        event.isInjected = InjectionLatency::isTagged(pKeyBoard->dwExtraInfo, event.injectionSequence);
+        active->listener->post(event);
+    }
+    return CallNextHookEx(nullptr, nCode, wParam, lParam);
+}
+
+/**
+ * @brief Low-level mouse hook: queues movements and button transitions and passes the event on.
+ */
+
+LRESULT CALLBACK Win32InputBackend::mouseProc(int nCode, WPARAM wParam, LPARAM lParam)
+{
+    if (nCode >= 0 && active != nullptr)
+    {
+        MSLLHOOKSTRUCT *pMouseStruct = reinterpret_cast<MSLLHOOKSTRUCT*>(lParam);
+
+        InputEvent event;
+        event.position = QPoint(pMouseStruct->pt.x, pMouseStruct->pt.y);
+        event.timestamp = currentTime();
+        event.isInjected = InjectionLatency::isTagged(pMouseStruct->dwExtraInfo, event.injectionSequence);
+
+        bool isKnown = true;
+        switch (wParam)
+        {
+        case WM_MOUSEMOVE:
+            event.type = InputEvent::MouseMove;
+            break;
+        case WM_LBUTTONDOWN:
+        case WM_RBUTTONDOWN:
+        case WM_MBUTTONDOWN:
+            event.type = InputEvent::ButtonDown;
+            event.code = wParam == WM_LBUTTONDOWN ? 0 : (wParam == WM_RBUTTONDOWN ? 1 : 2);
+            break;
+        case WM_LBUTTONUP:
+        case WM_RBUTTONUP:
+        case WM_MBUTTONUP:
+            event.type = InputEvent::ButtonUp;
+            event.code = wParam == WM_LBUTTONUP ? 0 : (wParam == WM_RBUTTONUP ? 1 : 2);
+            break;
+        default:
+            isKnown = false;
+            break;
+        }
+
+        if (isKnown)
+        {
+            active->listener->post(event);
+        }
+    }
+    return CallNextHookEx(nullptr, nCode, wParam, lParam);
+}
+
+#endif
+
+ReplayInputBackend::ReplayInputBackend(const QString& filePath)
+    : filePath(filePath)
+{
+}
+
+/**
+ * @brief Loads the recording and starts replaying it from its first event.
+ *
+ * @details One event per line: "<ms> keydown|keyup <vk>", "<ms> move <x> <y>" or "<ms> buttondown|buttonup <button> [x y]",
+ * where ms is the time since the start of the replay. Lines starting with '#' are ignored.
+ */
+
+bool ReplayInputBackend::start(InputListener *listener)
+{
+    this->listener = listener;
+    if (!load())
+    {
+        return false;
+    }
+
+    nextEvent = 0;
+    timer = new QTimer();
+    timer->setTimerType(Qt::PreciseTimer);
+    timer->setSingleShot(true);
+    QObject::connect(timer, &QTimer::timeout, timer, [this]()
+    {
+        replayDue();
+    });
+
+    elapsed.start();
+    replayDue();
+    return true;
+}
+
+/**
+ * @brief Stops the replay.
+ */
+
+void ReplayInputBackend::stop()
+{
+    delete timer;
+    timer = nullptr;
+}
+
+/**
+ * @brief Enables or disables the replay of pointer events.
+ */
+
+void ReplayInputBackend::setMouseCapture(bool enabled)
+{
+    isMouseCaptured = enabled;
+}
+
+QString ReplayInputBackend::getName() const
+{
+    return "replay";
+}
+
+/**
+ * @brief Parses the recording file.
+ */
+
+bool ReplayInputBackend::load()
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        return false;
+    }
+
+    recording.clear();
+    QTextStream stream(&file);
+    while (!stream.atEnd())
+    {
+        const QStringList tokens = stream.readLine().simplified().toLower().split(' ', Qt::SkipEmptyParts);
+        if (tokens.size() < 3 || tokens.first().startsWith('#'))
+        {
+            continue;
+        }
+
+        RecordedEvent recorded;
+        recorded.time = tokens.at(0).toLongLong() * 1000000;
+        const QString& type = tokens.at(1);
+        if (type == "keydown" || type == "keyup")
+        {
+            recorded.event.type = type == "keydown" ? InputEvent::KeyDown : InputEvent::KeyUp;
+            recorded.event.code = tokens.at(2).toInt(nullptr, 0);
+        } else if (type == "move" && tokens.size() >= 4)
+        {
+            recorded.event.type = InputEvent::MouseMove;
+            recorded.event.position = QPoint(tokens.at(2).toInt(), tokens.at(3).toInt());
+        } else if (type == "buttondown" || type == "buttonup")
+        {
+            recorded.event.type = type == "buttondown" ? InputEvent::ButtonDown : InputEvent::ButtonUp;
+            recorded.event.code = tokens.at(2).toInt();
+            if (tokens.size() >= 5)
+            {
+                recorded.event.position = QPoint(tokens.at(3).toInt(), tokens.at(4).toInt());
+            }
+        } else
+        {
+            continue;
+        }
+        recording.append(recorded);
+    }
+    return true;
+}
+
+/**
+ * @brief Posts every event whose time has come and waits for the next one.
+ */
+
+void ReplayInputBackend::replayDue()
+{
+    qint64 now = elapsed.nsecsElapsed();
+    while (nextEvent < recording.size() && recording.at(nextEvent).time <= now)
+    {
+        InputEvent event = recording.at(nextEvent++).event;
+        bool isMouseEvent = event.type != InputEvent::KeyDown && event.type != InputEvent::KeyUp;
+        if (!isMouseEvent || isMouseCaptured)
+        {
+            event.timestamp = currentTime();
+            listener->post(event);
+        }
+    }
+
+    if (nextEvent < recording.size())
+    {
+        timer->start(static_cast<int>((recording.at(nextEvent).time - now + 999999) / 1000000));
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef INPUTBACKEND_H
+#define INPUTBACKEND_H
+
+#include "inputlistener.h"
+#include <QElapsedTimer>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+
+#if defined(Q_OS_WIN)
+#include <Windows.h>
+
+class Win32InputBackend : public InputBackend
+{
+public:
+    bool start(InputListener *listener) override;
+    void stop() override;
+    void setMouseCapture(bool enabled) override;
+    QString getName() const override;
+
+private:
+    static Win32InputBackend* active;
+    static LRESULT CALLBACK keyboardProc(int nCode, WPARAM wParam, LPARAM lParam);
+    static LRESULT CALLBACK mouseProc(int nCode, WPARAM wParam, LPARAM lParam);
+
+    InputListener *listener = nullptr;
+    HHOOK keyboardHook = nullptr;
+    HHOOK mouseHook = nullptr;
+};
+#endif
+
+class ReplayInputBackend : public InputBackend
+{
+public:
+    explicit ReplayInputBackend(const QString& filePath);
+
+    bool start(InputListener *listener) override;
+    void stop() override;
+    void setMouseCapture(bool enabled) override;
+    QString getName() const override;
+
+private:
+    struct RecordedEvent {
+        qint64 time;
+        InputEvent event;
+    };
+
+    QString filePath;
+    QVector<RecordedEvent> recording;
+    int nextEvent = 0;
+    InputListener *listener = nullptr;
+    QTimer *timer = nullptr;
+    QElapsedTimer elapsed;
+    bool isMouseCaptured = false;
+
+    bool load();
+    void replayDue();
+};
+
+#endif // INPUTBACKEND_H
@@ -0,0 +1,58 @@
+#include "inputevent.h"
+
+/**
+ * @brief Fixed-capacity single-producer/single-consumer queue of input events.
+ *
+ * @details Events are copied into a preallocated array and the read and write positions are published with
+ * acquire/release atomics, so pushing from a hook callback never allocates and never takes a lock. When the
+ * consumer falls behind by more than the capacity, new events are dropped and counted instead of blocking the
+ * producer, which must return to the system quickly.
+ */
+
+/**
+ * @brief Appends an event; called by the producer only.
+ *
+ * @return True if the event was queued; false if the queue is full.
+ */
+
+bool InputEventRing::push(const InputEvent& event)
+{
+    quint32 write = head.load(std::memory_order_relaxed);
+    if (write - tail.load(std::memory_order_acquire) >= capacity)
+    {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    events[write % capacity] = event;
+    head.store(write + 1, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Removes the oldest event; called by the consumer only.
+ *
+ * @return True if an event was available; otherwise, false.
+ */
+
+bool InputEventRing::pop(InputEvent& event)
+{
+    quint32 read = tail.load(std::memory_order_relaxed);
+    if (read == head.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    event = events[read % capacity];
+    tail.store(read + 1, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Returns the number of events dropped because the queue was full.
+ */
+
+quint64 InputEventRing::getDroppedCount() const
+{
+    return dropped.load(std::memory_order_relaxed);
+}
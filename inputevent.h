@@ -0,0 +1,41 @@
+#ifndef INPUTEVENT_H
+#define INPUTEVENT_H
+
+#include <QPoint>
+#include <QtGlobal>
+#include <atomic>
+
+struct InputEvent {
+    enum Type : quint8 {
+        KeyDown,
+        KeyUp,
+        MouseMove,
+        ButtonDown,
+        ButtonUp
+    };
+
+    Type type = KeyDown;
+    int code = 0;
+    QPoint position;
+    qint64 timestamp = 0;
+    bool isInjected = false;
+    quint16 injectionSequence = 0;
+};
+
+class InputEventRing
+{
+public:
+    static constexpr quint32 capacity = 1024;
+
+    bool push(const InputEvent& event);
+    bool pop(InputEvent& event);
+    quint64 getDroppedCount() const;
+
+private:
+    InputEvent events[capacity];
+    std::atomic<quint32> head{0};
+    std::atomic<quint32> tail{0};
+    std::atomic<quint64> dropped{0};
+};
+
+#endif // INPUTEVENT_H
@@ -0,0 +1,120 @@
+#include "inputinjector.h"
+
+/**
+ * @brief Delivers the input events built by the MouseManager.
+ *
+ * @details The live engine hands its events to SendInput and reads the cursor with GetCursorPos. Checks and the
+ * stress harness substitute a RecordingInjector, so the real engine runs its jobs without moving the cursor and
+ * every injection can be timed and counted. Messages posted to a target window do not pass through here.
+ */
+
+/**
+ * @brief Injects the events into the system input queue.
+ */
+
+void SystemInputInjector::send(INPUT *inputs, int count)
+{
+    SendInput(count, inputs, sizeof(INPUT));
+}
+
+/**
+ * @brief Returns the position of the system cursor, or (0, 0) if it cannot be read.
+ */
+
+QPoint SystemInputInjector::cursorPosition()
+{
+    POINT cursorPos;
+    if (GetCursorPos(&cursorPos))
+    {
+        return QPoint(cursorPos.x, cursorPos.y);
+    }
+    return QPoint();
+}
+
+/**
+ * @brief Creates an injector that delivers nothing and reports every injection, timestamped by the clock.
+ *
+ * @param clock The clock the times are read from; must outlive the injector.
+ */
+
+RecordingInjector::RecordingInjector(const EngineClock& clock)
+    : clock(clock)
+{
+}
+
+/**
+ * @brief Sets the function called for every injection, on the thread that injects.
+ */
+
+void RecordingInjector::setHandler(const std::function<void(const Record&)>& handler)
+{
+    this->handler = handler;
+}
+
+/**
+ * @brief Sets the position reported as the cursor position.
+ */
+
+void RecordingInjector::setCursor(const QPoint& position)
+{
+    cursor = position;
+}
+
+/**
+ * @brief Classifies the events and passes the record to the handler.
+ *
+ * @details An injection is a release if none of its events presses a button or key or moves the cursor; the
+ * engine sends those even after a stop so nothing stays pressed. The position is the normalized absolute position
+ * of the first absolute move.
+ */
+
+void RecordingInjector::send(INPUT *inputs, int count)
+{
+    Record record;
+    record.time = clock.now();
+    record.count = count;
+
+    for (int i = 0; i < count; ++i)
+    {
+        const INPUT& input = inputs[i];
+        if (input.type == INPUT_MOUSE)
+        {
+            DWORD flags = input.mi.dwFlags;
+            if (flags & (MOUSEEVENTF_LEFTDOWN | MOUSEEVENTF_RIGHTDOWN | MOUSEEVENTF_MIDDLEDOWN))
+            {
+                ++record.buttonDowns;
+                ++record.presses;
+            }
+            if (flags & MOUSEEVENTF_MOVE)
+            {
+                record.isRelease = false;
+                if ((flags & MOUSEEVENTF_ABSOLUTE) && !record.hasPosition)
+                {
+                    record.hasPosition = true;
+                    record.position = QPoint(input.mi.dx, input.mi.dy);
+                }
+            }
+        } else if (input.type == INPUT_KEYBOARD && !(input.ki.dwFlags & KEYEVENTF_KEYUP))
+        {
+            ++record.presses;
+        }
+    }
+    if (record.presses > 0)
+    {
+        record.isRelease = false;
+    }
+
+    if (handler)
+    {
+        handler(record);
+    }
+}
+
+/**
+ * @brief Returns the position set with setCursor().
+ */
+
+QPoint RecordingInjector::cursorPosition()
+{
+    return cursor;
+}
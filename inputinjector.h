@@ -0,0 +1,51 @@
+#ifndef INPUTINJECTOR_H
+#define INPUTINJECTOR_H
+
+#include "engineclock.h"
+#include <QPoint>
+#include <functional>
+#include <Windows.h>
+
+class InputInjector
+{
+public:
+    virtual ~InputInjector() = default;
+
+    virtual void send(INPUT *inputs, int count) = 0;
+    virtual QPoint cursorPosition() = 0;
+};
+
+class SystemInputInjector : public InputInjector
+{
+public:
+    void send(INPUT *inputs, int count) override;
+    QPoint cursorPosition() override;
+};
+
+class RecordingInjector : public InputInjector
+{
+public:
+    struct Record {
+        qint64 time = 0;
+        int count = 0;
+        int presses = 0;
+        int buttonDowns = 0;
+        bool isRelease = true;
+        bool hasPosition = false;
+        QPoint position;
+    };
+
+    explicit RecordingInjector(const EngineClock& clock);
+
+    void setHandler(const std::function<void(const Record&)>& handler);
+    void setCursor(const QPoint& position);
+    void send(INPUT *inputs, int count) override;
+    QPoint cursorPosition() override;
+
+private:
+    const EngineClock& clock;
+    std::function<void(const Record&)> handler;
+    QPoint cursor;
+};
+
+#endif // INPUTINJECTOR_H
@@ -0,0 +1,274 @@
+#include "inputlistener.h"
+#include "inputbackend.h"
+#include "tracer.h"
+#include <QDebug>
+#include <QMutexLocker>
+
+/**
+ * @brief System-wide keyboard and mouse listener running on its own thread.
+ *
+ * @details A backend (low-level hooks on Windows or a recorded file) is started on a dedicated time-critical thread
+ * whose event loop pumps the backend's messages. Backends only append events to a fixed ring and request one dispatch
+ * per batch, so a hook callback returns immediately and no allocation happens per event. The dispatch is requested
+ * through a message-only window created once with the thread instead of a queued call, which would allocate an event
+ * per batch. The dispatch drains the whole batch and hands every event to the registered consumers whose event mask
+ * matches. Events injected by this application
+ * are only handed to InjectedEvents consumers, so user input handling never reacts to its own clicks. Mouse events are
+ * only captured while at least one consumer asks for them or for injected events.
+ */
+
+InputListener* InputListener::instance = nullptr;
+
+InputListener* InputListener::getInstance()
+{
+    if (!instance)
+    {
+        instance = new InputListener();
+    }
+    return instance;
+}
+
+InputListener::InputListener(QObject *parent) : QObject(parent),
+    listenerThread(new QThread()),
+    backend(nullptr),
+    isDispatchPending(false),
+    isMouseCaptured(false)
+{
+    listenerThread->setObjectName("InputListener");
+    moveToThread(listenerThread);
+    listenerThread->start(QThread::TimeCriticalPriority);
+    QMetaObject::invokeMethod(this, &InputListener::createWakeup, Qt::QueuedConnection);
+
+#if defined(Q_OS_WIN)
+    setBackend(new Win32InputBackend());
+#endif
+}
+
+InputListener::~InputListener()
+{
+    QMetaObject::invokeMethod(this, [this]()
+    {
+        replaceBackend(nullptr);
+        destroyWakeup();
+    }, Qt::BlockingQueuedConnection);
+
+    listenerThread->quit();
+    listenerThread->wait();
+    delete listenerThread;
+    instance = nullptr;
+}
+
+/**
+ * @brief Replaces the event source; the old backend is stopped and deleted on the listener thread.
+ *
+ * @param newBackend The new backend; the listener takes ownership.
+ */
+
+void InputListener::setBackend(InputBackend *newBackend)
+{
+    QMetaObject::invokeMethod(this, [this, newBackend]()
+    {
+        replaceBackend(newBackend);
+    }, Qt::QueuedConnection);
+}
+
+/**
+ * @brief Stops the current backend and starts the new one; runs on the listener thread.
+ */
+
+void InputListener::replaceBackend(InputBackend *newBackend)
+{
+    if (backend)
+    {
+        backend->stop();
+        delete backend;
+    }
+
+    backend = newBackend;
+    if (backend)
+    {
+        if (!backend->start(this))
+        {
+            emit backendFailed(QString("Input backend '%1' could not be started").arg(backend->getName()));
+        }
+        backend->setMouseCapture(isMouseCaptured);
+    }
+}
+
+/**
+ * @brief Registers a consumer. It is called on the listener thread for every event matching the mask.
+ *
+ * @param consumer The consumer; must stay alive until removeConsumer() is called.
+ * @param eventMask Combination of EventMask flags.
+ */
+
+void InputListener::addConsumer(InputConsumer *consumer, int eventMask)
+{
+    {
+        QMutexLocker locker(&consumerMutex);
+        consumers.append({consumer, eventMask});
+    }
+    QMetaObject::invokeMethod(this, &InputListener::updateMouseCapture, Qt::QueuedConnection);
+}
+
+/**
+ * @brief Unregisters a consumer.
+ */
+
+void InputListener::removeConsumer(InputConsumer *consumer)
+{
+    {
+        QMutexLocker locker(&consumerMutex);
+        for (int i = consumers.size() - 1; i >= 0; --i)
+        {
+            if (consumers.at(i).consumer == consumer)
+            {
+                consumers.remove(i);
+            }
+        }
+    }
+    QMetaObject::invokeMethod(this, &InputListener::updateMouseCapture, Qt::QueuedConnection);
+}
+
+/**
+ * @brief Queues an event from a backend and requests a dispatch unless one is already pending.
+ */
+
+void InputListener::post(const InputEvent& event)
+{
+    Tracer::record(Tracer::HookEvent, event.type, event.code);
+    ring.push(event);
+    if (!isDispatchPending.exchange(true, std::memory_order_acq_rel))
+    {
+        wake();
+    }
+}
+
+/**
+ * @brief Creates the wake-up object on the listener thread; falls back to queued calls if that fails.
+ */
+
+void InputListener::createWakeup()
+{
+#if defined(Q_OS_WIN)
+    static const wchar_t className[] = L"InputListenerWakeup";
+    WNDCLASSW windowClass = {};
+    windowClass.lpfnWndProc = wakeProc;
+    windowClass.hInstance = GetModuleHandle(NULL);
+    windowClass.lpszClassName = className;
+    RegisterClassW(&windowClass);
+
+    wakeWindow = CreateWindowExW(0, className, L"", 0, 0, 0, 0, 0, HWND_MESSAGE, nullptr, GetModuleHandle(NULL), nullptr);
+    if (wakeWindow == nullptr)
+    {
+        qDebug() << "Input listener wake-up window could not be created, error" << GetLastError();
+    }
+#endif
+}
+
+/**
+ * @brief Destroys the wake-up object; runs on the listener thread.
+ */
+
+void InputListener::destroyWakeup()
+{
+#if defined(Q_OS_WIN)
+    if (wakeWindow != nullptr)
+    {
+        DestroyWindow(wakeWindow);
+        wakeWindow = nullptr;
+    }
+#endif
+}
+
+/**
+ * @brief Requests a dispatch on the listener thread without allocating.
+ */
+
+void InputListener::wake()
+{
+#if defined(Q_OS_WIN)
+    if (wakeWindow != nullptr && PostMessageW(wakeWindow, WM_APP, 0, 0))
+    {
+        return;
+    }
+#endif
+    QMetaObject::invokeMethod(this, &InputListener::dispatch, Qt::QueuedConnection);
+}
+
+#if defined(Q_OS_WIN)
+/**
+ * @brief Window procedure of the wake-up window: dispatches the queued events.
+ */
+
+LRESULT CALLBACK InputListener::wakeProc(HWND window, UINT message, WPARAM wParam, LPARAM lParam)
+{
+    if (message == WM_APP && instance != nullptr)
+    {
+        instance->dispatch();
+        return 0;
+    }
+    return DefWindowProcW(window, message, wParam, lParam);
+}
+#endif
+
+/**
+ * @brief Returns the number of events lost because consumers fell behind.
+ */
+
+quint64 InputListener::getDroppedCount() const
+{
+    return ring.getDroppedCount();
+}
+
+/**
+ * @brief Delivers every queued event to the matching consumers.
+ */
+
+void InputListener::dispatch()
+{
+    isDispatchPending.store(false, std::memory_order_release);
+
+    QMutexLocker locker(&consumerMutex);
+    InputEvent event;
+    while (ring.pop(event))
+    {
+        int eventMask = (event.type == InputEvent::KeyDown || event.type == InputEvent::KeyUp) ? KeyboardEvents : MouseEvents;
+        if (event.isInjected)
+        {
+            eventMask = InjectedEvents;
+        }
+        for (const Consumer& entry : std::as_const(consumers))
+        {
+            if (entry.eventMask & eventMask)
+            {
+                entry.consumer->inputEvent(event);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Captures mouse events only while a consumer needs them, including the measurement of injected clicks.
+ */
+
+void InputListener::updateMouseCapture()
+{
+    bool isNeeded = false;
+    {
+        QMutexLocker locker(&consumerMutex);
+        for (const Consumer& entry : std::as_const(consumers))
+        {
+            isNeeded = isNeeded || (entry.eventMask & (MouseEvents | InjectedEvents));
+        }
+    }
+
+    if (isNeeded != isMouseCaptured)
+    {
+        isMouseCaptured = isNeeded;
+        if (backend)
+        {
+            backend->setMouseCapture(isMouseCaptured);
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef INPUTLISTENER_H
+#define INPUTLISTENER_H
+
+#include "inputevent.h"
+#include <QMutex>
+#include <QObject>
+#include <QThread>
+#include <QVector>
+
+#if defined(Q_OS_WIN)
+#include <Windows.h>
+#endif
+
+class InputListener;
+
+class InputConsumer
+{
+public:
+    virtual ~InputConsumer() = default;
+
+    virtual void inputEvent(const InputEvent& event) = 0;
+};
+
+class InputBackend
+{
+public:
+    virtual ~InputBackend() = default;
+
+    virtual bool start(InputListener *listener) = 0;
+    virtual void stop() = 0;
+    virtual void setMouseCapture(bool enabled) = 0;
+    virtual QString getName() const = 0;
+};
+
+class InputListener : public QObject
+{
+    Q_OBJECT
+public:
+    enum EventMask {
+        KeyboardEvents = 1,
+        MouseEvents = 2,
+        InjectedEvents = 4
+    };
+
+    static InputListener* getInstance();
+    ~InputListener();
+
+    void setBackend(InputBackend *newBackend);
+    void addConsumer(InputConsumer *consumer, int eventMask);
+    void removeConsumer(InputConsumer *consumer);
+    void post(const InputEvent& event);
+    quint64 getDroppedCount() const;
+
+private:
+    explicit InputListener(QObject *parent = nullptr);
+    static InputListener* instance;
+
+    struct Consumer {
+        InputConsumer *consumer;
+        int eventMask;
+    };
+
+    QThread *listenerThread;
+    InputBackend *backend;
+    InputEventRing ring;
+    std::atomic<bool> isDispatchPending;
+    QMutex consumerMutex;
+    QVector<Consumer> consumers;
+    bool isMouseCaptured;
+#if defined(Q_OS_WIN)
+    HWND wakeWindow = nullptr;
+    static LRESULT CALLBACK wakeProc(HWND window, UINT message, WPARAM wParam, LPARAM lParam);
+#endif
+
+    void replaceBackend(InputBackend *newBackend);
+    void createWakeup();
+    void destroyWakeup();
+    void wake();
+
+private slots:
+    void dispatch();
+    void updateMouseCapture();
+
+signals:
+    void backendFailed(const QString& message);
+};
+
+#endif // INPUTLISTENER_H
@@ -1,6 +1,9 @@
 #include "inputmanager.h"
 #include "windowshookmanager.h"
 #include "mousemanager.h"
+#include "runconfig.h"
+#include "schedulingpolicy.h"
+#include "stoptoken.h"
 #include <QDebug>
 #include <QMap>
 #include <QString>
@@ -12,7 +15,9 @@
  *
  * @details This class coordinates interactions between the user interface, various hook-related operations,
  * handling key sequences, mouse movements, and application state changes. It connects user actions
- * to Windows hook manager and mouse manager instances for processing.
+ * to Windows hook manager and mouse manager instances for processing. The mouse manager lives on its own
+ * high-priority thread and is only driven through queued signals, so GUI work, dialogs and nested event loops
+ * never delay its timer.
  */
 
 InputManager* InputManager::instance = nullptr;
@@ -21,18 +26,62 @@ InputManager::InputManager(QObject *parent)
     : QObject(parent)
     ,isProcessRunning(false)
 {
+    ScreenLayout::getInstance();
+
     windowsHookManager = new WindowsHookManager(this);
     connect(this, &InputManager::hotkeyChangePassed, windowsHookManager, &WindowsHookManager::updateKeyboardVirtualKeys);
     connect(this, &InputManager::isDialogOpen, windowsHookManager, &WindowsHookManager::setDialogOpen);
     connect(windowsHookManager, &WindowsHookManager::passCursorLocation, this, &InputManager::updateUserCursorLocationSet);
+    connect(windowsHookManager, &WindowsHookManager::passCursorPreview, this, &InputManager::returnCursorPreview);
+    connect(windowsHookManager, &WindowsHookManager::cursorLocationCancelled, this, &InputManager::cursorLocationCancelled);
     connect(this, &InputManager::getCursorPosition, windowsHookManager, &WindowsHookManager::prepareToGetCursorLocation);
     windowsHookManager->updateKeyboardVirtualKeys("f6");
     connect(WindowsHookManager::getInstance(), &WindowsHookManager::keyboardEventTriggered, this, &InputManager::updateProcessWithHook);
 
-    mouseManager = new MouseManager(this);
+    engineThread = new QThread(this);
+    engineThread->setObjectName("ClickEngine");
+    mouseManager = new MouseManager();
+    mouseManager->moveToThread(engineThread);
+    connect(engineThread, &QThread::finished, mouseManager, &QObject::deleteLater);
     connect(this, &InputManager::startApplication, mouseManager, &MouseManager::runClickingApplication);
     connect(this, &InputManager::stopApplication,mouseManager, &MouseManager::stopClickingApplication);
-    connect(mouseManager, &MouseManager::finished,this, &InputManager::updateProcessWithHook);
+    connect(mouseManager, &MouseManager::finished, this, &InputManager::engineFinished);
+    connect(this, &InputManager::targetTemplateChanged, mouseManager, &MouseManager::setTargetTemplate);
+    connect(this, &InputManager::movementOptionsChanged, mouseManager, &MouseManager::setMovementOptions);
+    connect(mouseManager, &MouseManager::targetSearchFinished, this, &InputManager::targetSearchFinished);
+    connect(mouseManager, &MouseManager::reactionTriggered, this, &InputManager::reactionTriggered);
+    connect(this, &InputManager::scriptChanged, mouseManager, &MouseManager::setScript);
+    connect(mouseManager, &MouseManager::scriptError, this, &InputManager::scriptError);
+    connect(mouseManager, &MouseManager::timingUpdated, this, &InputManager::timingUpdated);
+    connect(mouseManager, &MouseManager::stopMeasured, this, &InputManager::stopMeasured);
+    connect(this, &InputManager::scheduleChanged, mouseManager, &MouseManager::setSchedule);
+    connect(mouseManager, &MouseManager::scheduleMeasured, this, &InputManager::scheduleMeasured);
+    connect(this, &InputManager::patternOptionsChanged, mouseManager, &MouseManager::setPatternOptions);
+    connect(this, &InputManager::areaShapeChanged, mouseManager, &MouseManager::setAreaShape);
+    connect(this, &InputManager::keyboardOptionsChanged, mouseManager, &MouseManager::setKeyboardOptions);
+    connect(this, &InputManager::userOverrideOptionsChanged, mouseManager, &MouseManager::setUserOverrideOptions);
+    connect(this, &InputManager::windowTargetChanged, mouseManager, &MouseManager::setWindowTarget);
+    connect(mouseManager, &MouseManager::windowTargetStatus, this, &InputManager::windowTargetStatus);
+    connect(ScreenCapture::getInstance(), &ScreenCapture::metricsUpdated, this, &InputManager::captureMetricsUpdated);
+
+    engineThread->start(QThread::TimeCriticalPriority);
+
+    SchedulingPolicy *policy = SchedulingPolicy::getInstance();
+    QMetaObject::invokeMethod(mouseManager, [policy]()
+    {
+        policy->applyToCurrentThread(SchedulingPolicy::Scheduler);
+    }, Qt::QueuedConnection);
+    QMetaObject::invokeMethod(InputListener::getInstance(), [policy]()
+    {
+        policy->applyToCurrentThread(SchedulingPolicy::Hook);
+    }, Qt::QueuedConnection);
+}
+
+InputManager::~InputManager()
+{
+    engineThread->quit();
+    engineThread->wait();
+    instance = nullptr;
 }
 
 InputManager* InputManager::getInstance(QObject *parent)
@@ -54,6 +103,14 @@ void InputManager::setMainWindowInstance(MainWindow *instance) {
     QObject::connect(this, &InputManager::initializeStartProcess, mainWindowInstance, &MainWindow::startApplication);
     QObject::connect(this, &InputManager::hotkeyChangePassed, mainWindowInstance, &MainWindow::updateButtonsText);
     QObject::connect(this, &InputManager::blockUIElements, mainWindowInstance, &MainWindow::blockUIElements);
+    QObject::connect(this, &InputManager::targetSearchFinished, mainWindowInstance, &MainWindow::updateTargetSearchResult);
+    QObject::connect(this, &InputManager::reactionTriggered, mainWindowInstance, &MainWindow::updateReactionLatency);
+    QObject::connect(this, &InputManager::captureMetricsUpdated, mainWindowInstance, &MainWindow::updateCaptureMetrics);
+    QObject::connect(this, &InputManager::scriptError, mainWindowInstance, &MainWindow::showScriptError);
+    QObject::connect(this, &InputManager::timingUpdated, mainWindowInstance, &MainWindow::updateTimingStats);
+    QObject::connect(this, &InputManager::stopMeasured, mainWindowInstance, &MainWindow::updateStopLatency);
+    QObject::connect(this, &InputManager::scheduleMeasured, mainWindowInstance, &MainWindow::updateScheduleError);
+    QObject::connect(this, &InputManager::windowTargetStatus, mainWindowInstance, &MainWindow::updateWindowStatus);
 }
 
 /**
@@ -66,6 +123,21 @@ void InputManager::updateProcessWithHook()
     updateProcessState(isProcessRunning);
 }
 
+/**
+ * @brief Updates the process state after the engine finished a job on its own.
+ *
+ * @details The finished signal is queued, so the user may have stopped the job in the meantime. Toggling here
+ * would then start the job again; a finished job only ever leads to a stop.
+ */
+
+void InputManager::engineFinished()
+{
+    if (isProcessRunning)
+    {
+        updateProcessState(true);
+    }
+}
+
 /**
  * @brief Updates the value of a specific button type from mainwindow class.
  *
@@ -89,6 +161,15 @@ QString InputManager::getUserHotkey()
     return userHotkey;
 }
 
+/**
+ * @brief Returns the mouse manager; it lives on the engine thread, so it may only be called into from there.
+ */
+
+MouseManager* InputManager::getMouseManager()
+{
+    return mouseManager;
+}
+
 /**
  * @brief Updates and sets the user-defined hotkey, emitting a signal upon change.
  *
@@ -114,6 +195,155 @@ void  InputManager::updateUserCursorLocationSet(int x, int y)
     emit returnCursorPosition(x,y);
 }
 
+/**
+ * @brief Passes the template image chosen for the target image location mode to the mouse manager.
+ *
+ * @param imagePath Path to the template image file.
+ */
+
+void InputManager::updateTargetTemplate(const QString& imagePath)
+{
+    emit targetTemplateChanged(imagePath);
+}
+
+/**
+ * @brief Sets how often the shared screen capture grabs frames for the vision features.
+ *
+ * @param framesPerSecond The wanted capture rate.
+ */
+
+void InputManager::updateCaptureRate(int framesPerSecond)
+{
+    ScreenCapture::getInstance()->setFrameRate(framesPerSecond);
+}
+
+/**
+ * @brief Passes the cursor movement options on to the mouse manager.
+ *
+ * @param isCurved Whether the cursor travels along a curved path instead of jumping.
+ * @param duration The travel time in milliseconds.
+ */
+
+void InputManager::updateMovementOptions(bool isCurved, int duration)
+{
+    emit movementOptionsChanged(isCurved, duration);
+}
+
+/**
+ * @brief Passes the action script on to the mouse manager.
+ *
+ * @param isEnabled Whether the script replaces the configured job.
+ * @param source The script text.
+ */
+
+void InputManager::updateScript(bool isEnabled, const QString& source)
+{
+    emit scriptChanged(isEnabled, source);
+}
+
+/**
+ * @brief Passes the scheduled start time and run duration on to the mouse manager.
+ *
+ * @param startAt The start time in milliseconds since the Unix epoch, or 0 to start immediately.
+ * @param runDuration The run duration in milliseconds, or 0 for no limit.
+ */
+
+void InputManager::updateSchedule(qint64 startAt, int runDuration)
+{
+    emit scheduleChanged(startAt, runDuration);
+}
+
+/**
+ * @brief Passes the point pattern of the pattern sweep location mode on to the mouse manager.
+ *
+ * @param kind The PointPattern::Kind of the sweep.
+ * @param columns The number of grid columns.
+ * @param rows The number of grid rows.
+ * @param spacing The distance between neighbouring points in pixels.
+ * @param count The number of spiral points.
+ * @param polyline The polyline vertices as "X Y, X Y, ...".
+ */
+
+void InputManager::updatePatternOptions(int kind, int columns, int rows, int spacing, int count, const QString& polyline)
+{
+    emit patternOptionsChanged(kind, columns, rows, spacing, count, polyline);
+}
+
+/**
+ * @brief Passes the shape of the random area location mode on to the mouse manager.
+ *
+ * @param kind The shape: circle, rectangle, ellipse, polygon or mask, in this order.
+ * @param width The width of a rectangle or ellipse in pixels.
+ * @param height The height of a rectangle or ellipse in pixels.
+ * @param polygon The polygon vertices as "X Y, X Y, ...".
+ * @param maskPath The mask image file.
+ */
+
+void InputManager::updateAreaShape(int kind, int width, int height, const QString& polygon, const QString& maskPath)
+{
+    emit areaShapeChanged(kind, width, height, polygon, maskPath);
+}
+
+/**
+ * @brief Passes the keyboard action on to the mouse manager.
+ *
+ * @param actionType 'm' for the mouse click, 'p' to press a key, 'h' to hold a key and 't' to type a text.
+ * @param virtualKey The virtual key code pressed or held.
+ * @param holdDuration How long a held key stays down in milliseconds.
+ * @param text The text to type.
+ * @param characterDelay The delay between typed characters in milliseconds.
+ */
+
+void InputManager::updateKeyboardOptions(const QChar& actionType, int virtualKey, int holdDuration, const QString& text, int characterDelay)
+{
+    emit keyboardOptionsChanged(actionType, virtualKey, holdDuration, text, characterDelay);
+}
+
+/**
+ * @brief Passes the user override options on to the mouse manager.
+ *
+ * @param isEnabled Whether the job pauses while the user uses the mouse.
+ * @param idleTime How long the mouse has to stay idle before the job resumes, in milliseconds.
+ */
+
+void InputManager::updateUserOverrideOptions(bool isEnabled, int idleTime)
+{
+    emit userOverrideOptionsChanged(isEnabled, idleTime);
+}
+
+/**
+ * @brief Passes the target window on to the mouse manager.
+ *
+ * @param isEnabled Whether input is posted to the window instead of the global cursor position.
+ * @param title The window title, or empty to match any title.
+ * @param className The window class, or empty to match any class.
+ * @param handle A window picked on screen, or 0.
+ */
+
+void InputManager::updateWindowTarget(bool isEnabled, const QString& title, const QString& className, qint64 handle)
+{
+    emit windowTargetChanged(isEnabled, title, className, handle);
+}
+
+/**
+ * @brief Publishes the settings a running job can change without restarting.
+ *
+ * @param fixedTime The fixed time interval, or the lower bound of the random interval, in milliseconds.
+ * @param randomTime The width of the random interval in milliseconds.
+ * @param location The coordinates for the process location.
+ * @param area The area size for the process.
+ */
+
+void InputManager::updateRunConfig(int fixedTime, int randomTime, const QPoint& location, int area)
+{
+    RunConfig::Snapshot config;
+    config.timeToClick = fixedTime;
+    config.addRandomTime = qMax(0, randomTime);
+    config.location = location;
+    config.area = area;
+    RunConfig::getInstance()->publish(config);
+}
+
 /**
  * @brief Updates the state of the process based on the given boolean value.
  *
@@ -125,6 +355,7 @@ void InputManager::updateProcessState(bool stop)
 {
     if (stop)
     {
+        StopToken::getInstance()->requestStop();
         emit stopApplication();
         blockUIElements(true);
         isProcessRunning = false;
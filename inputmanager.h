@@ -3,11 +3,14 @@
 
 #include "mainwindow.h"
 #include "mousemanager.h"
+#include "screencapture.h"
+#include "screenlayout.h"
 #include "windowshookmanager.h"
 #include <QLocalSocket>
 #include <QObject>
 #include <QMap>
 #include <QString>
+#include <QThread>
 #include <QTimer>
 
 class InputManager : public QObject
@@ -15,10 +18,12 @@ class InputManager : public QObject
     Q_OBJECT
 public:
     static InputManager* getInstance(QObject *parent = nullptr);
+    ~InputManager();
 
     void setMainWindowInstance(MainWindow *instance);
     void changeButton(const QString& buttonType, const QString& value);
     QString getUserHotkey();
+    MouseManager* getMouseManager();
     bool isProcessRunning;
 
 private:
@@ -26,8 +31,10 @@ private:
     static InputManager* instance;
     WindowsHookManager* windowsHookManager;
     MouseManager* mouseManager;
+    QThread* engineThread;
     MainWindow* mainWindowInstance;
     void updateProcessWithHook();
+    void engineFinished();
 
     QMap<QString, QString> radioButtonValues;
     QTimer debounceTimer;
@@ -38,16 +45,46 @@ public slots:
     void updateUserHotkey(const QString pressedKeys);
     void updateUserCursorLocationSet(int x, int y);
     void updateUserData(int fixedTime, int randomTime,const int& repeatTimes,const QPoint& location, const int& area);
+    void updateTargetTemplate(const QString& imagePath);
+    void updateCaptureRate(int framesPerSecond);
+    void updateMovementOptions(bool isCurved, int duration);
+    void updateScript(bool isEnabled, const QString& source);
+    void updateSchedule(qint64 startAt, int runDuration);
+    void updateRunConfig(int fixedTime, int randomTime, const QPoint& location, int area);
+    void updatePatternOptions(int kind, int columns, int rows, int spacing, int count, const QString& polyline);
+    void updateAreaShape(int kind, int width, int height, const QString& polygon, const QString& maskPath);
+    void updateKeyboardOptions(const QChar& actionType, int virtualKey, int holdDuration, const QString& text, int characterDelay);
+    void updateUserOverrideOptions(bool isEnabled, int idleTime);
+    void updateWindowTarget(bool isEnabled, const QString& title, const QString& className, qint64 handle);
 
 signals:
     void hotkeyChangePassed(QString newHotkey);
     void getCursorPosition();
     void returnCursorPosition(int x, int y);
+    void returnCursorPreview(int x, int y);
+    void cursorLocationCancelled();
     void startApplication(const int& clickTime, const int& timeBetweenClicks, const QChar& type, const int& repetitions, const QChar& location, const QPoint& xy, const int& area);
     void stopApplication();
     void initializeStartProcess();
     void isDialogOpen(bool isDialog);
     void blockUIElements(bool isBlock);
+    void targetTemplateChanged(const QString& imagePath);
+    void movementOptionsChanged(bool isCurved, int duration);
+    void targetSearchFinished(bool found, double score, double searchTime);
+    void reactionTriggered(double latency);
+    void captureMetricsUpdated(double captureRate, double frameCost);
+    void scriptChanged(bool isEnabled, const QString& source);
+    void scriptError(const QString& message);
+    void timingUpdated(double meanLateness, double maxLateness, double injectionLatency);
+    void stopMeasured(double stopLatency, double injectionOvershoot);
+    void scheduleChanged(qint64 startAt, int runDuration);
+    void scheduleMeasured(const QString& event, double error);
+    void patternOptionsChanged(int kind, int columns, int rows, int spacing, int count, const QString& polyline);
+    void areaShapeChanged(int kind, int width, int height, const QString& polygon, const QString& maskPath);
+    void keyboardOptionsChanged(const QChar& actionType, int virtualKey, int holdDuration, const QString& text, int characterDelay);
+    void userOverrideOptionsChanged(bool isEnabled, int idleTime);
+    void windowTargetChanged(bool isEnabled, const QString& title, const QString& className, qint64 handle);
+    void windowTargetStatus(bool found, const QString& description);
 
 };
 
@@ -0,0 +1,181 @@
+#include "jobcheckpoint.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <atomic>
+
+/**
+ * @brief Crash-safe record of a running job's progress in a memory-mapped file.
+ *
+ * @details The file holds two slots that are written alternately. A slot is invalidated (sequence 0) before its
+ * fields are written and gets the next sequence number afterwards, with release fences in between, so a process
+ * that dies in the middle of a write leaves the other slot intact. Saving is a plain copy into the mapping: the
+ * page cache keeps it when the process crashes, and there is no system call per save. Loading picks the valid slot
+ * with the highest sequence whose program fingerprint matches, so a checkpoint is only resumed by the same job.
+ * A lock file next to the checkpoint keeps a second process from writing and clearing the same slots; the lock of
+ * a crashed process is stale and taken over, so its checkpoint can still be resumed.
+ */
+
+JobCheckpoint::~JobCheckpoint()
+{
+    close();
+}
+
+/**
+ * @brief Opens or creates the checkpoint file and maps it into memory.
+ *
+ * @param filePath The checkpoint file.
+ * @return True if the file is mapped; otherwise, false and checkpoints are not kept, also if another process
+ * holds the file.
+ */
+
+bool JobCheckpoint::open(const QString& filePath)
+{
+    close();
+
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+    lock.reset(new QLockFile(filePath + ".lock"));
+    if (!lock->tryLock(0))
+    {
+        lock.reset();
+        return false;
+    }
+
+    file.setFileName(filePath);
+    if (!file.open(QIODevice::ReadWrite))
+    {
+        close();
+        return false;
+    }
+
+    bool isNew = file.size() != static_cast<qint64>(sizeof(Layout));
+    if (isNew && !file.resize(sizeof(Layout)))
+    {
+        close();
+        return false;
+    }
+
+    layout = reinterpret_cast<Layout*>(file.map(0, sizeof(Layout)));
+    if (layout == nullptr)
+    {
+        close();
+        return false;
+    }
+
+    if (isNew || layout->magic != magic || layout->version != version)
+    {
+        layout->magic = magic;
+        layout->version = version;
+        clear();
+    }
+
+    sequence = qMax(layout->slots[0].sequence, layout->slots[1].sequence);
+    return true;
+}
+
+/**
+ * @brief Unmaps and closes the checkpoint file and releases its lock; its content stays on disk.
+ */
+
+void JobCheckpoint::close()
+{
+    if (layout != nullptr)
+    {
+        file.unmap(reinterpret_cast<uchar*>(layout));
+        layout = nullptr;
+    }
+    if (file.isOpen())
+    {
+        file.close();
+    }
+    lock.reset();
+}
+
+/**
+ * @brief Checks whether the checkpoint file is mapped.
+ */
+
+bool JobCheckpoint::isOpen() const
+{
+    return layout != nullptr;
+}
+
+/**
+ * @brief Reads the latest state saved for a program.
+ *
+ * @param fingerprint The fingerprint of the program about to run.
+ * @param state Receives the saved state.
+ * @return True if an unfinished run of this program was saved; otherwise, false.
+ */
+
+bool JobCheckpoint::load(quint64 fingerprint, ActionVM::State& state) const
+{
+    if (layout == nullptr)
+    {
+        return false;
+    }
+
+    const Slot *latest = nullptr;
+    for (const Slot& slot : layout->slots)
+    {
+        if (slot.sequence != 0 && slot.fingerprint == fingerprint && (latest == nullptr || slot.sequence > latest->sequence))
+        {
+            latest = &slot;
+        }
+    }
+
+    if (latest == nullptr)
+    {
+        return false;
+    }
+    state = latest->state;
+    return true;
+}
+
+/**
+ * @brief Saves the state of the running program into the older slot.
+ *
+ * @param fingerprint The fingerprint of the running program.
+ * @param state The state to save.
+ */
+
+void JobCheckpoint::save(quint64 fingerprint, const ActionVM::State& state)
+{
+    if (layout == nullptr)
+    {
+        return;
+    }
+
+    Slot& slot = layout->slots[(sequence + 1) % 2];
+    slot.sequence = 0;
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.fingerprint = fingerprint;
+    slot.state = state;
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.sequence = ++sequence;
+}
+
+/**
+ * @brief Invalidates both slots, e.g. when a job finished or was stopped on purpose.
+ */
+
+void JobCheckpoint::clear()
+{
+    if (layout == nullptr)
+    {
+        return;
+    }
+
+    layout->slots[0].sequence = 0;
+    layout->slots[1].sequence = 0;
+    sequence = 0;
+}
+
+/**
+ * @brief Returns the checkpoint file in the application's local data directory.
+ */
+
+QString JobCheckpoint::defaultPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/checkpoint.bin";
+}
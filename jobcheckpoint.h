@@ -0,0 +1,46 @@
+#ifndef JOBCHECKPOINT_H
+#define JOBCHECKPOINT_H
+
+#include "actionvm.h"
+#include <QFile>
+#include <QLockFile>
+#include <QString>
+#include <memory>
+
+class JobCheckpoint
+{
+public:
+    ~JobCheckpoint();
+
+    bool open(const QString& filePath);
+    void close();
+    bool isOpen() const;
+    bool load(quint64 fingerprint, ActionVM::State& state) const;
+    void save(quint64 fingerprint, const ActionVM::State& state);
+    void clear();
+
+    static QString defaultPath();
+
+private:
+    static constexpr quint32 magic = 0x4B504341;
+    static constexpr quint32 version = 3;
+
+    struct Slot {
+        quint64 sequence;
+        quint64 fingerprint;
+        ActionVM::State state;
+    };
+
+    struct Layout {
+        quint32 magic;
+        quint32 version;
+        Slot slots[2];
+    };
+
+    QFile file;
+    std::unique_ptr<QLockFile> lock;
+    Layout *layout = nullptr;
+    quint64 sequence = 0;
+};
+
+#endif // JOBCHECKPOINT_H
@@ -0,0 +1,246 @@
+#include "keysequence.h"
+#include <QHash>
+#include <QMutex>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#endif
+
+/**
+ * @brief Text translated into the key transitions that type it.
+ *
+ * @details The text is translated once, when the job is compiled, into one flat array of key strokes, so typing
+ * at full speed is a single batched injection and typing with a per-character delay only indexes the array.
+ * Characters the active keyboard layout can produce become virtual key presses wrapped in the Shift, Ctrl and Alt
+ * transitions the layout needs; everything else (and every character on platforms without a layout lookup) is
+ * sent as a Unicode key event, including both halves of a surrogate pair. The layout lookup is cached per layout
+ * and dropped when the user switches layouts.
+ */
+
+namespace
+{
+constexpr quint16 shiftKey = 0x10;
+constexpr quint16 controlKey = 0x11;
+constexpr quint16 altKey = 0x12;
+constexpr quint16 returnKey = 0x0D;
+constexpr quint16 tabKey = 0x09;
+
+constexpr quint8 shiftModifier = 1;
+constexpr quint8 controlModifier = 2;
+constexpr quint8 altModifier = 4;
+
+quint64 mixHash(quint64 hash, quint64 value)
+{
+    return (hash ^ value) * 0x100000001B3ULL;
+}
+}
+
+/**
+ * @brief Translates a text into key strokes for the current keyboard layout.
+ *
+ * @details The layout of the foreground window is looked up once for the whole text.
+ */
+
+KeySequence KeySequence::translate(const QString& text)
+{
+    void *layout = currentLayout();
+    KeySequence sequence;
+    sequence.keyStrokes.reserve(text.size() * 2);
+    sequence.characterEnds.reserve(text.size());
+
+    for (int i = 0; i < text.size(); ++i)
+    {
+        QChar character = text.at(i);
+        quint16 virtualKey = 0;
+        quint8 modifiers = 0;
+
+        if (character.isHighSurrogate() && i + 1 < text.size() && text.at(i + 1).isLowSurrogate())
+        {
+            sequence.appendUnicode(text.constData() + i, 2);
+            ++i;
+        } else if (character == '\r')
+        {
+            continue;
+        } else if (mapCharacter(character, layout, virtualKey, modifiers))
+        {
+            sequence.appendKey(virtualKey, modifiers, character.unicode());
+        } else
+        {
+            sequence.appendUnicode(&character, 1);
+        }
+        sequence.characterEnds.append(sequence.keyStrokes.size());
+    }
+
+    quint64 hash = 0xCBF29CE484222325ULL;
+    for (const KeyStroke& stroke : sequence.keyStrokes)
+    {
+        hash = mixHash(hash, stroke.code | (stroke.isUnicode ? 0x10000U : 0U) | (stroke.isRelease ? 0x20000U : 0U));
+    }
+    sequence.hash = hash;
+    return sequence;
+}
+
+/**
+ * @brief Returns the number of typed characters; a surrogate pair counts as one.
+ */
+
+int KeySequence::characterCount() const
+{
+    return characterEnds.size();
+}
+
+/**
+ * @brief Returns the number of key strokes of the whole text.
+ */
+
+int KeySequence::strokeCount() const
+{
+    return keyStrokes.size();
+}
+
+/**
+ * @brief Returns the key strokes of the whole text.
+ */
+
+const KeyStroke* KeySequence::strokes() const
+{
+    return keyStrokes.constData();
+}
+
+/**
+ * @brief Returns the index of the first key stroke of the given character.
+ */
+
+int KeySequence::characterBegin(int character) const
+{
+    return character > 0 ? characterEnds.at(character - 1) : 0;
+}
+
+/**
+ * @brief Returns the index after the last key stroke of the given character.
+ */
+
+int KeySequence::characterEnd(int character) const
+{
+    return characterEnds.at(character);
+}
+
+/**
+ * @brief Returns a hash of the key strokes, identifying the text in a program fingerprint.
+ */
+
+quint64 KeySequence::fingerprint() const
+{
+    return hash;
+}
+
+/**
+ * @brief Appends a virtual key press wrapped in its modifier transitions.
+ *
+ * @details The press and release of the key itself remember the character they type, so the text can also be
+ * delivered as character messages; the modifier transitions carry no character.
+ */
+
+void KeySequence::appendKey(quint16 virtualKey, quint8 modifiers, quint16 character)
+{
+    const quint16 modifierKeys[] = {shiftKey, controlKey, altKey};
+    for (int i = 0; i < 3; ++i)
+    {
+        if (modifiers & (1 << i))
+        {
+            keyStrokes.append(KeyStroke{modifierKeys[i], false, false, 0});
+        }
+    }
+    keyStrokes.append(KeyStroke{virtualKey, false, false, character});
+    keyStrokes.append(KeyStroke{virtualKey, false, true, character});
+    for (int i = 2; i >= 0; --i)
+    {
+        if (modifiers & (1 << i))
+        {
+            keyStrokes.append(KeyStroke{modifierKeys[i], false, true, 0});
+        }
+    }
+}
+
+/**
+ * @brief Appends Unicode key events for one character of one or two UTF-16 units.
+ */
+
+void KeySequence::appendUnicode(const QChar *units, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        keyStrokes.append(KeyStroke{units[i].unicode(), true, false, units[i].unicode()});
+    }
+    for (int i = 0; i < count; ++i)
+    {
+        keyStrokes.append(KeyStroke{units[i].unicode(), true, true, units[i].unicode()});
+    }
+}
+
+/**
+ * @brief Returns the keyboard layout of the foreground window, or nullptr where layouts cannot be looked up.
+ */
+
+void* KeySequence::currentLayout()
+{
+#if defined(Q_OS_WIN)
+    return GetKeyboardLayout(GetWindowThreadProcessId(GetForegroundWindow(), nullptr));
+#else
+    return nullptr;
+#endif
+}
+
+/**
+ * @brief Looks up the virtual key and modifiers that produce a character on a keyboard layout.
+ *
+ * @param layout The layout returned by currentLayout().
+ * @return False if the layout cannot produce the character, in which case it is typed as a Unicode event.
+ */
+
+bool KeySequence::mapCharacter(QChar character, void *layout, quint16& virtualKey, quint8& modifiers)
+{
+    if (character == '\n')
+    {
+        virtualKey = returnKey;
+        modifiers = 0;
+        return true;
+    }
+    if (character == '\t')
+    {
+        virtualKey = tabKey;
+        modifiers = 0;
+        return true;
+    }
+
+#if defined(Q_OS_WIN)
+    static QMutex mutex;
+    static HKL cachedLayout = nullptr;
+    static QHash<ushort, SHORT> cache;
+
+    HKL keyboardLayout = static_cast<HKL>(layout);
+    QMutexLocker locker(&mutex);
+    if (keyboardLayout != cachedLayout)
+    {
+        cache.clear();
+        cachedLayout = keyboardLayout;
+    }
+
+    auto cached = cache.constFind(character.unicode());
+    SHORT result = cached != cache.constEnd() ? cached.value() : VkKeyScanExW(character.unicode(), keyboardLayout);
+    if (cached == cache.constEnd())
+    {
+        cache.insert(character.unicode(), result);
+    }
+    if (result == -1 || (HIBYTE(result) & ~(shiftModifier | controlModifier | altModifier)) != 0)
+    {
+        return false;
+    }
+    virtualKey = LOBYTE(result);
+    modifiers = HIBYTE(result);
+    return true;
+#else
+    Q_UNUSED(layout);
+    return false;
+#endif
+}
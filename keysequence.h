@@ -0,0 +1,37 @@
+#ifndef KEYSEQUENCE_H
+#define KEYSEQUENCE_H
+
+#include <QString>
+#include <QVector>
+
+struct KeyStroke {
+    quint16 code = 0;
+    bool isUnicode = false;
+    bool isRelease = false;
+    quint16 character = 0;
+};
+
+class KeySequence
+{
+public:
+    static KeySequence translate(const QString& text);
+
+    int characterCount() const;
+    int strokeCount() const;
+    const KeyStroke* strokes() const;
+    int characterBegin(int character) const;
+    int characterEnd(int character) const;
+    quint64 fingerprint() const;
+
+private:
+    QVector<KeyStroke> keyStrokes;
+    QVector<qint32> characterEnds;
+    quint64 hash = 0;
+
+    void appendKey(quint16 virtualKey, quint8 modifiers, quint16 character);
+    void appendUnicode(const QChar *units, int count);
+    static void* currentLayout();
+    static bool mapCharacter(QChar character, void *layout, quint16& virtualKey, quint8& modifiers);
+};
+
+#endif // KEYSEQUENCE_H
@@ -1,11 +1,280 @@
 #include "mainwindow.h"
+#include "actionscript.h"
+#include "benchmarksuite.h"
+#include "enginechecks.h"
+#include "enginesimulator.h"
+#include "inputbackend.h"
+#include "schedulingpolicy.h"
+#include "stressharness.h"
+#include "tracer.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QJsonDocument>
+#include <QTextStream>
+
+/**
+ * @brief Compiles a script and runs it in the EngineSimulator, printing the result as JSON.
+ *
+ * @return The process exit code.
+ */
+
+static int runSimulation(const QCommandLineParser& parser)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QFile file(parser.value("simulate"));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        err << "Cannot open script " << file.fileName() << Qt::endl;
+        return 1;
+    }
+
+    ActionProgram program;
+    QString errorMessage;
+    if (!ActionScript::compile(QString::fromUtf8(file.readAll()), program, errorMessage))
+    {
+        err << file.fileName() << ": " << errorMessage << Qt::endl;
+        return 1;
+    }
+
+    EngineSimulator simulator;
+    for (const QString& hotkeyTime : parser.values("hotkey-at"))
+    {
+        simulator.scheduleHotkey(hotkeyTime.toLongLong() * 1000000);
+    }
+
+    qint64 endTime = parser.value("until").toLongLong() * 1000000;
+    EngineSimulator::Result result = simulator.run(program, parser.value("seed").toULongLong(), endTime);
+    out << QJsonDocument(result.toJson()).toJson();
+    return 0;
+}
+
+/**
+ * @brief Converts a binary trace file into Chrome trace JSON, written to the output file or to stdout.
+ *
+ * @return The process exit code.
+ */
+
+static int exportTrace(const QCommandLineParser& parser)
+{
+    QTextStream err(stderr);
+    QFile output;
+    bool isOpen = false;
+    if (parser.isSet("trace-output"))
+    {
+        output.setFileName(parser.value("trace-output"));
+        isOpen = output.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text);
+    } else
+    {
+        isOpen = output.open(stdout, QIODevice::WriteOnly | QIODevice::Text);
+    }
+
+    if (!isOpen)
+    {
+        err << "Cannot write " << output.fileName() << Qt::endl;
+        return 1;
+    }
+
+    QString errorMessage;
+    if (!Tracer::exportChromeJson(parser.value("trace-to-json"), output, errorMessage))
+    {
+        err << errorMessage << Qt::endl;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Runs the microbenchmarks, optionally stores the result and compares it with a baseline.
+ *
+ * @return 0 on success, 1 on an I/O error and 2 if a case regressed beyond the threshold.
+ */
+
+static int runBenchmark(const QCommandLineParser& parser)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QJsonObject result = BenchmarkSuite().run();
+    QByteArray json = QJsonDocument(result).toJson();
+    out << json;
+
+    if (parser.isSet("benchmark-output"))
+    {
+        QFile file(parser.value("benchmark-output"));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            err << "Cannot write " << file.fileName() << Qt::endl;
+            return 1;
+        }
+        file.write(json);
+    }
+
+    if (parser.isSet("baseline"))
+    {
+        QFile file(parser.value("baseline"));
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            err << "Cannot open baseline " << file.fileName() << Qt::endl;
+            return 1;
+        }
+
+        double threshold = parser.value("threshold").toDouble() / 100.0;
+        QStringList regressions = BenchmarkSuite::compare(result, QJsonDocument::fromJson(file.readAll()).object(), threshold);
+        for (const QString& regression : regressions)
+        {
+            err << "Regression " << regression << Qt::endl;
+        }
+        if (!regressions.isEmpty())
+        {
+            return 2;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Runs the start/stop stress harness and prints the result as JSON.
+ *
+ * @return 0 if every invariant held, otherwise 2.
+ */
+
+static int runStress(const QCommandLineParser& parser)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    StressHarness::Options options;
+    options.threads = parser.value("stress-threads").toInt();
+    options.operationsPerSecond = parser.value("stress-rate").toInt();
+    options.duration = parser.value("stress-duration").toLongLong();
+    options.seed = parser.value("seed").toULongLong();
+
+    StressHarness::Result result = StressHarness(options).run();
+    out << QJsonDocument(result.toJson()).toJson();
+    for (const QString& violation : result.violations)
+    {
+        err << "Violation: " << violation << Qt::endl;
+    }
+    return result.violations.isEmpty() ? 0 : 2;
+}
+
+/**
+ * @brief Runs the functional checks of the clicking engine and prints the result as JSON.
+ *
+ * @return 0 if every check passed, otherwise 2.
+ */
+
+static int runChecks()
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    EngineChecks::Result result = EngineChecks().run();
+    out << QJsonDocument(result.toJson()).toJson();
+    for (const QString& failure : result.failures)
+    {
+        err << "Failed: " << failure << Qt::endl;
+    }
+    return result.failures.isEmpty() ? 0 : 2;
+}
+
+/**
+ * @brief Configures the scheduling policy of the scheduler and hook threads from the command line.
+ *
+ * @return False if an option value is invalid.
+ */
+
+static bool setSchedulingPolicy(const QCommandLineParser& parser)
+{
+    SchedulingPolicy::Options options;
+    if (!SchedulingPolicy::parsePriority(parser.value("priority"), options.priority))
+    {
+        QTextStream(stderr) << "Unknown priority " << parser.value("priority") << Qt::endl;
+        return false;
+    }
+    options.schedulerCpu = parser.value("scheduler-cpu").toInt();
+    options.hookCpu = parser.value("hook-cpu").toInt();
+    options.isTimerResolution = !parser.isSet("no-timer-resolution");
+    SchedulingPolicy::getInstance()->setOptions(options);
+    return true;
+}
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption({"simulate", "Runs the action script <file> on a virtual clock and prints the result as JSON.", "file"});
+    parser.addOption({"until", "Virtual duration of the simulation in milliseconds.", "ms", "3600000"});
+    parser.addOption({"hotkey-at", "Presses the start/stop hotkey at the given virtual time; may be repeated.", "ms"});
+    parser.addOption({"seed", "Random seed of the simulation.", "seed", "1"});
+    parser.addOption({"benchmark", "Runs the microbenchmarks of the engine and prints the result as JSON."});
+    parser.addOption({"benchmark-output", "Also writes the benchmark result to <file>, e.g. to store a baseline.", "file"});
+    parser.addOption({"baseline", "Compares the benchmark result with the stored result in <file>.", "file"});
+    parser.addOption({"threshold", "Allowed slowdown against the baseline in percent.", "percent", "10"});
+    parser.addOption({"stress", "Fires storms of hotkey presses, stop requests and settings edits at the engine and checks its invariants."});
+    parser.addOption({"stress-threads", "Number of threads firing operations during the stress run.", "count", "4"});
+    parser.addOption({"stress-rate", "Operations per second fired by each stress thread.", "count", "2000"});
+    parser.addOption({"stress-duration", "Wall time of the stress run in milliseconds.", "ms", "5000"});
+    parser.addOption({"check", "Runs the functional checks of the clicking engine without injecting input and prints the result as JSON."});
+    parser.addOption({"replay-input", "Replays the recorded global input events in <file> instead of listening to the devices.", "file"});
+    parser.addOption({"trace", "Writes a binary trace of hook events, timer wake-ups, scheduling decisions and injections to <file>.", "file"});
+    parser.addOption({"trace-to-json", "Converts the binary trace <file> into Chrome trace JSON (chrome://tracing, Perfetto).", "file"});
+    parser.addOption({"trace-output", "Writes the converted trace to <file> instead of stdout.", "file"});
+    parser.addOption({"priority", "Priority of the scheduler and hook threads: default, high or realtime.", "level", "default"});
+    parser.addOption({"scheduler-cpu", "Pins the click scheduler thread to CPU <index>; -1 lets the system choose.", "index", "-1"});
+    parser.addOption({"hook-cpu", "Pins the input hook thread to CPU <index>; -1 lets the system choose.", "index", "-1"});
+    parser.addOption({"no-timer-resolution", "Does not request the 1 ms system timer resolution while a job runs (Windows)."});
+    parser.process(a);
+
+    if (!setSchedulingPolicy(parser))
+    {
+        return 1;
+    }
+
+    if (parser.isSet("simulate"))
+    {
+        return runSimulation(parser);
+    }
+
+    if (parser.isSet("benchmark"))
+    {
+        return runBenchmark(parser);
+    }
+
+    if (parser.isSet("stress"))
+    {
+        return runStress(parser);
+    }
+
+    if (parser.isSet("check"))
+    {
+        return runChecks();
+    }
+
+    if (parser.isSet("trace-to-json"))
+    {
+        return exportTrace(parser);
+    }
+
+    if (parser.isSet("trace") && !Tracer::getInstance()->start(parser.value("trace")))
+    {
+        QTextStream(stderr) << "Cannot write trace " << parser.value("trace") << Qt::endl;
+    }
+
+    if (parser.isSet("replay-input"))
+    {
+        InputListener::getInstance()->setBackend(new ReplayInputBackend(parser.value("replay-input")));
+    }
+
     MainWindow w;
     w.show();
-    return a.exec();
+    int exitCode = a.exec();
+    Tracer::getInstance()->stop();
+    return exitCode;
 }
@@ -1,10 +1,16 @@
 #include "mainwindow.h"
 #include "./ui_mainwindow.h"
 #include "InputManager.h"
+#include "actionscript.h"
 #include "changehotkeydialog.h"
-#include "qscreen.h"
+#include "runstats.h"
+#include "screenlayout.h"
+#include "useroverride.h"
 #include <Windows.h>
 #include <QButtonGroup>
+#include <QDateTime>
+#include <QFileDialog>
+#include <QFileInfo>
 #include <QProcess>
 #include <QPoint>
 #include <QLocalSocket>
@@ -42,13 +48,46 @@ MainWindow::MainWindow(QWidget *parent)
     inputManager->setMainWindowInstance(this);
 
     connect(inputManager, &InputManager::returnCursorPosition, this, &MainWindow::mouseLocationUpdate);
+    connect(inputManager, &InputManager::returnCursorPreview, this, &MainWindow::mouseLocationPreview);
+    connect(inputManager, &InputManager::cursorLocationCancelled, this, &MainWindow::mouseLocationCancelled);
     connect(this, &MainWindow::startCursorPositionGrab, inputManager, &InputManager::getCursorPosition);
     connect(this, &MainWindow::updateApplicationRunProcess, inputManager, &InputManager::updateUserData);
     connect(this, &MainWindow::stopApplication, inputManager, &InputManager::updateProcessState);
+    connect(this, &MainWindow::targetTemplateSelected, inputManager, &InputManager::updateTargetTemplate);
+    connect(this, &MainWindow::captureRateChanged, inputManager, &InputManager::updateCaptureRate);
+    connect(this, &MainWindow::movementOptionsChanged, inputManager, &InputManager::updateMovementOptions);
+    connect(this, &MainWindow::scriptOptionsChanged, inputManager, &InputManager::updateScript);
+    connect(this, &MainWindow::scheduleChanged, inputManager, &InputManager::updateSchedule);
+    connect(this, &MainWindow::runConfigChanged, inputManager, &InputManager::updateRunConfig);
+    connect(this, &MainWindow::patternOptionsChanged, inputManager, &InputManager::updatePatternOptions);
+    connect(this, &MainWindow::areaShapeChanged, inputManager, &InputManager::updateAreaShape);
+    connect(this, &MainWindow::keyboardOptionsChanged, inputManager, &InputManager::updateKeyboardOptions);
+    connect(this, &MainWindow::userOverrideOptionsChanged, inputManager, &InputManager::updateUserOverrideOptions);
+    connect(this, &MainWindow::windowTargetChanged, inputManager, &InputManager::updateWindowTarget);
+    for (QLineEdit *lineEdit : {ui->LineEdit_WindowTitle, ui->LineEdit_WindowClass})
+    {
+        connect(lineEdit, &QLineEdit::textEdited, this, [this]()
+        {
+            pickedWindow = 0;
+        });
+    }
+    for (QLineEdit *lineEdit : {ui->LineEdit_Minutes, ui->LineEdit_Seconds, ui->LineEdit_Milliseconds, ui->LineEdit_Area})
+    {
+        connect(lineEdit, &QLineEdit::editingFinished, this, &MainWindow::publishRunConfig);
+    }
+    connect(ui->TimeEdit_From, &QTimeEdit::editingFinished, this, &MainWindow::publishRunConfig);
+    connect(ui->TimeEdit_Till, &QTimeEdit::editingFinished, this, &MainWindow::publishRunConfig);
     radioButtonGroupSetUp();
 
+    ui->DateTimeEdit_StartAt->setDateTime(QDateTime::currentDateTime());
+
     ui->PushButton_Stop->setEnabled(false);
     on_PushButton_Load_clicked();
+
+    statsClock.start();
+    statsTimer.setInterval(statsRefreshInterval);
+    connect(&statsTimer, &QTimer::timeout, this, &MainWindow::refreshStats);
+    statsTimer.start();
 }
 
 MainWindow::~MainWindow()
@@ -110,6 +149,112 @@ int MainWindow::getFixedTime()
     }
 }
 
+/**
+ * @brief Reads the click interval from the widgets of the selected interval mode.
+ *
+ * @param fromTime Receives the fixed time, or the lower bound of the random interval, in milliseconds.
+ * @param tillTime Receives the width of the random interval in milliseconds; 0 for a fixed interval.
+ */
+
+void MainWindow::getClickInterval(int& fromTime, int& tillTime)
+{
+    if(clickingIntervalData.checkedButton()->objectName().toLower() == "radiobutton_randomclickinterval")
+    {
+        QTime fromQTime = QTime::fromString(ui->TimeEdit_From->text(),"mm:ss:zzz");
+        QTime tillQTime = QTime::fromString(ui->TimeEdit_Till->text(),"mm:ss:zzz");
+        fromTime = fromQTime.msecsSinceStartOfDay();
+        tillTime = fromQTime.msecsTo(tillQTime);
+    } else
+    {
+        fromTime = getFixedTime();
+        tillTime = 0;
+    }
+}
+
+/**
+ * @brief Publishes the click interval, location and area, so a running job picks up edits without restarting.
+ */
+
+void MainWindow::publishRunConfig()
+{
+    if (clickingIntervalData.checkedButton() == nullptr)
+    {
+        return;
+    }
+
+    int fromTime, tillTime;
+    getClickInterval(fromTime, tillTime);
+    QPoint point(ui->LineEdit_X->text().toInt(),ui->LineEdit_Y->text().toInt());
+    emit runConfigChanged(fromTime, tillTime, point, ui->LineEdit_Area->text().toInt());
+}
+
+/**
+ * @brief Updates the statistics tab from the engine's live statistics.
+ *
+ * @details Polled at statsRefreshInterval, so the dashboard costs the same however fast the job clicks. The click
+ * rate is measured over windows of at least a second to keep the display steady, and the heatmap is only redrawn
+ * when new click locations arrived.
+ */
+
+void MainWindow::refreshStats()
+{
+    RunStats *runStats = RunStats::getInstance();
+    RunStats::Snapshot stats;
+    runStats->read(stats);
+
+    if (stats.generation != statsGeneration)
+    {
+        statsGeneration = stats.generation;
+        statsWindowClicks = 0;
+        statsWindowStart = statsClock.elapsed();
+        clicksPerSecond = 0.0;
+        ui->Widget_Heatmap->reset(ScreenLayout::getInstance()->snapshot()->virtualDesktop);
+    }
+
+    QPoint point;
+    for (quint32 i = 0; i < RunStats::clickCapacity && runStats->popClick(point); ++i)
+    {
+        ui->Widget_Heatmap->addClick(point);
+    }
+    ui->Widget_Heatmap->refresh();
+
+    qint64 now = statsClock.elapsed();
+    if (!stats.isRunning)
+    {
+        clicksPerSecond = 0.0;
+        statsWindowClicks = stats.clicks;
+        statsWindowStart = now;
+    } else if (now - statsWindowStart >= 1000)
+    {
+        clicksPerSecond = (stats.clicks - statsWindowClicks) * 1000.0 / (now - statsWindowStart);
+        statsWindowClicks = stats.clicks;
+        statsWindowStart = now;
+    }
+    QString rate = QString("%1 CPS").arg(clicksPerSecond, 0, 'f', 1);
+    if (stats.isRunning && UserOverride::getInstance()->isPaused())
+    {
+        rate += " (paused for user)";
+    }
+    ui->Label_StatsRate->setText(rate);
+
+    QString progress = QString("clicks %1, repetitions %2").arg(stats.clicks).arg(stats.iterations);
+    if (stats.repetitions >= static_cast<quint64>(ActionScript::infiniteRepetitions))
+    {
+        progress += " / unlimited";
+    } else if (stats.repetitions > 0)
+    {
+        progress += QString(" / %1").arg(stats.repetitions);
+    }
+    ui->Label_StatsProgress->setText(progress);
+
+    auto toMilliseconds = [](qint64 nanoseconds) { return QString::number(nanoseconds / 1e6, 'f', 2); };
+    ui->Label_StatsTiming->setText(QString("late p50 %1 / p90 %2 / p99 %3 / max %4 ms")
+                                       .arg(toMilliseconds(RunStats::percentile(stats, 0.50)),
+                                            toMilliseconds(RunStats::percentile(stats, 0.90)),
+                                            toMilliseconds(RunStats::percentile(stats, 0.99)),
+                                            toMilliseconds(stats.latenessMax)));
+}
+
 /**
  * @brief Filters and handles specific events for LineEdit and TimeEdit widgets.
  *
@@ -184,10 +329,40 @@ void MainWindow::connectValidatorForLineEdit()
     QIntValidator *validatorRepeat = new QIntValidator(0, 10000, this);
     ui->LineEdit_RepeatTimes->setValidator(validatorRepeat);
 
-    int screenHeight = QApplication::primaryScreen()->geometry().height();
+    int screenHeight = ScreenLayout::getInstance()->snapshot()->virtualDesktop.height();
     int maxHeight = screenHeight / 2;
     QIntValidator *validatorArea = new QIntValidator(1, maxHeight, this);
     ui->LineEdit_Area->setValidator(validatorArea);
+
+    QIntValidator *validatorCaptureRate = new QIntValidator(1, 240, this);
+    ui->LineEdit_CaptureRate->setValidator(validatorCaptureRate);
+
+    QIntValidator *validatorMoveDuration = new QIntValidator(5, 10000, this);
+    ui->LineEdit_MoveDuration->setValidator(validatorMoveDuration);
+
+    QIntValidator *validatorUserIdleTime = new QIntValidator(0, 60000, this);
+    ui->LineEdit_UserIdleTime->setValidator(validatorUserIdleTime);
+
+    QIntValidator *validatorRunDuration = new QIntValidator(0, 86400, this);
+    ui->LineEdit_RunDuration->setValidator(validatorRunDuration);
+
+    QIntValidator *validatorPatternSide = new QIntValidator(1, 1000, this);
+    ui->LineEdit_PatternColumns->setValidator(validatorPatternSide);
+    ui->LineEdit_PatternRows->setValidator(validatorPatternSide);
+
+    QIntValidator *validatorPatternSpacing = new QIntValidator(1, 1000, this);
+    ui->LineEdit_PatternSpacing->setValidator(validatorPatternSpacing);
+
+    QIntValidator *validatorPatternCount = new QIntValidator(1, 1000000, this);
+    ui->LineEdit_PatternCount->setValidator(validatorPatternCount);
+
+    QIntValidator *validatorAreaSize = new QIntValidator(1, 100000, this);
+    ui->LineEdit_AreaWidth->setValidator(validatorAreaSize);
+    ui->LineEdit_AreaHeight->setValidator(validatorAreaSize);
+
+    QIntValidator *validatorKeyTiming = new QIntValidator(0, 60000, this);
+    ui->LineEdit_HoldDuration->setValidator(validatorKeyTiming);
+    ui->LineEdit_CharacterDelay->setValidator(validatorKeyTiming);
 }
 
 /**
@@ -220,9 +395,9 @@ void MainWindow::setUpButtonGroup(const QString buttonGroupName, QButtonGroup* b
 void MainWindow::radioButtonGroupSetUp()
 {
     setUpButtonGroup("ClickingInterval", &clickingIntervalData, ui->RadioButton_FixedClickInterval, ui->RadioButton_RandomClickInterval);
-    setUpButtonGroup("PressType", &pressTypeData, ui->RadioButton_SinglePress, ui->RadioButton_DoublePress);
+    setUpButtonGroup("PressType", &pressTypeData, ui->RadioButton_SinglePress, ui->RadioButton_DoublePress, ui->RadioButton_DragPress);
     setUpButtonGroup("RepetitionMode", &repeatClickData,ui->RadioButton_RepeatTimes,ui->RadioButton_InfiniteClick);
-    setUpButtonGroup("LocationOption", &locationOptionsData,ui->RadioButton_LocationAtCursor,ui->RadioButton_ChoosenLocation,ui->RadioButton_RandomWithinArea);
+    setUpButtonGroup("LocationOption", &locationOptionsData,ui->RadioButton_LocationAtCursor,ui->RadioButton_ChoosenLocation,ui->RadioButton_RandomWithinArea,ui->RadioButton_TargetImage,ui->RadioButton_WatchRegion,ui->RadioButton_PatternSweep);
 
     loadSelectedRadioButtons();
 }
@@ -274,6 +449,7 @@ void MainWindow::updateInputManager(QAbstractButton* button)
     if (clickingIntervalData.buttons().contains(button))
     {
         handleButtonUpdate(button, "ClickingInterval", &clickingIntervalData);
+        publishRunConfig();
     } else if (pressTypeData.buttons().contains(button))
     {
         handleButtonUpdate(button, "PressType", &pressTypeData);
@@ -300,10 +476,26 @@ void MainWindow::updateButtonsText(const QString& newHotkey)
 
 /**
  * @brief Triggers the capturing of the current cursor position.
+ *
+ * @details The next left click anywhere on the screen sets the location, a right click cancels. Until then
+ * the button shows the hovered coordinates.
  */
 
 void MainWindow::on_PushButton_SetLocation_clicked()
 {
+    isPickingWindow = false;
+    ui->PushButton_SetLocation->setText("Click the location");
+    emit startCursorPositionGrab();
+}
+
+/**
+ * @brief Lets the user pick the target window with the next left click anywhere on the screen.
+ */
+
+void MainWindow::on_PushButton_PickWindow_clicked()
+{
+    isPickingWindow = true;
+    ui->Label_WindowStatus->setText("click the window");
     emit startCursorPositionGrab();
 }
 
@@ -316,8 +508,228 @@ void MainWindow::on_PushButton_SetLocation_clicked()
 
 void MainWindow::mouseLocationUpdate(int x, int y)
 {
+    if (isPickingWindow)
+    {
+        isPickingWindow = false;
+        HWND window = GetAncestor(WindowFromPoint(POINT{x, y}), GA_ROOT);
+        if (window == nullptr)
+        {
+            ui->Label_WindowStatus->setText("no window there");
+            return;
+        }
+
+        wchar_t text[256] = {};
+        GetWindowTextW(window, text, 256);
+        ui->LineEdit_WindowTitle->setText(QString::fromWCharArray(text));
+        GetClassNameW(window, text, 256);
+        ui->LineEdit_WindowClass->setText(QString::fromWCharArray(text));
+        pickedWindow = static_cast<qint64>(reinterpret_cast<quintptr>(window));
+        ui->Label_WindowStatus->setText("picked");
+        return;
+    }
+
     ui->LineEdit_X ->setText(QString::number(x));
     ui->LineEdit_Y ->setText(QString::number(y));
+    ui->PushButton_SetLocation->setText("Choose location");
+    publishRunConfig();
+}
+
+/**
+ * @brief Shows the coordinates hovered while a location is being picked.
+ *
+ * @param x The x-coordinate of the mouse cursor.
+ * @param y The y-coordinate of the mouse cursor.
+ */
+
+void MainWindow::mouseLocationPreview(int x, int y)
+{
+    if (isPickingWindow)
+    {
+        return;
+    }
+    ui->PushButton_SetLocation->setText(QString("%1, %2").arg(x).arg(y));
+}
+
+/**
+ * @brief Restores the location button after picking was cancelled.
+ */
+
+void MainWindow::mouseLocationCancelled()
+{
+    if (isPickingWindow)
+    {
+        isPickingWindow = false;
+        ui->Label_WindowStatus->setText("-");
+        return;
+    }
+    ui->PushButton_SetLocation->setText("Choose location");
+}
+
+/**
+ * @brief Lets the user pick the template image searched for in the target image location mode.
+ */
+
+void MainWindow::on_PushButton_LoadTemplate_clicked()
+{
+    QString imagePath = QFileDialog::getOpenFileName(this, tr("Choose template image"), templatePath, tr("Images (*.png *.bmp *.jpg)"));
+    if (!imagePath.isEmpty())
+    {
+        setTemplatePath(imagePath);
+    }
+}
+
+/**
+ * @brief Lets the user choose the mask image of the mask area shape.
+ */
+
+void MainWindow::on_PushButton_LoadMask_clicked()
+{
+    QString imagePath = QFileDialog::getOpenFileName(this, tr("Choose area mask"), maskPath, tr("Images (*.png *.bmp *.jpg)"));
+    if (!imagePath.isEmpty())
+    {
+        setMaskPath(imagePath);
+    }
+}
+
+/**
+ * @brief Stores the mask path and shows its file name; the mask is loaded when the application starts.
+ *
+ * @param imagePath Path to the mask image file.
+ */
+
+void MainWindow::setMaskPath(const QString& imagePath)
+{
+    maskPath = imagePath;
+    ui->Label_MaskPath->setText(QFileInfo(imagePath).fileName());
+}
+
+/**
+ * @brief Stores the template path, shows its file name and passes it on to the InputManager.
+ *
+ * @param imagePath Path to the template image file.
+ */
+
+void MainWindow::setTemplatePath(const QString& imagePath)
+{
+    templatePath = imagePath;
+    ui->Label_TemplatePath->setText(QFileInfo(imagePath).fileName());
+    emit targetTemplateSelected(imagePath);
+}
+
+/**
+ * @brief Shows the outcome of the last template search.
+ *
+ * @param found Whether the template was found on screen.
+ * @param score The normalized cross-correlation score of the best match.
+ * @param searchTime Duration of the search in milliseconds.
+ */
+
+void MainWindow::updateTargetSearchResult(bool found, double score, double searchTime)
+{
+    ui->Label_MatchResult->setText(QString("%1 %2 (%3 ms)")
+                                       .arg(found ? "match" : "no match")
+                                       .arg(score, 0, 'f', 2)
+                                       .arg(searchTime, 0, 'f', 1));
+}
+
+/**
+ * @brief Shows the latency of the last region change reaction.
+ *
+ * @param latency Time from the frame grab to the injected click in milliseconds.
+ */
+
+void MainWindow::updateReactionLatency(double latency)
+{
+    ui->Label_ReactionLatency->setText(QString("reaction %1 ms").arg(latency, 0, 'f', 2));
+}
+
+/**
+ * @brief Shows the capture rate and the average grab cost of the shared screen capture.
+ *
+ * @param captureRate Frames captured per second.
+ * @param frameCost Average cost of one grab in milliseconds.
+ */
+
+void MainWindow::updateCaptureMetrics(double captureRate, double frameCost)
+{
+    ui->Label_CaptureStats->setText(QString("%1 fps, %2 ms/frame").arg(captureRate, 0, 'f', 1).arg(frameCost, 0, 'f', 2));
+}
+
+/**
+ * @brief Shows how late the click scheduler woke up during the last second.
+ *
+ * @param meanLateness Mean lateness in milliseconds.
+ * @param maxLateness Maximum lateness in milliseconds.
+ * @param injectionLatency Smoothed time from injecting input until the system delivers it, in milliseconds.
+ */
+
+void MainWindow::updateTimingStats(double meanLateness, double maxLateness, double injectionLatency)
+{
+    ui->Label_TimingStats->setText(QString("late %1 ms avg, %2 ms max, delivery %3 ms")
+                                       .arg(meanLateness, 0, 'f', 2)
+                                       .arg(maxLateness, 0, 'f', 2)
+                                       .arg(injectionLatency, 0, 'f', 2));
+}
+
+/**
+ * @brief Shows how quickly the last job stopped after the stop request.
+ *
+ * @param stopLatency Time until the engine had stopped in milliseconds.
+ * @param injectionOvershoot Time by which the last injection that was already under way ended after the request, in milliseconds.
+ */
+
+void MainWindow::updateStopLatency(double stopLatency, double injectionOvershoot)
+{
+    ui->Label_TimingStats->setText(QString("stopped in %1 ms, last input +%2 ms").arg(stopLatency, 0, 'f', 3).arg(injectionOvershoot, 0, 'f', 3));
+}
+
+/**
+ * @brief Shows how far the scheduled start or stop landed from its wall-clock time.
+ *
+ * @param event "start" or "stop".
+ * @param error Time between the scheduled and the achieved moment in milliseconds.
+ */
+
+void MainWindow::updateScheduleError(const QString& event, double error)
+{
+    ui->Label_ScheduleError->setText(QString("%1 %2 ms off").arg(event).arg(error, 0, 'f', 3));
+}
+
+/**
+ * @brief Shows which window the running job clicks into.
+ *
+ * @param found Whether the target window was found when the job started.
+ * @param description The window title and client area, or why it was not found.
+ */
+
+void MainWindow::updateWindowStatus(bool found, const QString& description)
+{
+    ui->Label_WindowStatus->setText(description);
+    if (!found)
+    {
+        ui->TabWidget_Advanced->setCurrentWidget(ui->Tab_Window);
+    }
+}
+
+/**
+ * @brief Shows why the action script could not be compiled.
+ *
+ * @param message The compiler message including the line number.
+ */
+
+void MainWindow::showScriptError(const QString& message)
+{
+    ui->Label_ScriptStatus->setText(message);
+    ui->TabWidget_Advanced->setCurrentWidget(ui->Tab_Script);
+}
+
+/**
+ * @brief Passes the edited capture rate on to the InputManager.
+ */
+
+void MainWindow::on_LineEdit_CaptureRate_editingFinished()
+{
+    emit captureRateChanged(ui->LineEdit_CaptureRate->text().toInt());
 }
 
 /**
@@ -341,22 +753,36 @@ void MainWindow::startApplication()
     loadSelectedRadioButtons();
 
     int fromTime, tillTime;
-    if(clickingIntervalData.checkedButton()->objectName().toLower() == "radiobutton_randomclickinterval")
-    {
-        QTime fromQTime = QTime::fromString(ui->TimeEdit_From->text(),"mm:ss:zzz");
-        QTime tillQTime = QTime::fromString(ui->TimeEdit_Till->text(),"mm:ss:zzz");
-        fromTime = fromQTime.msecsSinceStartOfDay();
-        tillTime = fromQTime.msecsTo(tillQTime);
-    } else
-    {
-        fromTime = getFixedTime();
-        tillTime = 0;
-    }
+    getClickInterval(fromTime, tillTime);
 
     int repeatTimes = ui->LineEdit_RepeatTimes->text().toInt();
     QPoint point(ui->LineEdit_X->text().toInt(),ui->LineEdit_Y->text().toInt());
     int area = ui->LineEdit_Area->text().toInt();
 
+    emit movementOptionsChanged(ui->CheckBox_CurvedMovement->isChecked(), ui->LineEdit_MoveDuration->text().toInt());
+    emit userOverrideOptionsChanged(ui->CheckBox_PauseOnUserInput->isChecked(), ui->LineEdit_UserIdleTime->text().toInt());
+    emit windowTargetChanged(ui->CheckBox_WindowTarget->isChecked(), ui->LineEdit_WindowTitle->text(), ui->LineEdit_WindowClass->text(), pickedWindow);
+    ui->Label_ScriptStatus->setText("-");
+    emit scriptOptionsChanged(ui->CheckBox_RunScript->isChecked(), ui->PlainTextEdit_Script->toPlainText());
+    qint64 startAt = ui->CheckBox_ScheduledStart->isChecked() ? ui->DateTimeEdit_StartAt->dateTime().toMSecsSinceEpoch() : 0;
+    emit scheduleChanged(startAt, ui->LineEdit_RunDuration->text().toInt() * 1000);
+    emit patternOptionsChanged(ui->ComboBox_PatternType->currentIndex(), ui->LineEdit_PatternColumns->text().toInt(), ui->LineEdit_PatternRows->text().toInt(),
+                               ui->LineEdit_PatternSpacing->text().toInt(), ui->LineEdit_PatternCount->text().toInt(), ui->LineEdit_Polyline->text());
+    emit areaShapeChanged(ui->ComboBox_AreaShape->currentIndex(), ui->LineEdit_AreaWidth->text().toInt(), ui->LineEdit_AreaHeight->text().toInt(),
+                          ui->LineEdit_AreaPolygon->text(), maskPath);
+
+    qint32 virtualKey = 0;
+    if (ActionScript::parseKey(ui->LineEdit_Key->text().trimmed().toLower(), virtualKey))
+    {
+        ui->Label_KeyboardStatus->setText("-");
+    } else
+    {
+        virtualKey = 0x20;
+        ui->Label_KeyboardStatus->setText("unknown key, using space");
+    }
+    const QChar actionTypes[] = {'m', 'p', 'h', 't'};
+    emit keyboardOptionsChanged(actionTypes[qBound(0, ui->ComboBox_ActionType->currentIndex(), 3)], virtualKey, ui->LineEdit_HoldDuration->text().toInt(),
+                                ui->LineEdit_TypeText->text(), ui->LineEdit_CharacterDelay->text().toInt());
     emit updateApplicationRunProcess(fromTime,tillTime,repeatTimes,point,area);
 }
 
@@ -395,6 +821,34 @@ void MainWindow::on_PushButton_Save_clicked()
     settings.setValue("LineEdit_Milliseconds", ui->LineEdit_Milliseconds->text());
     settings.setValue("LineEdit_X", ui->LineEdit_X->text());
     settings.setValue("LineEdit_Y", ui->LineEdit_Y->text());
+    settings.setValue("LineEdit_CaptureRate", ui->LineEdit_CaptureRate->text());
+    settings.setValue("LineEdit_MoveDuration", ui->LineEdit_MoveDuration->text());
+    settings.setValue("CheckBox_CurvedMovement", ui->CheckBox_CurvedMovement->isChecked());
+    settings.setValue("CheckBox_PauseOnUserInput", ui->CheckBox_PauseOnUserInput->isChecked());
+    settings.setValue("LineEdit_UserIdleTime", ui->LineEdit_UserIdleTime->text());
+    settings.setValue("CheckBox_WindowTarget", ui->CheckBox_WindowTarget->isChecked());
+    settings.setValue("LineEdit_WindowTitle", ui->LineEdit_WindowTitle->text());
+    settings.setValue("LineEdit_WindowClass", ui->LineEdit_WindowClass->text());
+    settings.setValue("CheckBox_RunScript", ui->CheckBox_RunScript->isChecked());
+    settings.setValue("PlainTextEdit_Script", ui->PlainTextEdit_Script->toPlainText());
+    settings.setValue("CheckBox_ScheduledStart", ui->CheckBox_ScheduledStart->isChecked());
+    settings.setValue("DateTimeEdit_StartAt", ui->DateTimeEdit_StartAt->dateTime().toString(Qt::ISODateWithMs));
+    settings.setValue("LineEdit_RunDuration", ui->LineEdit_RunDuration->text());
+    settings.setValue("ComboBox_PatternType", ui->ComboBox_PatternType->currentIndex());
+    settings.setValue("LineEdit_PatternColumns", ui->LineEdit_PatternColumns->text());
+    settings.setValue("LineEdit_PatternRows", ui->LineEdit_PatternRows->text());
+    settings.setValue("LineEdit_PatternSpacing", ui->LineEdit_PatternSpacing->text());
+    settings.setValue("LineEdit_PatternCount", ui->LineEdit_PatternCount->text());
+    settings.setValue("LineEdit_Polyline", ui->LineEdit_Polyline->text());
+    settings.setValue("ComboBox_AreaShape", ui->ComboBox_AreaShape->currentIndex());
+    settings.setValue("LineEdit_AreaWidth", ui->LineEdit_AreaWidth->text());
+    settings.setValue("LineEdit_AreaHeight", ui->LineEdit_AreaHeight->text());
+    settings.setValue("LineEdit_AreaPolygon", ui->LineEdit_AreaPolygon->text());
+    settings.setValue("ComboBox_ActionType", ui->ComboBox_ActionType->currentIndex());
+    settings.setValue("LineEdit_Key", ui->LineEdit_Key->text());
+    settings.setValue("LineEdit_HoldDuration", ui->LineEdit_HoldDuration->text());
+    settings.setValue("LineEdit_TypeText", ui->LineEdit_TypeText->text());
+    settings.setValue("LineEdit_CharacterDelay", ui->LineEdit_CharacterDelay->text());
 
     settings.setValue("TimeEdit_From", ui->TimeEdit_From->time().toString("mm:ss:zzz"));
     settings.setValue("TimeEdit_Till", ui->TimeEdit_Till->time().toString("mm:ss:zzz"));
@@ -408,6 +862,13 @@ void MainWindow::on_PushButton_Save_clicked()
     settings.setValue("RadioButton_RandomWithinArea", ui->RadioButton_RandomWithinArea->isChecked());
     settings.setValue("RadioButton_RepeatTimes", ui->RadioButton_RepeatTimes->isChecked());
     settings.setValue("RadioButton_SinglePress", ui->RadioButton_SinglePress->isChecked());
+    settings.setValue("RadioButton_TargetImage", ui->RadioButton_TargetImage->isChecked());
+    settings.setValue("RadioButton_WatchRegion", ui->RadioButton_WatchRegion->isChecked());
+    settings.setValue("RadioButton_PatternSweep", ui->RadioButton_PatternSweep->isChecked());
+    settings.setValue("RadioButton_DragPress", ui->RadioButton_DragPress->isChecked());
+
+    settings.setValue("TemplatePath", templatePath);
+    settings.setValue("MaskPath", maskPath);
 
     settings.setValue("vkCode", InputManager::getInstance()->getUserHotkey());
 }
@@ -430,6 +891,40 @@ void MainWindow::on_PushButton_Load_clicked()
         ui->LineEdit_Milliseconds->setText(settings.value("LineEdit_Milliseconds").toString());
         ui->LineEdit_X->setText(settings.value("LineEdit_X").toString());
         ui->LineEdit_Y->setText(settings.value("LineEdit_Y").toString());
+        ui->LineEdit_CaptureRate->setText(settings.value("LineEdit_CaptureRate", "60").toString());
+        on_LineEdit_CaptureRate_editingFinished();
+        ui->LineEdit_MoveDuration->setText(settings.value("LineEdit_MoveDuration", "200").toString());
+        ui->CheckBox_CurvedMovement->setChecked(settings.value("CheckBox_CurvedMovement").toBool());
+        ui->CheckBox_PauseOnUserInput->setChecked(settings.value("CheckBox_PauseOnUserInput").toBool());
+        ui->LineEdit_UserIdleTime->setText(settings.value("LineEdit_UserIdleTime", "1000").toString());
+        ui->CheckBox_WindowTarget->setChecked(settings.value("CheckBox_WindowTarget").toBool());
+        ui->LineEdit_WindowTitle->setText(settings.value("LineEdit_WindowTitle").toString());
+        ui->LineEdit_WindowClass->setText(settings.value("LineEdit_WindowClass").toString());
+        pickedWindow = 0;
+        ui->CheckBox_RunScript->setChecked(settings.value("CheckBox_RunScript").toBool());
+        ui->PlainTextEdit_Script->setPlainText(settings.value("PlainTextEdit_Script").toString());
+        ui->CheckBox_ScheduledStart->setChecked(settings.value("CheckBox_ScheduledStart").toBool());
+        ui->LineEdit_RunDuration->setText(settings.value("LineEdit_RunDuration", "0").toString());
+        ui->ComboBox_PatternType->setCurrentIndex(settings.value("ComboBox_PatternType", 0).toInt());
+        ui->LineEdit_PatternColumns->setText(settings.value("LineEdit_PatternColumns", "5").toString());
+        ui->LineEdit_PatternRows->setText(settings.value("LineEdit_PatternRows", "5").toString());
+        ui->LineEdit_PatternSpacing->setText(settings.value("LineEdit_PatternSpacing", "20").toString());
+        ui->LineEdit_PatternCount->setText(settings.value("LineEdit_PatternCount", "25").toString());
+        ui->LineEdit_Polyline->setText(settings.value("LineEdit_Polyline").toString());
+        ui->ComboBox_AreaShape->setCurrentIndex(settings.value("ComboBox_AreaShape", 0).toInt());
+        ui->LineEdit_AreaWidth->setText(settings.value("LineEdit_AreaWidth", "100").toString());
+        ui->LineEdit_AreaHeight->setText(settings.value("LineEdit_AreaHeight", "100").toString());
+        ui->LineEdit_AreaPolygon->setText(settings.value("LineEdit_AreaPolygon").toString());
+        ui->ComboBox_ActionType->setCurrentIndex(settings.value("ComboBox_ActionType", 0).toInt());
+        ui->LineEdit_Key->setText(settings.value("LineEdit_Key", "space").toString());
+        ui->LineEdit_HoldDuration->setText(settings.value("LineEdit_HoldDuration", "100").toString());
+        ui->LineEdit_TypeText->setText(settings.value("LineEdit_TypeText").toString());
+        ui->LineEdit_CharacterDelay->setText(settings.value("LineEdit_CharacterDelay", "0").toString());
+        QDateTime startAt = QDateTime::fromString(settings.value("DateTimeEdit_StartAt").toString(), Qt::ISODateWithMs);
+        if (startAt.isValid())
+        {
+            ui->DateTimeEdit_StartAt->setDateTime(startAt);
+        }
 
         ui->TimeEdit_From->setTime(QTime::fromString(settings.value("TimeEdit_From").toString(), "mm:ss:zzz"));
         ui->TimeEdit_Till->setTime(QTime::fromString(settings.value("TimeEdit_Till").toString(), "mm:ss:zzz"));
@@ -443,6 +938,19 @@ void MainWindow::on_PushButton_Load_clicked()
         ui->RadioButton_RandomWithinArea->setChecked(settings.value("RadioButton_RandomWithinArea").toBool());
         ui->RadioButton_RepeatTimes->setChecked(settings.value("RadioButton_RepeatTimes").toBool());
         ui->RadioButton_SinglePress->setChecked(settings.value("RadioButton_SinglePress").toBool());
+        ui->RadioButton_TargetImage->setChecked(settings.value("RadioButton_TargetImage").toBool());
+        ui->RadioButton_WatchRegion->setChecked(settings.value("RadioButton_WatchRegion").toBool());
+        ui->RadioButton_PatternSweep->setChecked(settings.value("RadioButton_PatternSweep").toBool());
+        ui->RadioButton_DragPress->setChecked(settings.value("RadioButton_DragPress").toBool());
+
+        if (!settings.value("TemplatePath").toString().isEmpty())
+        {
+            setTemplatePath(settings.value("TemplatePath").toString());
+        }
+        if (!settings.value("MaskPath").toString().isEmpty())
+        {
+            setMaskPath(settings.value("MaskPath").toString());
+        }
 
         InputManager::getInstance()->updateUserHotkey(settings.value("vkCode").toString());
     }
@@ -450,36 +958,61 @@ void MainWindow::on_PushButton_Load_clicked()
 
 /**
  * @brief Enables or disables multiple UI elements based on the given boolean.
+ *
+ * @details The click interval, location and area stay editable while a job runs; publishRunConfig() hands
+ * their changes to the running job.
  */
 
 void MainWindow::blockUIElements(bool isBlocked)
 {
-    ui->LineEdit_Area->setEnabled(isBlocked);
     ui->LineEdit_RepeatTimes->setEnabled(isBlocked);
-    ui->LineEdit_Minutes->setEnabled(isBlocked);
-    ui->LineEdit_Seconds->setEnabled(isBlocked);
-    ui->LineEdit_Milliseconds->setEnabled(isBlocked);
-    ui->LineEdit_X->setEnabled(isBlocked);
-    ui->LineEdit_Y->setEnabled(isBlocked);
-
-    ui->TimeEdit_From->setEnabled(isBlocked);
-    ui->TimeEdit_Till->setEnabled(isBlocked);
 
     ui->PushButton_Save->setEnabled(isBlocked);
     ui->PushButton_Load->setEnabled(isBlocked);
     ui->PushButton_SetHotkey->setEnabled(isBlocked);
-    ui->PushButton_SetLocation->setEnabled(isBlocked);
     ui->PushButton_Start->setEnabled(isBlocked);
+    ui->PushButton_LoadTemplate->setEnabled(isBlocked);
 
     ui->RadioButton_ChoosenLocation->setEnabled(isBlocked);
     ui->RadioButton_DoublePress->setEnabled(isBlocked);
-    ui->RadioButton_FixedClickInterval->setEnabled(isBlocked);
     ui->RadioButton_InfiniteClick->setEnabled(isBlocked);
     ui->RadioButton_LocationAtCursor->setEnabled(isBlocked);
-    ui->RadioButton_RandomClickInterval->setEnabled(isBlocked);
     ui->RadioButton_RandomWithinArea->setEnabled(isBlocked);
     ui->RadioButton_RepeatTimes->setEnabled(isBlocked);
     ui->RadioButton_SinglePress->setEnabled(isBlocked);
+    ui->RadioButton_TargetImage->setEnabled(isBlocked);
+    ui->RadioButton_WatchRegion->setEnabled(isBlocked);
+    ui->RadioButton_PatternSweep->setEnabled(isBlocked);
+    ui->RadioButton_DragPress->setEnabled(isBlocked);
+    ui->CheckBox_CurvedMovement->setEnabled(isBlocked);
+    ui->LineEdit_MoveDuration->setEnabled(isBlocked);
+    ui->CheckBox_PauseOnUserInput->setEnabled(isBlocked);
+    ui->LineEdit_UserIdleTime->setEnabled(isBlocked);
+    ui->CheckBox_WindowTarget->setEnabled(isBlocked);
+    ui->LineEdit_WindowTitle->setEnabled(isBlocked);
+    ui->LineEdit_WindowClass->setEnabled(isBlocked);
+    ui->PushButton_PickWindow->setEnabled(isBlocked);
+    ui->CheckBox_RunScript->setEnabled(isBlocked);
+    ui->PlainTextEdit_Script->setReadOnly(!isBlocked);
+    ui->CheckBox_ScheduledStart->setEnabled(isBlocked);
+    ui->DateTimeEdit_StartAt->setEnabled(isBlocked);
+    ui->LineEdit_RunDuration->setEnabled(isBlocked);
+    ui->ComboBox_PatternType->setEnabled(isBlocked);
+    ui->LineEdit_PatternColumns->setEnabled(isBlocked);
+    ui->LineEdit_PatternRows->setEnabled(isBlocked);
+    ui->LineEdit_PatternSpacing->setEnabled(isBlocked);
+    ui->LineEdit_PatternCount->setEnabled(isBlocked);
+    ui->LineEdit_Polyline->setEnabled(isBlocked);
+    ui->ComboBox_AreaShape->setEnabled(isBlocked);
+    ui->LineEdit_AreaWidth->setEnabled(isBlocked);
+    ui->LineEdit_AreaHeight->setEnabled(isBlocked);
+    ui->LineEdit_AreaPolygon->setEnabled(isBlocked);
+    ui->PushButton_LoadMask->setEnabled(isBlocked);
+    ui->ComboBox_ActionType->setEnabled(isBlocked);
+    ui->LineEdit_Key->setEnabled(isBlocked);
+    ui->LineEdit_HoldDuration->setEnabled(isBlocked);
+    ui->LineEdit_TypeText->setEnabled(isBlocked);
+    ui->LineEdit_CharacterDelay->setEnabled(isBlocked);
 
     ui->PushButton_Stop->setEnabled(!isBlocked);
 }
@@ -5,6 +5,8 @@
 #include <QLocalSocket>
 #include <QMainWindow>
 #include <QButtonGroup>
+#include <QElapsedTimer>
+#include <QTimer>
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -34,12 +36,36 @@ private:
     QVector<QLineEdit *> lineEditList;
     void loadSelectedRadioButtons();
     int getFixedTime();
+    void getClickInterval(int& fromTime, int& tillTime);
+    void setTemplatePath(const QString& imagePath);
+    QString templatePath;
+    void setMaskPath(const QString& imagePath);
+    QString maskPath;
+    bool isPickingWindow = false;
+    qint64 pickedWindow = 0;
+    static constexpr int statsRefreshInterval = 100;
+    QTimer statsTimer;
+    QElapsedTimer statsClock;
+    quint64 statsGeneration = 0;
+    quint64 statsWindowClicks = 0;
+    qint64 statsWindowStart = 0;
+    double clicksPerSecond = 0.0;
 
 public slots:
     void mouseLocationUpdate(int x, int y);
+    void mouseLocationPreview(int x, int y);
+    void mouseLocationCancelled();
     void updateButtonsText(const QString& newHotkey);
     void startApplication();
     void blockUIElements(bool isBlocked);
+    void updateTargetSearchResult(bool found, double score, double searchTime);
+    void updateReactionLatency(double latency);
+    void updateCaptureMetrics(double captureRate, double frameCost);
+    void showScriptError(const QString& message);
+    void updateTimingStats(double meanLateness, double maxLateness, double injectionLatency);
+    void updateStopLatency(double stopLatency, double injectionOvershoot);
+    void updateScheduleError(const QString& event, double error);
+    void updateWindowStatus(bool found, const QString& description);
 
 private slots:
     void on_PushButton_SetLocation_clicked();
@@ -48,13 +74,30 @@ private slots:
     void on_PushButton_Stop_clicked();
     void on_PushButton_Save_clicked();
     void on_PushButton_Load_clicked();
+    void on_PushButton_LoadTemplate_clicked();
+    void on_PushButton_LoadMask_clicked();
+    void on_PushButton_PickWindow_clicked();
+    void on_LineEdit_CaptureRate_editingFinished();
     void updateInputManager(QAbstractButton* button);
     void validateTimeRange();
+    void publishRunConfig();
+    void refreshStats();
 
 signals:
     void startCursorPositionGrab();
     void updateApplicationRunProcess(int fixedTime, int randomTime,const int& repeatTimes,const QPoint& location, const int&area);
     void stopApplication(bool stop);
+    void targetTemplateSelected(const QString& imagePath);
+    void captureRateChanged(int framesPerSecond);
+    void movementOptionsChanged(bool isCurved, int duration);
+    void scriptOptionsChanged(bool isEnabled, const QString& source);
+    void scheduleChanged(qint64 startAt, int runDuration);
+    void runConfigChanged(int fixedTime, int randomTime, const QPoint& location, int area);
+    void patternOptionsChanged(int kind, int columns, int rows, int spacing, int count, const QString& polyline);
+    void areaShapeChanged(int kind, int width, int height, const QString& polygon, const QString& maskPath);
+    void keyboardOptionsChanged(const QChar& actionType, int virtualKey, int holdDuration, const QString& text, int characterDelay);
+    void userOverrideOptionsChanged(bool isEnabled, int idleTime);
+    void windowTargetChanged(bool isEnabled, const QString& title, const QString& className, qint64 handle);
 
 };
 #endif // MAINWINDOW_H
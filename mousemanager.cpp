@@ -1,6 +1,12 @@
 #include "mousemanager.h"
+#include "actionscript.h"
+#include "clickjob.h"
+#include "injectionlatency.h"
+#include "stoptoken.h"
+#include "tracer.h"
 #include "qdebug.h"
 #include "qtimer.h"
+#include <QThread>
 #include <windows.h>
 #include <iostream>
 #include <QRandomGenerator>
@@ -15,24 +21,82 @@
  * @details This class handles various mouse actions, such as left-click simulations and cursor positioning.
  * It utilizes QTimer for controlling click intervals and facilitates left-click simulations and cursor movement
  * based on the provided parameters like click time, time between clicks, click type, repetitions, and location.
- * Also, it includes methods to start, stop, and check repetitions in the mouse click simulations.
+ * Every job is compiled into an ActionProgram and executed by an ActionVM; this class is the VM's ActionSink and
+ * turns its instructions into SendInput calls, or, with a target window, into messages posted to that window.
  */
 
 MouseManager::MouseManager(QObject *parent)
     : QObject{parent}
     ,isLocation(false)
     ,isArea(false)
+    ,isTarget(false)
+    ,isWatch(false)
+    ,isPattern(false)
+    ,clock(&steadyClock)
+    ,injector(&systemInjector)
 {
+    stopToken = StopToken::getInstance();
+    injectionLatency = InjectionLatency::getInstance();
+    userOverride = UserOverride::getInstance();
+    runConfig = RunConfig::getInstance();
+    runStats = RunStats::getInstance();
+    stopToken->setWakeHandler([this]()
+    {
+        QMetaObject::invokeMethod(this, &MouseManager::stopClickingApplication, Qt::QueuedConnection);
+    });
+
+    targetFinder = new TargetFinder(this);
+    regionWatcher = new RegionWatcher(this);
     mouseTimer = new QTimer(this);
+    mouseTimer->setTimerType(Qt::PreciseTimer);
+    mouseTimer->setSingleShot(true);
     connect(mouseTimer, &QTimer::timeout, this, &MouseManager::runApplication);
+
+    layout = ScreenLayout::getInstance()->snapshot();
+    connect(ScreenLayout::getInstance(), &ScreenLayout::layoutChanged, this, &MouseManager::updateScreenLayout);
 }
 
 MouseManager::~MouseManager()
 {
-    mouseTimer->stop();
+    stopToken->setWakeHandler(nullptr);
+    stopClickingApplication();
     delete mouseTimer;
 }
 
+/**
+ * @brief Replaces the time source of the scheduler.
+ *
+ * @param clock The clock, or nullptr for the monotonic system clock; must outlive the mouse manager.
+ */
+
+void MouseManager::setClock(EngineClock *clock)
+{
+    this->clock = clock ? clock : &steadyClock;
+}
+
+/**
+ * @brief Replaces what delivers the input events, e.g. with a RecordingInjector for checks.
+ *
+ * @param injector The injector, or nullptr for SendInput; must outlive the mouse manager.
+ */
+
+void MouseManager::setInjector(InputInjector *injector)
+{
+    this->injector = injector ? injector : &systemInjector;
+}
+
+/**
+ * @brief Replaces the checkpoint file, e.g. with a temporary one for checks that must not touch the user's.
+ *
+ * @param filePath The checkpoint file, opened when the next job starts.
+ */
+
+void MouseManager::setCheckpointPath(const QString& filePath)
+{
+    checkpoint.close();
+    checkpointPath = filePath;
+}
+
 /**
  * @brief Initiates the mouse clicking application based on the provided parameters.
  *
@@ -44,13 +108,25 @@ MouseManager::~MouseManager()
  * @param xy The coordinates of the mouse action.
  * @param area The area size for mouse action.
  *
- * @details Configures the mouse clicking application based on provided parameters.
+ * @details Compiles the job (or the user script, if enabled) into an ActionProgram and starts the
+ * interpreter. A script that fails to compile is reported through scriptError and ends the run. With a
+ * scheduled start the interpreter is held until the start time; with a run duration it is stopped at its end.
+ * A run of the same program that was interrupted by a crash is resumed from its checkpoint. The checkpoint file is
+ * opened by the first job; while another process holds it, jobs run without a checkpoint.
+ * With the user override enabled, mouse activity seen from here on pauses the run. The fine system timer
+ * resolution of the scheduling policy is held until the run ends. With a target window, the window is looked up
+ * once here and the run ends at once if it does not exist; the picked screen location, area shape and pattern
+ * are then converted into client coordinates of the window as it is placed now, so they keep their place in the
+ * window when it moves later.
  */
 
 void MouseManager::runClickingApplication(const int& clickTime, const int& timeBetweenClicks, const QChar& type, const int& repetitions, const QChar& location, const QPoint& xy, const int& area)
 {
     isLocation = false;
     isArea = false;
+    isTarget = false;
+    isWatch = false;
+    isPattern = false;
 
     if (location.toLower() == 'c')
     {
@@ -58,6 +134,15 @@ void MouseManager::runClickingApplication(const int& clickTime, const int& timeB
     } else if (location.toLower() == 'r')
     {
         isArea = true;
+    } else if (location.toLower() == 't')
+    {
+        isTarget = true;
+    } else if (location.toLower() == 'w')
+    {
+        isWatch = true;
+    } else if (location.toLower() == 'p')
+    {
+        isPattern = true;
     }
 
     threadData.timeToClick = clickTime;
@@ -68,10 +153,319 @@ void MouseManager::runClickingApplication(const int& clickTime, const int& timeB
     threadData.area = area;
     threadData.isArea = isArea;
     threadData.isLocation = isLocation;
+    threadData.isTarget = isTarget;
+    threadData.isWatch = isWatch;
+    threadData.isPattern = isPattern;
 
     shouldStop = false;
-    repetitionCount = 0;
-    mouseTimer->start(clickTime);
+    pendingReaction = false;
+    regionWatcher->reset();
+    configVersion = runConfig->getVersion();
+    runStats->begin(threadData.isScript ? 0 : static_cast<quint64>(qMax(0, repetitions)));
+
+    if (threadData.isScript)
+    {
+        QString errorMessage;
+        if (!ActionScript::compile(threadData.script, program, errorMessage))
+        {
+            emit scriptError(errorMessage);
+            emit finished();
+            return;
+        }
+    }
+
+    windowOffset = QPoint();
+    if (threadData.isWindowTarget)
+    {
+        bool found = windowTarget.attach();
+        emit windowTargetStatus(found, windowTarget.describe());
+        if (!found)
+        {
+            emit finished();
+            return;
+        }
+
+        QPoint cursorPos = injector->cursorPosition();
+        QRect client = windowTarget.getClientRect();
+        windowCursor = client.contains(cursorPos) ? windowTarget.fromScreen(cursorPos) : QPoint(client.width() / 2, client.height() / 2);
+        windowOffset = -client.topLeft();
+    }
+
+    if (!threadData.isScript)
+    {
+        compileJob(program);
+    }
+
+    updateCaptureRegion();
+
+    if (!checkpoint.isOpen() && !checkpoint.open(checkpointPath))
+    {
+        qDebug() << "Checkpoint file could not be mapped or is in use:" << checkpointPath;
+    }
+    vm.load(&program, QRandomGenerator::global()->generate64());
+    programFingerprint = program.fingerprint();
+    timingWindowStart = clock->now();
+    stopOvershoot = 0;
+    stopToken->arm();
+    injectionLatency->setMeasuring(true);
+    lead = injectionLatency->getLead();
+    isUserPaused = false;
+    userOverride->clear();
+    userOverride->setIdleTime(threadData.userIdleTime);
+    userOverride->setWatching(threadData.isPauseOnUserInput);
+    if (!isTimerResolutionHeld)
+    {
+        isTimerResolutionHeld = true;
+        SchedulingPolicy::getInstance()->beginTimerResolution();
+    }
+
+    if (threadData.startAt > 0)
+    {
+        isStartPending = true;
+        armScheduledStart();
+        return;
+    }
+
+    startDeadline = timingWindowStart;
+    stopDeadline = threadData.runDuration > 0 ? startDeadline + threadData.runDuration : 0;
+    scheduledTime = startDeadline;
+    startProgram(startDeadline);
+    mouseTimer->start(clock->timerInterval(startDeadline, 0));
+}
+
+/**
+ * @brief Starts the loaded program, or continues it where an interrupted run of the same job left off.
+ *
+ * @param time The time at which the program starts.
+ */
+
+void MouseManager::startProgram(qint64 time)
+{
+    if (checkpoint.load(programFingerprint, checkpointState))
+    {
+        vm.restoreState(checkpointState, time);
+        qDebug() << "Resuming interrupted job after" << checkpointState.iterations << "repetitions";
+    } else
+    {
+        vm.reset(time);
+    }
+}
+
+/**
+ * @brief Calibrates the wall clock and arms the timer for the scheduled start.
+ *
+ * @details The start time is converted to a steady deadline right after a fresh calibration. Far-away starts
+ * wake up calibrationLead early (and at least every maxTimerInterval) to calibrate again, so a system clock
+ * adjustment in between is picked up; the last wake-up happens spinMargin before the deadline.
+ */
+
+void MouseManager::armScheduledStart()
+{
+    wallClock.calibrate(*clock);
+    qint64 now = clock->now();
+
+    startDeadline = wallClock.toSteady(threadData.startAt);
+    if (startDeadline < now - spinMargin)
+    {
+        qDebug() << "Scheduled start time has already passed by" << (now - startDeadline) / 1e6 << "ms, starting now";
+    }
+    startDeadline = qMax(startDeadline, now);
+    stopDeadline = threadData.runDuration > 0 ? startDeadline + threadData.runDuration : 0;
+    scheduledTime = startDeadline;
+    startProgram(startDeadline);
+
+    qint64 remaining = startDeadline - now;
+    if (remaining > calibrationLead + spinMargin)
+    {
+        int interval = static_cast<int>(qMin(remaining - calibrationLead, maxTimerInterval) / 1000000);
+        mouseTimer->start(clock->timerInterval(now + interval * 1000000LL, interval));
+    } else
+    {
+        armTimer(startDeadline, true);
+    }
+}
+
+/**
+ * @brief Arms the single-shot timer for a deadline.
+ *
+ * @param deadline The steady clock deadline in nanoseconds at which the input should be delivered.
+ * @param isPrecise Whether the timer fires spinMargin early so the deadline can be met by spinning.
+ *
+ * @details The clock may change the interval: a VirtualClock moves to the deadline and fires at once. Every arm
+ * goes through EngineClock::timerInterval() and is released when runApplication() runs or the timer is stopped.
+ */
+
+void MouseManager::armTimer(qint64 deadline, bool isPrecise)
+{
+    qint64 remaining = deadline - lead - clock->now();
+    if (isPrecise)
+    {
+        remaining = (remaining - spinMargin) / 1000000;
+    } else
+    {
+        remaining = (remaining + 999999) / 1000000;
+    }
+    mouseTimer->start(clock->timerInterval(deadline - lead, static_cast<int>(qMax<qint64>(0, remaining))));
+}
+
+/**
+ * @brief Busy-waits until the deadline, yielding the processor between clock reads.
+ *
+ * @return The time at which the deadline was reached.
+ */
+
+qint64 MouseManager::spinUntil(qint64 deadline)
+{
+    qint64 now = clock->now();
+    while (now < deadline && stopToken->isRunning())
+    {
+        QThread::yieldCurrentThread();
+        now = clock->now();
+    }
+    return now;
+}
+
+/**
+ * @brief Registers the screen region the program needs with the shared screen capture, replacing the previous one.
+ *
+ * @details The target search and pixel checks capture the whole virtual desktop, so a target or a checked pixel
+ * on any monitor is found. The watched location is a screen location also with a target window, so the window has
+ * to be visible there for the vision modes to work.
+ */
+
+void MouseManager::updateCaptureRegion()
+{
+    releaseCaptureRegion();
+    if (program.uses(OpCode::FindTarget) || program.uses(OpCode::IfPixel))
+    {
+        captureRegion = layout->virtualDesktop;
+    } else if (program.uses(OpCode::WatchRegion))
+    {
+        int halfSide = qMax(1, threadData.area);
+        QPoint center = threadData.location;
+        captureRegion = QRect(center.x() - halfSide, center.y() - halfSide, 2 * halfSide, 2 * halfSide);
+    }
+    if (!captureRegion.isEmpty())
+    {
+        captureRegionId = ScreenCapture::getInstance()->addRegion(captureRegion);
+    }
+}
+
+/**
+ * @brief Translates the job settings into an ActionProgram.
+ *
+ * @param target Receives the bytecode.
+ *
+ * @details The settings hold screen coordinates. With a target window every location, shape origin and pattern
+ * point is moved by windowOffset, the negated screen position of the window's client area at the start of the run.
+ */
+
+void MouseManager::compileJob(ActionProgram& target)
+{
+    ClickJob job;
+    job.locationType = isLocation ? 'c' : (isArea ? 'r' : (isTarget ? 't' : (isWatch ? 'w' : (isPattern ? 'p' : 'l'))));
+    job.clickType = threadData.clickType;
+    job.timeToClick = threadData.timeToClick;
+    job.addRandomTime = threadData.addRandomTime;
+    job.repetitions = threadData.repetitions;
+    job.area = threadData.area;
+    job.location = threadData.location + windowOffset;
+    job.isCurvedMovement = threadData.isCurvedMovement;
+    job.moveDuration = threadData.moveDuration;
+    job.isClickFirst = threadData.startAt > 0;
+    job.shape = threadData.shape;
+    job.actionType = threadData.actionType;
+    job.virtualKey = threadData.virtualKey;
+    job.holdDuration = threadData.holdDuration;
+    job.text = threadData.text;
+    job.characterDelay = threadData.characterDelay;
+    if (threadData.shape.getKind() == AreaSampler::Mask)
+    {
+        job.shapeOrigin = layout->virtualDesktop.topLeft() + windowOffset;
+    } else if (threadData.shape.getKind() == AreaSampler::Polygon)
+    {
+        job.shapeOrigin = windowOffset;
+    } else
+    {
+        job.shapeOrigin = job.location;
+    }
+
+    if (isPattern)
+    {
+        QVector<QPoint> vertices;
+        if (threadData.patternKind == PointPattern::Spiral)
+        {
+            job.pattern = PointPattern::spiral(job.location, threadData.patternSpacing, static_cast<quint64>(qMax(1, threadData.patternCount)));
+        } else if (threadData.patternKind == PointPattern::Polyline && PointPattern::parseVertices(threadData.polyline, vertices))
+        {
+            for (QPoint& vertex : vertices)
+            {
+                vertex += windowOffset;
+            }
+            job.pattern = PointPattern::polyline(vertices, threadData.patternSpacing);
+        } else
+        {
+            job.pattern = PointPattern::grid(job.location, threadData.patternColumns, threadData.patternRows, threadData.patternSpacing);
+        }
+    }
+
+    job.compile(target);
+}
+
+/**
+ * @brief Applies the click interval, location and area edited while the job runs.
+ *
+ * @details The job is compiled again with the new values. Only the operands differ, so the new instructions are
+ * copied over the running program in place and the VM continues at the same position with its loop counters and
+ * random state intact. Scripts are not affected. Runs on the engine thread between two steps, so it needs no lock.
+ */
+
+void MouseManager::applyRunConfig()
+{
+    configVersion = runConfig->getVersion();
+    std::shared_ptr<const RunConfig::Snapshot> config = runConfig->snapshot();
+    threadData.timeToClick = config->timeToClick;
+    threadData.addRandomTime = config->addRandomTime;
+    threadData.location = config->location;
+    threadData.area = config->area;
+
+    if (threadData.isScript)
+    {
+        return;
+    }
+
+    ActionProgram updated;
+    compileJob(updated);
+    if (updated.size() != program.size() || updated.patternCount() != program.patternCount()
+        || updated.shapeCount() != program.shapeCount() || updated.textCount() != program.textCount())
+    {
+        qDebug() << "Live settings change does not match the running job, ignored";
+        return;
+    }
+    for (int i = 0; i < updated.size(); ++i)
+    {
+        if (updated.at(i).op != program.at(i).op)
+        {
+            qDebug() << "Live settings change does not match the running job, ignored";
+            return;
+        }
+    }
+
+    for (int i = 0; i < updated.size(); ++i)
+    {
+        program.at(i) = updated.at(i);
+    }
+    for (int i = 0; i < updated.patternCount(); ++i)
+    {
+        program.pattern(i) = updated.pattern(i);
+    }
+    programFingerprint = program.fingerprint();
+
+    if (program.uses(OpCode::WatchRegion))
+    {
+        updateCaptureRegion();
+        regionWatcher->reset();
+    }
 }
 
 /**
@@ -83,103 +477,911 @@ void MouseManager::stopClickingApplication()
 {
     if(!shouldStop)
     {      
+        if (mouseTimer->isActive())
+        {
+            clock->timerReleased();
+        }
         mouseTimer->stop();
+        reportStop();
     }
 
     shouldStop = true;
+    stopToken->finish();
+    isStartPending = false;
+    isStartCheckPending = false;
+    injectionLatency->setMeasuring(false);
+    userOverride->setWatching(false);
+    userOverride->setPaused(false);
+    isUserPaused = false;
+    if (isTimerResolutionHeld)
+    {
+        isTimerResolutionHeld = false;
+        SchedulingPolicy::getInstance()->endTimerResolution();
+    }
+    checkpoint.clear();
+    runStats->end();
+    pendingReaction = false;
+    releaseHeldButtons();
+    releaseCaptureRegion();
+    windowTarget.detach();
 }
 
 /**
- * @brief Checks if the number of repetitions for the mouse clicking process is completed.
- *
- * @return True if the desired number of repetitions is reached; otherwise, false.
+ * @brief Unregisters the region this job requested from the shared screen capture.
  */
 
-bool MouseManager::repetitionsCompleted() const
+void MouseManager::releaseCaptureRegion()
 {
-    return repetitionCount >= threadData.repetitions;
+    if (captureRegionId != 0)
+    {
+        ScreenCapture::getInstance()->removeRegion(captureRegionId);
+        captureRegionId = 0;
+    }
+    captureRegion = QRect();
+    lastFrameSequence = 0;
 }
 
 /**
- * @brief Executes the mouse clicking application based on defined parameters.
+ * @brief Executes the next step of the action program.
  *
- * @details This function manages the execution of the mouse clicking application.
- * It simulates mouse clicks and movements according to the provided settings until
- * the specified number of repetitions is achieved or the process is stopped.
+ * @details Runs the interpreter until it has to wait and rearms the single-shot timer for the returned
+ * deadline. The process finishes when the program halts or the application is stopped. How late each wake-up
+ * is against its deadline is tracked, so the effect of system load on click timing can be observed.
+ * The scheduled start and the end of the run duration are precise deadlines: the timer fires early and the
+ * remaining time is spun away, because a timer alone only reaches them with millisecond granularity.
+ * Deadlines are delivery times: the engine works lead (the measured injection latency) ahead of the clock, so
+ * input is injected early by the time the system needs to deliver it. After every step the VM state is copied
+ * into the memory-mapped checkpoint, which costs no system call; it is cleared when the job ends or is stopped.
+ * While the user override reports mouse activity, the step is not run and the job waits (see pauseForUser()).
  */
 
 void MouseManager::runApplication()
 {
-    if (repetitionsCompleted() || shouldStop)
+    clock->timerReleased();
+    lead = injectionLatency->getLead();
+    qint64 now = clock->now() + lead;
+
+    if (isStartPending)
+    {
+        if (startDeadline - now > spinMargin)
+        {
+            armScheduledStart();
+            return;
+        }
+        now = spinUntil(startDeadline - lead) + lead;
+        isStartPending = false;
+        isStartCheckPending = true;
+        qDebug() << "Scheduled start reached, calibration uncertainty" << wallClock.getUncertainty() / 1e3 << "us";
+    } else if (stopDeadline != 0 && scheduledTime >= stopDeadline)
     {
+        now = spinUntil(stopDeadline - lead) + lead;
+        double error = (now - stopDeadline) / 1e6;
         emit finished();
-        repetitionCount = 0;
         stopClickingApplication();
+        qDebug() << "Scheduled stop error" << error << "ms";
+        emit scheduleMeasured("stop", error);
+        return;
+    }
+
+    recordLateness(now);
+    Tracer::record(Tracer::TimerWake, now - scheduledTime);
+
+    if (runConfig->getVersion() != configVersion)
+    {
+        applyRunConfig();
+    }
+
+    if (threadData.isPauseOnUserInput && pauseForUser(now))
+    {
+        return;
+    }
+
+    qint64 next = (shouldStop || !stopToken->isRunning()) ? -1 : vm.run(now, *this);
+    runStats->setIterations(vm.getIterations());
+    if (next < 0)
+    {
+        emit finished();
+        stopClickingApplication();
+        return;
+    }
+
+    vm.saveState(checkpointState, now);
+    checkpoint.save(programFingerprint, checkpointState);
+
+    scheduledTime = next;
+    bool isStop = stopDeadline != 0 && next >= stopDeadline;
+    if (isStop)
+    {
+        scheduledTime = stopDeadline;
+    }
+    Tracer::record(Tracer::Schedule, scheduledTime - now, lead);
+    armTimer(scheduledTime, isStop);
+}
+
+/**
+ * @brief Pauses the job while the user moves or clicks the mouse and resumes it once the mouse is idle.
+ *
+ * @param now The wake-up time.
+ * @return True if the job is paused and the timer has been armed for the earliest resume; otherwise, false.
+ *
+ * @details On pause the VM state is saved and held buttons and keys are released, so a drag does not hold the
+ * button the user is now using. On resume the state is restored at the current time, so the remaining wait of
+ * the interrupted step is kept and nothing that fell due during the pause is made up. While paused, the timer
+ * wakes at the resume time the override reports; further activity moves it further out. A run duration is not
+ * extended by pauses.
+ */
+
+bool MouseManager::pauseForUser(qint64 now)
+{
+    if (!userOverride->isActive())
+    {
+        if (isUserPaused)
+        {
+            isUserPaused = false;
+            vm.restoreState(pauseState, now);
+            userOverride->setPaused(false);
+            Tracer::record(Tracer::UserPause, 0, 0);
+        }
+        return false;
+    }
+
+    if (!isUserPaused)
+    {
+        isUserPaused = true;
+        vm.saveState(pauseState, now);
+        releaseHeldButtons();
+        userOverride->setPaused(true);
+    }
+
+    scheduledTime = userOverride->getResumeTime() + lead;
+    if (stopDeadline != 0)
+    {
+        scheduledTime = qMin(scheduledTime, stopDeadline);
+    }
+    Tracer::record(Tracer::UserPause, 1, scheduledTime - now);
+    armTimer(scheduledTime, false);
+    return true;
+}
+
+/**
+ * @brief Records how late the scheduler woke up and publishes the statistics once per second.
+ *
+ * @param now The wake-up time.
+ */
+
+void MouseManager::recordLateness(qint64 now)
+{
+    qint64 lateness = qMax<qint64>(0, now - scheduledTime);
+    latenessSum += lateness;
+    latenessMax = qMax(latenessMax, lateness);
+    ++latenessCount;
+    runStats->recordLateness(lateness);
+
+    if (now - timingWindowStart >= 1000000000)
+    {
+        emit timingUpdated(latenessSum / 1e6 / latenessCount, latenessMax / 1e6, injectionLatency->getEstimate() / 1e6);
+        latenessSum = 0;
+        latenessMax = 0;
+        latenessCount = 0;
+        timingWindowStart = now;
+    }
+}
+
+/**
+ * @brief Sets how the cursor travels to the click location.
+ *
+ * @param isCurved Whether the cursor moves along a curved path instead of jumping.
+ * @param duration The travel time of a curved movement in milliseconds.
+ */
+
+void MouseManager::setMovementOptions(bool isCurved, int duration)
+{
+    threadData.isCurvedMovement = isCurved;
+    threadData.moveDuration = qMax(ClickJob::movementStep, duration);
+}
+
+/**
+ * @brief Sets the action script that replaces the job configured in the main window.
+ *
+ * @param isEnabled Whether the script is run instead of the configured job.
+ * @param source The script text, compiled when the application starts.
+ */
+
+void MouseManager::setScript(bool isEnabled, const QString& source)
+{
+    threadData.isScript = isEnabled;
+    threadData.script = source;
+}
+
+/**
+ * @brief Sets when the next run starts and how long it lasts.
+ *
+ * @param startAt The start time in milliseconds since the Unix epoch, or 0 to start immediately.
+ * @param runDuration The run duration in milliseconds, or 0 to run until the job ends or is stopped.
+ */
+
+void MouseManager::setSchedule(qint64 startAt, int runDuration)
+{
+    threadData.startAt = startAt * 1000000;
+    threadData.runDuration = static_cast<qint64>(qMax(0, runDuration)) * 1000000;
+}
+
+/**
+ * @brief Sets the point pattern swept by the pattern location mode.
+ *
+ * @param kind The PointPattern::Kind of the sweep.
+ * @param columns The number of grid columns.
+ * @param rows The number of grid rows.
+ * @param spacing The distance between neighbouring points in pixels.
+ * @param count The number of spiral points.
+ * @param polyline The polyline vertices as "X Y, X Y, ...".
+ *
+ * @details Grids start at the configured location, spirals are centred on it. A polyline that cannot be parsed
+ * falls back to a grid.
+ */
+
+void MouseManager::setPatternOptions(int kind, int columns, int rows, int spacing, int count, const QString& polyline)
+{
+    threadData.patternKind = kind;
+    threadData.patternColumns = qMax(1, columns);
+    threadData.patternRows = qMax(1, rows);
+    threadData.patternSpacing = qMax(1, spacing);
+    threadData.patternCount = qMax(1, count);
+    threadData.polyline = polyline;
+}
+
+/**
+ * @brief Prepares the shape sampled by the random area location mode.
+ *
+ * @param kind 0 for the circle of the area radius, 1 for a rectangle, 2 for an ellipse, 3 for a polygon and 4 for
+ * a mask image.
+ * @param width The width of a rectangle or ellipse in pixels.
+ * @param height The height of a rectangle or ellipse in pixels.
+ * @param polygon The polygon vertices in screen coordinates as "X Y, X Y, ...".
+ * @param maskPath The mask image, laid over the virtual desktop from its top-left corner.
+ *
+ * @details Rectangles and ellipses are centred on the configured location. The sampling structure is built here,
+ * once per run, so choosing a point stays constant-time per click. A shape that cannot be used falls back to the
+ * circle.
+ */
+
+void MouseManager::setAreaShape(int kind, int width, int height, const QString& polygon, const QString& maskPath)
+{
+    threadData.shape = AreaSampler();
+    QSize size(qMax(1, width), qMax(1, height));
+
+    if (kind == 1)
+    {
+        threadData.shape = AreaSampler::rectangle(size);
+    } else if (kind == 2)
+    {
+        threadData.shape = AreaSampler::ellipse(size);
+    } else if (kind == 3)
+    {
+        QVector<QPoint> vertices;
+        if (!PointPattern::parseVertices(polygon, vertices) || !AreaSampler::polygon(vertices, threadData.shape))
+        {
+            qDebug() << "Area polygon could not be used:" << polygon;
+        }
+    } else if (kind == 4)
+    {
+        if (!AreaSampler::mask(QImage(maskPath), threadData.shape))
+        {
+            qDebug() << "Area mask could not be used:" << maskPath;
+        }
+    }
+}
+
+/**
+ * @brief Sets the keyboard action performed instead of the mouse click.
+ *
+ * @param actionType 'm' for the mouse click, 'p' to press a key, 'h' to hold a key and 't' to type a text.
+ * @param virtualKey The virtual key code pressed or held.
+ * @param holdDuration How long a held key stays down in milliseconds.
+ * @param text The text to type; translated for the current keyboard layout here, once per run.
+ * @param characterDelay The delay between typed characters in milliseconds, or 0 to type the text in one batch.
+ */
+
+void MouseManager::setKeyboardOptions(const QChar& actionType, int virtualKey, int holdDuration, const QString& text, int characterDelay)
+{
+    threadData.actionType = actionType;
+    threadData.virtualKey = virtualKey;
+    threadData.holdDuration = qMax(0, holdDuration);
+    threadData.text = KeySequence::translate(text);
+    threadData.characterDelay = qMax(0, characterDelay);
+}
+
+/**
+ * @brief Sets whether the job pauses while the user uses the mouse.
+ *
+ * @param isEnabled Whether mouse movements and clicks of the user pause the job.
+ * @param idleTime How long the mouse has to stay idle before the job resumes, in milliseconds.
+ */
+
+void MouseManager::setUserOverrideOptions(bool isEnabled, int idleTime)
+{
+    threadData.isPauseOnUserInput = isEnabled;
+    threadData.userIdleTime = qMax(0, idleTime);
+}
+
+/**
+ * @brief Sets the window that receives the input instead of the global cursor position.
+ *
+ * @param isEnabled Whether input is posted to the window. Locations are still picked on screen and are converted
+ * into client coordinates when a run starts; script coordinates are client coordinates.
+ * @param title The window title, or empty to match any title.
+ * @param className The window class, or empty to match any class.
+ * @param handle A window picked on screen, or 0.
+ */
+
+void MouseManager::setWindowTarget(bool isEnabled, const QString& title, const QString& className, qint64 handle)
+{
+    threadData.isWindowTarget = isEnabled;
+    windowTarget.setIdentity(title, className, handle);
+}
+
+/**
+ * @brief Loads the reference image used by the target image location mode.
+ *
+ * @param imagePath Path to the template image file.
+ */
+
+void MouseManager::setTargetTemplate(const QString& imagePath)
+{
+    if (!targetFinder->setTemplateImage(QImage(imagePath)))
+    {
+        qDebug() << "Template image could not be used:" << imagePath;
+    }
+}
+
+/**
+ * @brief Fetches the latest shared capture frame if it has not been processed yet.
+ *
+ * @param frame Receives the frame.
+ * @return True if a frame newer than the last processed one is available; otherwise, false.
+ */
+
+bool MouseManager::acquireNewFrame(CaptureFrame& frame)
+{
+    frame = ScreenCapture::getInstance()->latestFrame();
+    if (!frame.isValid() || frame.getSequence() == lastFrameSequence)
+    {
+        return false;
+    }
+
+    lastFrameSequence = frame.getSequence();
+    return true;
+}
+
+/**
+ * @brief Searches the latest captured frame of the virtual desktop for the template image.
+ *
+ * @param target Receives the screen coordinates of the match centre.
+ * @return True if the template was found; otherwise, false.
+ *
+ * @details Ticks without a new frame or without a match are skipped and do not count as a repetition.
+ */
+
+bool MouseManager::locateTarget(QPoint& target)
+{
+    CaptureFrame frame;
+    if (!targetFinder->hasTemplate() || !acquireNewFrame(frame))
+    {
+        return false;
+    }
+
+    double score = 0.0;
+    bool found = targetFinder->locate(frame.view(captureRegion), target, score);
+    target += captureRegion.topLeft();
+    if (threadData.isWindowTarget)
+    {
+        target = windowTarget.fromScreen(target);
+    }
+    emit targetSearchFinished(found, score, targetFinder->getLastSearchTime());
+    return found;
+}
+
+/**
+ * @brief Checks the latest captured frame of the watched square around the chosen location for changes.
+ *
+ * @return True if the region differs from the previous capture; otherwise, false.
+ *
+ * @details The grab time of the frame is kept so the reaction latency (frame grab to injected click) can be reported.
+ * After a reaction the watcher is reset, so the first capture after the click interval becomes the new baseline.
+ */
+
+bool MouseManager::regionChanged()
+{
+    CaptureFrame frame;
+    if (!acquireNewFrame(frame))
+    {
+        return false;
+    }
+
+    lastGrabTime = frame.getTimestamp();
+    pendingReaction = regionWatcher->processFrame(frame.view(captureRegion));
+    return pendingReaction;
+}
+
+/**
+ * @brief Reports the latency of a reaction to a watched region change once its input has been injected.
+ */
+
+void MouseManager::reportReaction()
+{
+    if (pendingReaction)
+    {
+        pendingReaction = false;
+        emit reactionTriggered((clock->now() - lastGrabTime) / 1e6);
+        regionWatcher->reset();
+    }
+}
+
+/**
+ * @brief Reads a pixel of the latest captured frame.
+ *
+ * @param point The pixel position in virtual desktop pixels.
+ * @return The pixel color, or 0 if the point lies outside the captured region or no frame is available.
+ */
+
+QRgb MouseManager::pixelAt(const QPoint& point)
+{
+    QPoint screenPoint = threadData.isWindowTarget ? windowTarget.toScreen(point) : point;
+    CaptureFrame frame = ScreenCapture::getInstance()->latestFrame();
+    if (!frame.isValid() || !captureRegion.contains(screenPoint))
+    {
+        return 0;
+    }
+    return frame.view(captureRegion).pixel(screenPoint - captureRegion.topLeft());
+}
+
+/**
+ * @brief Returns the current cursor position; with a target window, the position of the last input posted to it.
+ */
+
+QPoint MouseManager::cursorPosition()
+{
+    if (threadData.isWindowTarget)
+    {
+        return windowCursor;
+    }
+
+    return injector->cursorPosition();
+}
+
+namespace
+{
+const DWORD buttonDownFlags[] = {MOUSEEVENTF_LEFTDOWN, MOUSEEVENTF_RIGHTDOWN, MOUSEEVENTF_MIDDLEDOWN};
+const DWORD buttonUpFlags[] = {MOUSEEVENTF_LEFTUP, MOUSEEVENTF_RIGHTUP, MOUSEEVENTF_MIDDLEUP};
+const UINT buttonDownMessages[] = {WM_LBUTTONDOWN, WM_RBUTTONDOWN, WM_MBUTTONDOWN};
+const UINT buttonUpMessages[] = {WM_LBUTTONUP, WM_RBUTTONUP, WM_MBUTTONUP};
+const UINT buttonDoubleClickMessages[] = {WM_LBUTTONDBLCLK, WM_RBUTTONDBLCLK, WM_MBUTTONDBLCLK};
+const WPARAM buttonKeyStates[] = {MK_LBUTTON, MK_RBUTTON, MK_MBUTTON};
+
+WPARAM buttonFlags(int buttons)
+{
+    WPARAM flags = 0;
+    for (int button = ActionSink::Left; button <= ActionSink::Middle; ++button)
+    {
+        if (buttons & (1 << button))
+        {
+            flags |= buttonKeyStates[button];
+        }
+    }
+    return flags;
+}
+}
+
+/**
+ * @brief Clicks a mouse button at the current cursor position.
+ *
+ * @param button ActionSink::Button.
+ * @param clicks The number of clicks (1 or 2).
+ */
+
+void MouseManager::click(int button, int clicks)
+{
+    if (threadData.isWindowTarget)
+    {
+        if (postClick(windowCursor, button, clicks))
+        {
+            runStats->recordClick(windowTarget.toScreen(windowCursor));
+            reportReaction();
+        }
+        return;
+    }
+
+    INPUT input[4] = {{0}};
+    int count = qBound(1, clicks, 2) * 2;
+
+    for (int i = 0; i < count; ++i)
+    {
+        input[i].type = INPUT_MOUSE;
+        input[i].mi.dwFlags = (i % 2 == 0) ? buttonDownFlags[button] : buttonUpFlags[button];
+    }
+    if (inject(input, count))
+    {
+        runStats->countClick();
+        reportReaction();
+    }
+}
+
+/**
+ * @brief Moves the cursor to the target and clicks there with a single SendInput call.
+ *
+ * @param target The click location in virtual desktop pixels.
+ * @param button ActionSink::Button.
+ * @param clicks The number of clicks (1 or 2).
+ *
+ * @details The first event carries the absolute, virtual-desktop-normalized position together with the first
+ * button press, so no separate SetCursorPos call is needed and targets on any monitor, including ones with
+ * negative offsets, are reached.
+ */
+
+void MouseManager::clickAt(const QPoint& target, int button, int clicks)
+{
+    if (threadData.isWindowTarget)
+    {
+        windowCursor = target;
+        if (postClick(target, button, clicks))
+        {
+            runStats->recordClick(windowTarget.toScreen(target));
+            reportReaction();
+        }
         return;
     }
 
-    ++repetitionCount;
+    QPoint absolute = ScreenLayout::toAbsolute(*layout, target);
+    INPUT input[4] = {{0}};
+    int count = qBound(1, clicks, 2) * 2;
 
-    if (isLocation)
+    for (int i = 0; i < count; ++i)
     {
-        SetCursorPos(threadData.location.x(), threadData.location.y());
+        input[i].type = INPUT_MOUSE;
+        input[i].mi.dwFlags = (i % 2 == 0) ? buttonDownFlags[button] : buttonUpFlags[button];
     }
-    else if (isArea)
+    input[0].mi.dx = absolute.x();
+    input[0].mi.dy = absolute.y();
+    input[0].mi.dwFlags |= MOUSEEVENTF_MOVE | MOUSEEVENTF_ABSOLUTE | MOUSEEVENTF_VIRTUALDESK;
+
+    if (inject(input, count))
     {
-        QPoint centerOfCircle(threadData.location.x(), threadData.location.y());
-        int circleRadius = threadData.area;
+        runStats->recordClick(target);
+        reportReaction();
+    }
+}
+
+/**
+ * @brief Moves the cursor with one absolute-positioned input event.
+ *
+ * @param point The new cursor position in virtual desktop pixels.
+ */
 
-        QPoint randomPoint = getRandomPointWithinCircle(centerOfCircle, circleRadius);
-        SetCursorPos(randomPoint.x(), randomPoint.y());
+void MouseManager::moveTo(const QPoint& point)
+{
+    if (threadData.isWindowTarget)
+    {
+        windowCursor = point;
+        WindowTarget::Message message = WindowTarget::mouseMessage(WM_MOUSEMOVE, buttonFlags(heldButtons), point);
+        postToWindow(&message, 1);
+        return;
     }
 
-    if (threadData.clickType.toLower() == 'd')
+    QPoint absolute = ScreenLayout::toAbsolute(*layout, point);
+    INPUT input = {0};
+    input.type = INPUT_MOUSE;
+    input.mi.dx = absolute.x();
+    input.mi.dy = absolute.y();
+    input.mi.dwFlags = MOUSEEVENTF_MOVE | MOUSEEVENTF_ABSOLUTE | MOUSEEVENTF_VIRTUALDESK;
+    inject(&input, 1);
+}
+
+/**
+ * @brief Injects input unless the job has been stopped.
+ *
+ * @param inputs The input events.
+ * @param count The number of input events.
+ * @param isRelease Whether the input only releases buttons, which is always allowed so nothing stays pressed.
+ * @return True if the input was sent; otherwise, false.
+ *
+ * @details The stop token is checked right before the input is sent, so once a stop request is visible nothing is
+ * injected anymore. An injection that passed the check just before the request is measured as overshoot.
+ * The first injection after a scheduled start is compared with the start deadline and logged. Every injection
+ * is tagged through its extra info, so its delivery can be told apart from user input and timed.
+ */
+
+bool MouseManager::inject(INPUT *inputs, int count, bool isRelease)
+{
+    if (!admitInput(isRelease))
+    {
+        return false;
+    }
+
+    ULONG_PTR extraInfo = injectionLatency->tagInjection(clock->now());
+    for (int i = 0; i < count; ++i)
     {
-        leftClick();
+        if (inputs[i].type == INPUT_MOUSE)
+        {
+            inputs[i].mi.dwExtraInfo = extraInfo;
+        } else
+        {
+            inputs[i].ki.dwExtraInfo = extraInfo;
+        }
     }
-    leftClick();
+    injector->send(inputs, count);
+    Tracer::record(Tracer::Injection, count, isRelease);
+    recordOvershoot(isRelease);
+    return true;
+}
 
-    int timeToNextClick = threadData.timeToClick + (rand() % (threadData.addRandomTime + 1));
+/**
+ * @brief Posts messages to the target window unless the job has been stopped; the counterpart of inject().
+ *
+ * @param messages The window messages.
+ * @param count The number of messages.
+ * @param isRelease Whether the messages only release buttons or keys, which is always allowed.
+ * @return True if the messages were posted; false if the job was stopped or the window is gone.
+ *
+ * @details Posted messages bypass the system input queue, so they are neither tagged nor seen by the latency
+ * measurement, and the global cursor does not move.
+ */
+
+bool MouseManager::postToWindow(const WindowTarget::Message *messages, int count, bool isRelease)
+{
+    if (!admitInput(isRelease) || !windowTarget.post(messages, count))
+    {
+        return false;
+    }
 
-    mouseTimer->start(timeToNextClick);
+    Tracer::record(Tracer::Injection, count, isRelease);
+    recordOvershoot(isRelease);
+    return true;
 }
 
 /**
- * @brief Simulates a left mouse button click.
+ * @brief Posts a click to the target window, preceded by a move to the click location.
  *
- * @details This function generates a left mouse button click event by sending
- *          the corresponding input flags (down and up) using the Windows API.
- *          It emulates a left mouse button press and release action.
+ * @param point The click location in client coordinates.
+ * @param button ActionSink::Button.
+ * @param clicks The number of clicks (1 or 2); the second press is posted as a double click.
  */
 
-void MouseManager::leftClick()
+bool MouseManager::postClick(const QPoint& point, int button, int clicks)
 {
-    INPUT input[2] = {{0}};
-    input[0].type = INPUT_MOUSE;
-    input[0].mi.dwFlags = MOUSEEVENTF_LEFTDOWN;
-    input[1].type = INPUT_MOUSE;
-    input[1].mi.dwFlags = MOUSEEVENTF_LEFTUP;
-    SendInput(2, input, sizeof(INPUT));
+    WPARAM held = buttonFlags(heldButtons);
+    WindowTarget::Message messages[5];
+    int count = 0;
+    messages[count++] = WindowTarget::mouseMessage(WM_MOUSEMOVE, held, point);
+    messages[count++] = WindowTarget::mouseMessage(buttonDownMessages[button], held | buttonKeyStates[button], point);
+    messages[count++] = WindowTarget::mouseMessage(buttonUpMessages[button], held, point);
+    if (clicks > 1)
+    {
+        messages[count++] = WindowTarget::mouseMessage(buttonDoubleClickMessages[button], held | buttonKeyStates[button], point);
+        messages[count++] = WindowTarget::mouseMessage(buttonUpMessages[button], held, point);
+    }
+    return postToWindow(messages, count);
 }
 
 /**
- * @brief Generates a random point within a circle given its center and radius.
+ * @brief Decides whether input may be delivered now and reports the error of a scheduled start with the first input.
  *
- * @param center The center point of the circle.
- * @param radius The radius of the circle.
- * @return Returns a random point within the specified circle.
+ * @param isRelease Whether the input only releases buttons or keys.
+ */
+
+bool MouseManager::admitInput(bool isRelease)
+{
+    if (!isRelease && !stopToken->isRunning())
+    {
+        return false;
+    }
+
+    if (isStartCheckPending)
+    {
+        isStartCheckPending = false;
+        double error = (clock->now() + lead - startDeadline) / 1e6;
+        qDebug() << "Scheduled start error" << error << "ms";
+        emit scheduleMeasured("start", error);
+    }
+    return true;
+}
+
+/**
+ * @brief Measures how long after a stop request an input that had already passed admitInput() was delivered.
+ */
+
+void MouseManager::recordOvershoot(bool isRelease)
+{
+    qint64 requestTime = stopToken->getRequestTime();
+    if (!isRelease && requestTime != 0)
+    {
+        stopOvershoot = qMax(stopOvershoot, clock->now() - requestTime);
+    }
+}
+
+/**
+ * @brief Reports how long the engine took to stop after the stop request.
+ */
+
+void MouseManager::reportStop()
+{
+    qint64 requestTime = stopToken->getRequestTime();
+    if (requestTime != 0)
+    {
+        emit stopMeasured((clock->now() - requestTime) / 1e6, stopOvershoot / 1e6);
+    }
+}
+
+/**
+ * @brief Reloads the cached virtual desktop layout after a screen change.
+ */
+
+void MouseManager::updateScreenLayout()
+{
+    layout = ScreenLayout::getInstance()->snapshot();
+}
+
+/**
+ * @brief Sends a single button transition, used for press and release instructions such as drags.
+ *
+ * @param button ActionSink::Button.
+ * @param isDown Whether the button is pressed or released.
+ *
+ * @details Held buttons are tracked so stopping the application never leaves a button pressed.
+ */
+
+void MouseManager::setButton(int button, bool isDown)
+{
+    bool isSent = false;
+    if (threadData.isWindowTarget)
+    {
+        int buttons = isDown ? heldButtons | (1 << button) : heldButtons & ~(1 << button);
+        WindowTarget::Message message = WindowTarget::mouseMessage(isDown ? buttonDownMessages[button] : buttonUpMessages[button], buttonFlags(buttons), windowCursor);
+        isSent = postToWindow(&message, 1, !isDown);
+    } else
+    {
+        INPUT input = {0};
+        input.type = INPUT_MOUSE;
+        input.mi.dwFlags = isDown ? buttonDownFlags[button] : buttonUpFlags[button];
+        isSent = inject(&input, 1, !isDown);
+    }
+    if (!isSent)
+    {
+        return;
+    }
+
+    if (isDown)
+    {
+        heldButtons |= 1 << button;
+    } else
+    {
+        heldButtons &= ~(1 << button);
+        reportReaction();
+    }
+}
+
+/**
+ * @brief Releases every button and key still held by an unfinished press instruction.
+ */
+
+void MouseManager::releaseHeldButtons()
+{
+    for (int button = ActionSink::Left; button <= ActionSink::Middle; ++button)
+    {
+        if (heldButtons & (1 << button))
+        {
+            setButton(button, false);
+        }
+    }
+    heldButtons = 0;
+    while (!heldKeys.isEmpty())
+    {
+        quint16 virtualKey = heldKeys.takeLast();
+        if (threadData.isWindowTarget)
+        {
+            WindowTarget::Message message = WindowTarget::keyMessage(virtualKey, false);
+            postToWindow(&message, 1, true);
+            continue;
+        }
+        INPUT input = {0};
+        input.type = INPUT_KEYBOARD;
+        input.ki.wVk = virtualKey;
+        input.ki.dwFlags = KEYEVENTF_KEYUP;
+        inject(&input, 1, true);
+    }
+}
+
+/**
+ * @brief Sends a single key transition.
+ *
+ * @param virtualKey The virtual key code.
+ * @param isDown Whether the key is pressed or released.
+ *
+ * @details Held keys are tracked so stopping the application never leaves a key pressed.
+ */
+
+void MouseManager::sendKey(int virtualKey, bool isDown)
+{
+    bool isSent = false;
+    if (threadData.isWindowTarget)
+    {
+        WindowTarget::Message message = WindowTarget::keyMessage(virtualKey, isDown);
+        isSent = postToWindow(&message, 1, !isDown);
+    } else
+    {
+        INPUT input = {0};
+        input.type = INPUT_KEYBOARD;
+        input.ki.wVk = static_cast<WORD>(virtualKey);
+        input.ki.dwFlags = isDown ? 0 : KEYEVENTF_KEYUP;
+        isSent = inject(&input, 1, !isDown);
+    }
+    if (!isSent)
+    {
+        return;
+    }
+
+    heldKeys.removeAll(static_cast<quint16>(virtualKey));
+    if (isDown)
+    {
+        heldKeys.append(static_cast<quint16>(virtualKey));
+    }
+}
+
+/**
+ * @brief Sends a batch of key transitions with a single SendInput call.
+ *
+ * @param strokes The key strokes; Unicode strokes become KEYEVENTF_UNICODE events.
+ * @param count The number of strokes.
  *
- * @details This function calculates a random point within a circle using polar coordinates.
- *          It generates a random angle and distance within the range of the circle's radius
- *          and then converts these values to Cartesian coordinates (x, y) relative to the center.
+ * @details The INPUT buffer is kept between calls, so typing does not allocate once it has grown to the longest
+ * text. Every batch releases what it presses. A target window receives one character message per typed
+ * character instead: posted modifier presses do not change the keyboard state of the target's thread, so the
+ * key strokes would be translated into unshifted characters there. Only keys that type no printable character
+ * (Return and Tab) are posted as key presses.
  */
 
-QPoint MouseManager::getRandomPointWithinCircle(const QPoint& center, int radius)
+void MouseManager::sendKeys(const KeyStroke *strokes, int count)
 {
-    qreal randomAngle = QRandomGenerator::global()->bounded(2 * M_PI);
-    qreal randomDistance = QRandomGenerator::global()->bounded(radius);
-    int randomX = center.x() + static_cast<int>(randomDistance * qCos(randomAngle));
-    int randomY = center.y() + static_cast<int>(randomDistance * qSin(randomAngle));
+    if (count <= 0)
+    {
+        return;
+    }
 
-    return QPoint(randomX, randomY);
+    if (threadData.isWindowTarget)
+    {
+        windowMessages.clear();
+        for (int i = 0; i < count; ++i)
+        {
+            quint16 character = strokes[i].character;
+            if (character == '\n' || character == '\t')
+            {
+                windowMessages.append(WindowTarget::keyMessage(strokes[i].code, !strokes[i].isRelease));
+            } else if (character != 0 && !strokes[i].isRelease)
+            {
+                windowMessages.append(WindowTarget::charMessage(character));
+            }
+        }
+        postToWindow(windowMessages.data(), windowMessages.size());
+        return;
+    }
+
+    keyInputs.resize(count);
+    for (int i = 0; i < count; ++i)
+    {
+        INPUT& input = keyInputs[i];
+        input = INPUT{};
+        input.type = INPUT_KEYBOARD;
+        if (strokes[i].isUnicode)
+        {
+            input.ki.wScan = strokes[i].code;
+            input.ki.dwFlags = KEYEVENTF_UNICODE;
+        } else
+        {
+            input.ki.wVk = strokes[i].code;
+        }
+        if (strokes[i].isRelease)
+        {
+            input.ki.dwFlags |= KEYEVENTF_KEYUP;
+        }
+    }
+    inject(keyInputs.data(), count);
 }
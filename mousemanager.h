@@ -1,10 +1,28 @@
 #ifndef MOUSEMANAGER_H
 #define MOUSEMANAGER_H
 
+#include "actionprogram.h"
+#include "actionvm.h"
+#include "engineclock.h"
+#include "injectionlatency.h"
+#include "inputinjector.h"
+#include "jobcheckpoint.h"
+#include "stoptoken.h"
 #include "qpoint.h"
+#include "regionwatcher.h"
+#include "runconfig.h"
+#include "runstats.h"
+#include "screencapture.h"
+#include "schedulingpolicy.h"
+#include "screenlayout.h"
+#include "targetfinder.h"
+#include "useroverride.h"
+#include "wallclock.h"
+#include "windowtarget.h"
 #include <QObject>
+#include <windows.h>
 
-class MouseManager : public QObject
+class MouseManager : public QObject, public ActionSink
 {
     Q_OBJECT
 public:
@@ -13,17 +31,99 @@ public:
 
     void startMouseHook();
     void stopMouseHook();
+    void setClock(EngineClock *clock);
+    void setInjector(InputInjector *injector);
+    void setCheckpointPath(const QString& filePath);
 
     bool isRunning;
 
 private:
     QTimer *mouseTimer;
-    QPoint getRandomPointWithinCircle(const QPoint& centerOfCircle, int circleRadius);
-    void leftClick();
+    ActionProgram program;
+    ActionVM vm;
+    int heldButtons = 0;
+    QVector<quint16> heldKeys;
+    QVector<INPUT> keyInputs;
+    bool pendingReaction = false;
+    TargetFinder *targetFinder;
+    RegionWatcher *regionWatcher;
+    QRect captureRegion;
+    int captureRegionId = 0;
+    quint64 lastFrameSequence = 0;
+    qint64 lastGrabTime = 0;
+    bool acquireNewFrame(CaptureFrame& frame);
+    void releaseCaptureRegion();
+    void releaseHeldButtons();
+    void reportReaction();
+    void compileJob(ActionProgram& target);
+    void updateCaptureRegion();
+    RunConfig *runConfig;
+    RunStats *runStats;
+    quint64 configVersion = 0;
+    void applyRunConfig();
+    std::shared_ptr<const ScreenLayout::Snapshot> layout;
     bool isLocation;
     bool isArea;
+    bool isTarget;
+    bool isWatch;
+    bool isPattern;
     bool shouldStop = false;
-    int repetitionCount = 0;
+    EngineClock *clock;
+    SteadyClock steadyClock;
+    InputInjector *injector;
+    SystemInputInjector systemInjector;
+    qint64 scheduledTime = 0;
+    qint64 latenessSum = 0;
+    qint64 latenessMax = 0;
+    int latenessCount = 0;
+    qint64 timingWindowStart = 0;
+    void recordLateness(qint64 now);
+    StopToken *stopToken;
+    qint64 stopOvershoot = 0;
+    bool inject(INPUT *inputs, int count, bool isRelease = false);
+    bool postToWindow(const WindowTarget::Message *messages, int count, bool isRelease = false);
+    bool admitInput(bool isRelease);
+    void recordOvershoot(bool isRelease);
+    WindowTarget windowTarget;
+    QPoint windowCursor;
+    QPoint windowOffset;
+    QVector<WindowTarget::Message> windowMessages;
+    bool postClick(const QPoint& point, int button, int clicks);
+    void reportStop();
+    static constexpr qint64 spinMargin = 2000000;
+    static constexpr qint64 calibrationLead = 1000000000;
+    static constexpr qint64 maxTimerInterval = 3600000000000;
+    WallClock wallClock;
+    qint64 startDeadline = 0;
+    qint64 stopDeadline = 0;
+    bool isStartPending = false;
+    bool isStartCheckPending = false;
+    InjectionLatency *injectionLatency;
+    qint64 lead = 0;
+    UserOverride *userOverride;
+    bool isUserPaused = false;
+    bool isTimerResolutionHeld = false;
+    ActionVM::State pauseState;
+    bool pauseForUser(qint64 now);
+    JobCheckpoint checkpoint;
+    QString checkpointPath = JobCheckpoint::defaultPath();
+    ActionVM::State checkpointState;
+    quint64 programFingerprint = 0;
+    void startProgram(qint64 time);
+    void armScheduledStart();
+    void armTimer(qint64 deadline, bool isPrecise);
+    qint64 spinUntil(qint64 deadline);
+
+    QPoint cursorPosition() override;
+    void moveTo(const QPoint& point) override;
+    void click(int button, int clicks) override;
+    void clickAt(const QPoint& point, int button, int clicks) override;
+    void setButton(int button, bool isDown) override;
+    void sendKey(int virtualKey, bool isDown) override;
+    void sendKeys(const KeyStroke *strokes, int count) override;
+    bool locateTarget(QPoint& target) override;
+    bool regionChanged() override;
+    QRgb pixelAt(const QPoint& point) override;
 
     struct ThreadData {
         QChar clickType;
@@ -34,21 +134,61 @@ private:
         QPoint location;
         bool isArea;
         bool isLocation;
+        bool isTarget;
+        bool isWatch;
+        bool isPattern;
+        bool isCurvedMovement = false;
+        int moveDuration = 200;
+        bool isScript = false;
+        QString script;
+        qint64 startAt = 0;
+        qint64 runDuration = 0;
+        int patternKind = PointPattern::Grid;
+        int patternColumns = 1;
+        int patternRows = 1;
+        int patternSpacing = 10;
+        int patternCount = 1;
+        QString polyline;
+        AreaSampler shape;
+        QChar actionType = 'm';
+        int virtualKey = 0x20;
+        int holdDuration = 100;
+        KeySequence text;
+        int characterDelay = 0;
+        bool isPauseOnUserInput = false;
+        int userIdleTime = 1000;
+        bool isWindowTarget = false;
     };
 
     ThreadData threadData;
-    bool repetitionsCompleted() const;
 
 public slots:
     void runClickingApplication(const int& clickTime, const int& timeBetweenClicks, const QChar& type, const int& repetitions, const QChar& location, const QPoint& xy, const int& area);
     void stopClickingApplication();
+    void setTargetTemplate(const QString& imagePath);
+    void setMovementOptions(bool isCurved, int duration);
+    void setScript(bool isEnabled, const QString& source);
+    void setSchedule(qint64 startAt, int runDuration);
+    void setPatternOptions(int kind, int columns, int rows, int spacing, int count, const QString& polyline);
+    void setAreaShape(int kind, int width, int height, const QString& polygon, const QString& maskPath);
+    void setKeyboardOptions(const QChar& actionType, int virtualKey, int holdDuration, const QString& text, int characterDelay);
+    void setUserOverrideOptions(bool isEnabled, int idleTime);
+    void setWindowTarget(bool isEnabled, const QString& title, const QString& className, qint64 handle);
 
 private slots:
     void runApplication();
+    void updateScreenLayout();
 
 signals:
     void leftMouseClick();
     void mouseMoved(int x, int y);
+    void targetSearchFinished(bool found, double score, double searchTime);
+    void reactionTriggered(double latency);
+    void scriptError(const QString& message);
+    void timingUpdated(double meanLateness, double maxLateness, double injectionLatency);
+    void stopMeasured(double stopLatency, double injectionOvershoot);
+    void scheduleMeasured(const QString& event, double error);
+    void windowTargetStatus(bool found, const QString& description);
     void finished();
 };
 
@@ -0,0 +1,229 @@
+#include "pointpattern.h"
+#include <QRegularExpression>
+#include <QtMath>
+#include <algorithm>
+
+/**
+ * @brief Click sweeps that compute every point from its index instead of storing the points.
+ *
+ * @details A pattern is a lazy sequence: it only keeps its parameters (for a polyline also its vertices and their
+ * cumulative lengths) and at() produces a point on demand, so a sweep over millions of points needs constant memory
+ * and its iterator is a single index, which the VM advances per click and keeps in its checkpointable state:
+ * - Grid: columns x rows cells at the given spacing from the top-left origin, walked row by row in serpentine
+ *   order so the cursor never jumps back across the grid.
+ * - Spiral: the square spiral around the center, ring by ring, using the closed form for the n-th point.
+ * - Polyline: points at a fixed distance along the vertices; the segment is found by binary search.
+ */
+
+/**
+ * @brief Creates a grid sweep.
+ */
+
+PointPattern PointPattern::grid(const QPoint& origin, int columns, int rows, int spacing)
+{
+    PointPattern pattern;
+    pattern.kind = Grid;
+    pattern.origin = origin;
+    pattern.columns = qMax(1, columns);
+    pattern.spacing = qMax(1, spacing);
+    pattern.count = static_cast<quint64>(pattern.columns) * static_cast<quint64>(qMax(1, rows));
+    return pattern;
+}
+
+/**
+ * @brief Creates a square spiral sweep outward from the center.
+ *
+ * @param count The number of points, including the center.
+ */
+
+PointPattern PointPattern::spiral(const QPoint& center, int spacing, quint64 count)
+{
+    PointPattern pattern;
+    pattern.kind = Spiral;
+    pattern.origin = center;
+    pattern.spacing = qMax(1, spacing);
+    pattern.count = qMax<quint64>(1, count);
+    return pattern;
+}
+
+/**
+ * @brief Creates a sweep along a polyline with points every spacing pixels, starting at the first vertex.
+ */
+
+PointPattern PointPattern::polyline(const QVector<QPoint>& vertices, int spacing)
+{
+    PointPattern pattern;
+    pattern.kind = Polyline;
+    pattern.spacing = qMax(1, spacing);
+    pattern.vertices = vertices;
+    if (pattern.vertices.isEmpty())
+    {
+        pattern.vertices.append(QPoint());
+    }
+
+    double length = 0.0;
+    pattern.cumulativeLengths.append(0.0);
+    for (int i = 1; i < pattern.vertices.size(); ++i)
+    {
+        QPoint delta = pattern.vertices.at(i) - pattern.vertices.at(i - 1);
+        length += qSqrt(static_cast<double>(delta.x()) * delta.x() + static_cast<double>(delta.y()) * delta.y());
+        pattern.cumulativeLengths.append(length);
+    }
+    pattern.count = static_cast<quint64>(length / pattern.spacing) + 1;
+    return pattern;
+}
+
+/**
+ * @brief Parses vertices written as "X Y, X Y, ...".
+ *
+ * @return True if the text holds at least two vertices; otherwise, false.
+ */
+
+bool PointPattern::parseVertices(const QString& text, QVector<QPoint>& vertices)
+{
+    vertices.clear();
+    const QStringList pairs = text.split(',', Qt::SkipEmptyParts);
+    for (const QString& pair : pairs)
+    {
+        QStringList coordinates = pair.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+        bool isX = false;
+        bool isY = false;
+        if (coordinates.size() != 2)
+        {
+            return false;
+        }
+        QPoint vertex(coordinates.at(0).toInt(&isX), coordinates.at(1).toInt(&isY));
+        if (!isX || !isY)
+        {
+            return false;
+        }
+        vertices.append(vertex);
+    }
+    return vertices.size() >= 2;
+}
+
+/**
+ * @brief Returns the kind of sweep.
+ */
+
+PointPattern::Kind PointPattern::getKind() const
+{
+    return kind;
+}
+
+/**
+ * @brief Returns the number of points of one sweep.
+ */
+
+quint64 PointPattern::size() const
+{
+    return count;
+}
+
+/**
+ * @brief Computes the point with the given index.
+ *
+ * @param index The index, in range 0..size()-1.
+ */
+
+QPoint PointPattern::at(quint64 index) const
+{
+    switch (kind)
+    {
+    case Grid:
+    {
+        qint64 row = static_cast<qint64>(index / static_cast<quint64>(columns));
+        qint64 column = static_cast<qint64>(index % static_cast<quint64>(columns));
+        if (row & 1)
+        {
+            column = columns - 1 - column;
+        }
+        return origin + QPoint(static_cast<int>(column * spacing), static_cast<int>(row * spacing));
+    }
+    case Spiral:
+    {
+        if (index == 0)
+        {
+            return origin;
+        }
+
+        // Ring k holds the points with 1-based position p in ((2k-1)^2, (2k+1)^2].
+        qint64 p = static_cast<qint64>(index) + 1;
+        qint64 k = static_cast<qint64>(qCeil((qSqrt(static_cast<double>(p)) - 1.0) / 2.0));
+        while ((2 * k - 1) * (2 * k - 1) >= p)
+        {
+            --k;
+        }
+        while ((2 * k + 1) * (2 * k + 1) < p)
+        {
+            ++k;
+        }
+
+        qint64 side = 2 * k;
+        qint64 last = (2 * k + 1) * (2 * k + 1);
+        qint64 x = 0;
+        qint64 y = 0;
+        if (p >= last - side)
+        {
+            x = k - (last - p);
+            y = -k;
+        } else if (p >= last - 2 * side)
+        {
+            x = -k;
+            y = -k + (last - side - p);
+        } else if (p >= last - 3 * side)
+        {
+            x = -k + (last - 2 * side - p);
+            y = k;
+        } else
+        {
+            x = k;
+            y = k - (last - 3 * side - p);
+        }
+        return origin + QPoint(static_cast<int>(x * spacing), static_cast<int>(y * spacing));
+    }
+    case Polyline:
+    {
+        double distance = static_cast<double>(index) * spacing;
+        auto segmentEnd = std::upper_bound(cumulativeLengths.constBegin(), cumulativeLengths.constEnd(), distance);
+        int end = static_cast<int>(segmentEnd - cumulativeLengths.constBegin());
+        if (end >= vertices.size())
+        {
+            return vertices.last();
+        }
+
+        int begin = end - 1;
+        double segmentLength = cumulativeLengths.at(end) - cumulativeLengths.at(begin);
+        double fraction = segmentLength > 0.0 ? (distance - cumulativeLengths.at(begin)) / segmentLength : 0.0;
+        QPoint from = vertices.at(begin);
+        QPoint to = vertices.at(end);
+        return QPoint(from.x() + qRound((to.x() - from.x()) * fraction), from.y() + qRound((to.y() - from.y()) * fraction));
+    }
+    }
+    return origin;
+}
+
+/**
+ * @brief Returns a hash of the parameters, identifying the pattern in a program fingerprint.
+ */
+
+quint64 PointPattern::fingerprint() const
+{
+    quint64 hash = 0xCBF29CE484222325ULL;
+    auto mix = [&hash](quint64 value)
+    {
+        hash = (hash ^ value) * 0x100000001B3ULL;
+    };
+
+    mix(kind);
+    mix(static_cast<quint32>(origin.x()));
+    mix(static_cast<quint32>(origin.y()));
+    mix(static_cast<quint32>(columns));
+    mix(static_cast<quint32>(spacing));
+    mix(count);
+    for (const QPoint& vertex : vertices)
+    {
+        mix((static_cast<quint64>(static_cast<quint32>(vertex.x())) << 32) | static_cast<quint32>(vertex.y()));
+    }
+    return hash;
+}
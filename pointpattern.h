@@ -0,0 +1,37 @@
+#ifndef POINTPATTERN_H
+#define POINTPATTERN_H
+
+#include <QPoint>
+#include <QString>
+#include <QVector>
+
+class PointPattern
+{
+public:
+    enum Kind : quint8 {
+        Grid,
+        Spiral,
+        Polyline
+    };
+
+    static PointPattern grid(const QPoint& origin, int columns, int rows, int spacing);
+    static PointPattern spiral(const QPoint& center, int spacing, quint64 count);
+    static PointPattern polyline(const QVector<QPoint>& vertices, int spacing);
+    static bool parseVertices(const QString& text, QVector<QPoint>& vertices);
+
+    Kind getKind() const;
+    quint64 size() const;
+    QPoint at(quint64 index) const;
+    quint64 fingerprint() const;
+
+private:
+    Kind kind = Grid;
+    QPoint origin;
+    int columns = 1;
+    int spacing = 1;
+    quint64 count = 0;
+    QVector<QPoint> vertices;
+    QVector<double> cumulativeLengths;
+};
+
+#endif // POINTPATTERN_H
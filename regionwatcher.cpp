@@ -0,0 +1,115 @@
+#include "regionwatcher.h"
+#include <cstring>
+
+/**
+ * @brief Detects changes inside a watched screen region by comparing block hashes of consecutive frames.
+ *
+ * @details Every frame is split into fixed-size blocks and each block is reduced to a 64-bit hash. The hashes
+ * are compared with those of the previous frame, so an unchanged frame costs one pass over its pixels and no
+ * allocation or image copy. The first frame after reset() only establishes the baseline.
+ */
+
+RegionWatcher::RegionWatcher(QObject *parent)
+    : QObject{parent}
+    ,blockColumns(0)
+    ,blockRows(0)
+    ,changedBlock(-1)
+    ,hasBaseline(false)
+{
+}
+
+/**
+ * @brief Forgets the previous frame, the next processed frame becomes the new baseline.
+ */
+
+void RegionWatcher::reset()
+{
+    hasBaseline = false;
+    changedBlock = -1;
+}
+
+/**
+ * @brief Returns the index (row-major) of the first block that differed in the last processed frame, or -1.
+ */
+
+int RegionWatcher::getChangedBlock() const
+{
+    return changedBlock;
+}
+
+/**
+ * @brief Hashes the blocks of a frame and compares them with the previous frame.
+ *
+ * @param frame The captured region, expected in a 32-bit format.
+ * @return True if any block differs from the previous frame; otherwise, false.
+ *
+ * @details A frame with a different size than the previous one re-establishes the baseline.
+ */
+
+bool RegionWatcher::processFrame(const QImage& frame)
+{
+    int columns = (frame.width() + blockSize - 1) / blockSize;
+    int rows = (frame.height() + blockSize - 1) / blockSize;
+
+    if (columns != blockColumns || rows != blockRows)
+    {
+        blockColumns = columns;
+        blockRows = rows;
+        blockHashes.resize(columns * rows);
+        hasBaseline = false;
+    }
+
+    changedBlock = -1;
+    quint64* hashes = blockHashes.data();
+
+    for (int blockY = 0; blockY < rows; ++blockY)
+    {
+        for (int blockX = 0; blockX < columns; ++blockX)
+        {
+            int index = blockY * columns + blockX;
+            quint64 hash = hashBlock(frame, blockX, blockY);
+            if (hasBaseline && changedBlock < 0 && hash != hashes[index])
+            {
+                changedBlock = index;
+            }
+            hashes[index] = hash;
+        }
+    }
+
+    bool changed = hasBaseline && changedBlock >= 0;
+    hasBaseline = true;
+    return changed;
+}
+
+/**
+ * @brief Computes an FNV-1a style hash over the pixels of one block, eight bytes at a time.
+ */
+
+quint64 RegionWatcher::hashBlock(const QImage& frame, int blockX, int blockY)
+{
+    const quint64 prime = 0x100000001b3ULL;
+    quint64 hash = 0xcbf29ce484222325ULL;
+
+    int bytesPerPixel = frame.depth() / 8;
+    int firstX = blockX * blockSize;
+    int firstY = blockY * blockSize;
+    int rowBytes = (qMin(frame.width(), firstX + blockSize) - firstX) * bytesPerPixel;
+    int lastY = qMin(frame.height(), firstY + blockSize);
+
+    for (int y = firstY; y < lastY; ++y)
+    {
+        const uchar* row = frame.constScanLine(y) + firstX * bytesPerPixel;
+        int i = 0;
+        for (; i + 8 <= rowBytes; i += 8)
+        {
+            quint64 word;
+            std::memcpy(&word, row + i, sizeof(word));
+            hash = (hash ^ word) * prime;
+        }
+        for (; i < rowBytes; ++i)
+        {
+            hash = (hash ^ row[i]) * prime;
+        }
+    }
+    return hash;
+}
@@ -0,0 +1,30 @@
+#ifndef REGIONWATCHER_H
+#define REGIONWATCHER_H
+
+#include <QImage>
+#include <QObject>
+#include <QVector>
+
+class RegionWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit RegionWatcher(QObject *parent = nullptr);
+
+    bool processFrame(const QImage& frame);
+    void reset();
+    int getChangedBlock() const;
+
+private:
+    static constexpr int blockSize = 16;
+
+    QVector<quint64> blockHashes;
+    int blockColumns;
+    int blockRows;
+    int changedBlock;
+    bool hasBaseline;
+
+    static quint64 hashBlock(const QImage& frame, int blockX, int blockY);
+};
+
+#endif // REGIONWATCHER_H
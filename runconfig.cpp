@@ -0,0 +1,44 @@
+#include "runconfig.h"
+
+/**
+ * @brief The settings of a job that can be changed while it runs: click interval, location and area.
+ *
+ * @details The main window publishes an immutable snapshot whenever one of these settings is edited, and the
+ * engine picks it up on its next tick. The snapshot pointer is swapped atomically, so a reader always sees one
+ * consistent set of values. Because the shared_ptr atomics may use a lock internally, the engine only compares
+ * the version counter on every tick and loads the snapshot itself only after a change.
+ */
+
+RunConfig* RunConfig::getInstance()
+{
+    static RunConfig instance;
+    return &instance;
+}
+
+/**
+ * @brief Publishes new settings; the running job applies them on its next tick.
+ */
+
+void RunConfig::publish(const Snapshot& snapshot)
+{
+    std::atomic_store(&current, std::shared_ptr<const Snapshot>(std::make_shared<const Snapshot>(snapshot)));
+    version.fetch_add(1, std::memory_order_release);
+}
+
+/**
+ * @brief Returns the latest settings; the snapshot stays valid even if newer settings are published afterwards.
+ */
+
+std::shared_ptr<const RunConfig::Snapshot> RunConfig::snapshot() const
+{
+    return std::atomic_load(&current);
+}
+
+/**
+ * @brief Returns a counter that changes with every publish().
+ */
+
+quint64 RunConfig::getVersion() const
+{
+    return version.load(std::memory_order_acquire);
+}
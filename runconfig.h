@@ -0,0 +1,29 @@
+#ifndef RUNCONFIG_H
+#define RUNCONFIG_H
+
+#include <QPoint>
+#include <atomic>
+#include <memory>
+
+class RunConfig
+{
+public:
+    struct Snapshot {
+        int timeToClick = 100;
+        int addRandomTime = 0;
+        QPoint location;
+        int area = 0;
+    };
+
+    static RunConfig* getInstance();
+
+    void publish(const Snapshot& snapshot);
+    std::shared_ptr<const Snapshot> snapshot() const;
+    quint64 getVersion() const;
+
+private:
+    std::shared_ptr<const Snapshot> current = std::make_shared<const Snapshot>();
+    std::atomic<quint64> version{0};
+};
+
+#endif // RUNCONFIG_H
@@ -0,0 +1,204 @@
+#include "runstats.h"
+#include <QtMath>
+#include <limits>
+
+/**
+ * @brief Live statistics of the running job, written by the engine and read by the dashboard.
+ *
+ * @details The engine thread is the only writer, so every counter is updated with a relaxed load and store instead
+ * of a locked read-modify-write, and nothing on the click path allocates, locks or signals. Click locations go
+ * through a single-producer, single-consumer ring that the dashboard drains; when it falls behind the newest
+ * locations are dropped rather than blocking the engine. Scheduler lateness is kept as a histogram with four
+ * buckets per power of two from one microsecond up, from which the dashboard reads percentiles. The dashboard
+ * polls at its own capped rate and a new generation tells it that a new run started.
+ */
+
+RunStats* RunStats::getInstance()
+{
+    static RunStats instance;
+    return &instance;
+}
+
+/**
+ * @brief Resets the statistics for a new run; called by the engine thread.
+ *
+ * @param repetitions The repetitions of the job, for the progress display.
+ */
+
+void RunStats::begin(quint64 repetitions)
+{
+    clicks.store(0, std::memory_order_relaxed);
+    iterations.store(0, std::memory_order_relaxed);
+    this->repetitions.store(repetitions, std::memory_order_relaxed);
+    latenessMax.store(0, std::memory_order_relaxed);
+    for (std::atomic<quint64>& bucket : latenessHistogram)
+    {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    isRunning.store(true, std::memory_order_relaxed);
+    generation.store(generation.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Marks the run as finished; the statistics stay readable.
+ */
+
+void RunStats::end()
+{
+    isRunning.store(false, std::memory_order_release);
+}
+
+/**
+ * @brief Counts a click whose location is not known, e.g. at the cursor.
+ */
+
+void RunStats::countClick()
+{
+    clicks.store(clicks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Counts a click and queues its location for the heatmap.
+ */
+
+void RunStats::recordClick(const QPoint& point)
+{
+    countClick();
+
+    quint32 write = head.load(std::memory_order_relaxed);
+    if (write - tail.load(std::memory_order_acquire) >= clickCapacity)
+    {
+        return;
+    }
+    samples[write % clickCapacity] = ClickSample{point.x(), point.y()};
+    head.store(write + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Adds one scheduler wake-up to the lateness histogram.
+ *
+ * @param lateness Time between the scheduled and the actual wake-up in nanoseconds.
+ */
+
+void RunStats::recordLateness(qint64 lateness)
+{
+    std::atomic<quint64>& bucket = latenessHistogram[bucketOf(lateness)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (lateness > latenessMax.load(std::memory_order_relaxed))
+    {
+        latenessMax.store(lateness, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Publishes the number of completed repetitions.
+ */
+
+void RunStats::setIterations(quint64 iterations)
+{
+    this->iterations.store(iterations, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Copies the current statistics; called by the dashboard.
+ *
+ * @details The values are read one by one, so they may come from slightly different moments, which is fine for a
+ * display.
+ */
+
+void RunStats::read(Snapshot& snapshot) const
+{
+    snapshot.generation = generation.load(std::memory_order_acquire);
+    snapshot.isRunning = isRunning.load(std::memory_order_acquire);
+    snapshot.clicks = clicks.load(std::memory_order_relaxed);
+    snapshot.iterations = iterations.load(std::memory_order_relaxed);
+    snapshot.repetitions = repetitions.load(std::memory_order_relaxed);
+    snapshot.latenessMax = latenessMax.load(std::memory_order_relaxed);
+    for (int i = 0; i < latenessBuckets; ++i)
+    {
+        snapshot.latenessHistogram[i] = latenessHistogram[i].load(std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Removes the oldest queued click location; called by the dashboard only.
+ *
+ * @return True if a location was available; otherwise, false.
+ */
+
+bool RunStats::popClick(QPoint& point)
+{
+    quint32 read = tail.load(std::memory_order_relaxed);
+    if (read == head.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    const ClickSample& sample = samples[read % clickCapacity];
+    point = QPoint(sample.x, sample.y);
+    tail.store(read + 1, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Returns the lateness below which the given fraction of wake-ups fell, in nanoseconds.
+ *
+ * @details Accurate to the histogram resolution of a quarter octave; the maximum is exact.
+ */
+
+qint64 RunStats::percentile(const Snapshot& snapshot, double fraction)
+{
+    quint64 total = 0;
+    for (quint64 count : snapshot.latenessHistogram)
+    {
+        total += count;
+    }
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    quint64 rank = static_cast<quint64>(qCeil(fraction * total));
+    quint64 cumulative = 0;
+    for (int bucket = 0; bucket < latenessBuckets; ++bucket)
+    {
+        cumulative += snapshot.latenessHistogram[bucket];
+        if (cumulative >= rank)
+        {
+            return qMin(bucketEnd(bucket), snapshot.latenessMax);
+        }
+    }
+    return snapshot.latenessMax;
+}
+
+/**
+ * @brief Returns the histogram bucket of a lateness: 0 below 1024 ns, then four buckets per power of two.
+ */
+
+int RunStats::bucketOf(qint64 lateness)
+{
+    if (lateness < 1024)
+    {
+        return 0;
+    }
+
+    int exponent = 63 - qCountLeadingZeroBits(static_cast<quint64>(lateness));
+    int quarter = static_cast<int>((lateness >> (exponent - 2)) & 3);
+    return qMin(latenessBuckets - 1, 1 + (exponent - 10) * 4 + quarter);
+}
+
+/**
+ * @brief Returns the exclusive upper bound of a bucket in nanoseconds.
+ */
+
+qint64 RunStats::bucketEnd(int bucket)
+{
+    if (bucket >= latenessBuckets - 1)
+    {
+        return std::numeric_limits<qint64>::max();
+    }
+
+    int exponent = 10 + bucket / 4;
+    int quarter = bucket % 4;
+    return static_cast<qint64>(4 + quarter) << (exponent - 2);
+}
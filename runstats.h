@@ -0,0 +1,58 @@
+#ifndef RUNSTATS_H
+#define RUNSTATS_H
+
+#include <QPoint>
+#include <atomic>
+
+class RunStats
+{
+public:
+    static constexpr int latenessBuckets = 64;
+    static constexpr quint32 clickCapacity = 4096;
+
+    struct Snapshot {
+        quint64 generation = 0;
+        bool isRunning = false;
+        quint64 clicks = 0;
+        quint64 iterations = 0;
+        quint64 repetitions = 0;
+        qint64 latenessMax = 0;
+        quint64 latenessHistogram[latenessBuckets] = {};
+    };
+
+    static RunStats* getInstance();
+
+    void begin(quint64 repetitions);
+    void end();
+    void countClick();
+    void recordClick(const QPoint& point);
+    void recordLateness(qint64 lateness);
+    void setIterations(quint64 iterations);
+
+    void read(Snapshot& snapshot) const;
+    bool popClick(QPoint& point);
+    static qint64 percentile(const Snapshot& snapshot, double fraction);
+
+private:
+    struct ClickSample {
+        qint32 x;
+        qint32 y;
+    };
+
+    std::atomic<quint64> generation{0};
+    std::atomic<bool> isRunning{false};
+    std::atomic<quint64> clicks{0};
+    std::atomic<quint64> iterations{0};
+    std::atomic<quint64> repetitions{0};
+    std::atomic<qint64> latenessMax{0};
+    std::atomic<quint64> latenessHistogram[latenessBuckets] = {};
+
+    ClickSample samples[clickCapacity];
+    std::atomic<quint32> head{0};
+    std::atomic<quint32> tail{0};
+
+    static int bucketOf(qint64 lateness);
+    static qint64 bucketEnd(int bucket);
+};
+
+#endif // RUNSTATS_H
@@ -0,0 +1,228 @@
+#include "schedulingpolicy.h"
+#include <QDebug>
+#include <QMutexLocker>
+#include <QThread>
+
+#if defined(Q_OS_WIN)
+#include <Windows.h>
+#include <timeapi.h>
+#endif
+
+/**
+ * @brief Operating system scheduling settings of the click scheduler and the input hook thread.
+ *
+ * @details Both threads start at Qt's time-critical thread priority. On top of that the policy can raise the
+ * process priority class, pin each thread to a CPU and request a 1 ms system timer resolution while a job is
+ * active, so the precise timer and the final spin of the scheduler are not stretched to the default 15.6 ms tick.
+ * Every thread applies the policy to itself. Whatever the system refuses, usually for missing privileges, falls
+ * back to the next weaker setting; the fallback is logged and kept in the report, which the timing benchmark prints
+ * next to its lateness figures. Realtime scheduling is meant for the hook thread, which only ever waits for input.
+ * The scheduler spins away the last spinMargin before precise deadlines, and a spinning thread at the top of the
+ * realtime range keeps the system's own input and worker threads off its CPU, so it is kept at the bottom of that
+ * range instead.
+ */
+
+SchedulingPolicy* SchedulingPolicy::getInstance()
+{
+    static SchedulingPolicy instance;
+    return &instance;
+}
+
+/**
+ * @brief Parses a priority given on the command line.
+ *
+ * @param name "default", "high" or "realtime".
+ * @param priority Receives the priority.
+ * @return True if the name is known; otherwise, false.
+ */
+
+bool SchedulingPolicy::parsePriority(const QString& name, Priority& priority)
+{
+    if (name == "default")
+    {
+        priority = DefaultPriority;
+    } else if (name == "high")
+    {
+        priority = HighPriority;
+    } else if (name == "realtime")
+    {
+        priority = RealTimePriority;
+    } else
+    {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Sets the policy; threads pick it up the next time they apply it.
+ */
+
+void SchedulingPolicy::setOptions(const Options& newOptions)
+{
+    QMutexLocker locker(&mutex);
+    options = newOptions;
+}
+
+SchedulingPolicy::Options SchedulingPolicy::getOptions()
+{
+    QMutexLocker locker(&mutex);
+    return options;
+}
+
+/**
+ * @brief Applies the priority and CPU pinning of the given role to the calling thread.
+ */
+
+void SchedulingPolicy::applyToCurrentThread(Role role)
+{
+    Options current = getOptions();
+    QString thread = role == Scheduler ? "scheduler" : "hook";
+    applyPriority(current, role, thread);
+    applyAffinity(role == Scheduler ? current.schedulerCpu : current.hookCpu, thread);
+}
+
+/**
+ * @brief Raises the priority of the calling thread as far as the system permits.
+ *
+ * @details On Windows the priority class belongs to the process, so it is raised and reported by the first thread
+ * only. In the realtime class the scheduler thread gets the lowest realtime level instead of time-critical.
+ */
+
+void SchedulingPolicy::applyPriority(const Options& current, Role role, const QString& thread)
+{
+    if (current.priority == DefaultPriority)
+    {
+        return;
+    }
+
+#if defined(Q_OS_WIN)
+    QMutexLocker locker(&mutex);
+    if (!isPriorityClassApplied)
+    {
+        isPriorityClassApplied = true;
+        DWORD priorityClass = current.priority == RealTimePriority ? REALTIME_PRIORITY_CLASS : HIGH_PRIORITY_CLASS;
+        QString message;
+        if (!SetPriorityClass(GetCurrentProcess(), priorityClass))
+        {
+            message = QString("process: priority class could not be raised (error %1), keeping normal").arg(GetLastError());
+        } else if (GetPriorityClass(GetCurrentProcess()) != priorityClass)
+        {
+            message = "process: realtime priority class needs the increase base priority privilege, using high";
+        } else
+        {
+            message = QString("process: %1 priority class").arg(current.priority == RealTimePriority ? "realtime" : "high");
+        }
+        isRealTimeClass = GetPriorityClass(GetCurrentProcess()) == REALTIME_PRIORITY_CLASS;
+        locker.unlock();
+        addReport(message);
+        locker.relock();
+    }
+    bool isSpinning = role == Scheduler && isRealTimeClass;
+    locker.unlock();
+
+    if (isSpinning)
+    {
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_IDLE);
+        addReport(QString("%1: lowest realtime thread priority, as it spins before precise deadlines").arg(thread));
+    } else
+    {
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+    }
+#else
+    addReport(QString("%1: priority policy not supported on this system").arg(thread));
+#endif
+}
+
+/**
+ * @brief Pins the calling thread to one CPU.
+ *
+ * @param cpu The CPU index, or -1 to let the system choose.
+ */
+
+void SchedulingPolicy::applyAffinity(int cpu, const QString& thread)
+{
+    if (cpu < 0)
+    {
+        return;
+    }
+
+    if (cpu >= QThread::idealThreadCount())
+    {
+        addReport(QString("%1: CPU %2 does not exist, not pinned").arg(thread).arg(cpu));
+        return;
+    }
+
+#if defined(Q_OS_WIN)
+    if (SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) == 0)
+    {
+        addReport(QString("%1: pinning to CPU %2 failed (error %3)").arg(thread).arg(cpu).arg(GetLastError()));
+        return;
+    }
+#else
+    addReport(QString("%1: CPU pinning not supported on this system").arg(thread));
+    return;
+#endif
+    addReport(QString("%1: pinned to CPU %2").arg(thread).arg(cpu));
+}
+
+/**
+ * @brief Requests the fine system timer resolution; called when a job starts. Calls are counted.
+ *
+ * @details A refused request is not held, so endTimerResolution() never releases a resolution that was not
+ * granted.
+ */
+
+void SchedulingPolicy::beginTimerResolution()
+{
+    QMutexLocker locker(&mutex);
+    if (!options.isTimerResolution || timerResolutionUsers++ > 0)
+    {
+        return;
+    }
+
+#if defined(Q_OS_WIN)
+    if (timeBeginPeriod(timerResolution) != TIMERR_NOERROR)
+    {
+        locker.unlock();
+        addReport(QString("timer resolution of %1 ms was refused").arg(timerResolution));
+        return;
+    }
+#endif
+    isTimerResolutionHeld = true;
+}
+
+/**
+ * @brief Releases the timer resolution request when the last job has ended.
+ */
+
+void SchedulingPolicy::endTimerResolution()
+{
+    QMutexLocker locker(&mutex);
+    if (timerResolutionUsers == 0 || --timerResolutionUsers > 0 || !isTimerResolutionHeld)
+    {
+        return;
+    }
+
+    isTimerResolutionHeld = false;
+#if defined(Q_OS_WIN)
+    timeEndPeriod(timerResolution);
+#endif
+}
+
+/**
+ * @brief Returns what the policy achieved on each thread, including every fallback.
+ */
+
+QStringList SchedulingPolicy::getReport()
+{
+    QMutexLocker locker(&mutex);
+    return report;
+}
+
+void SchedulingPolicy::addReport(const QString& message)
+{
+    qDebug() << "Scheduling policy:" << message;
+    QMutexLocker locker(&mutex);
+    report.append(message);
+}
@@ -0,0 +1,55 @@
+#ifndef SCHEDULINGPOLICY_H
+#define SCHEDULINGPOLICY_H
+
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+class SchedulingPolicy
+{
+public:
+    enum Priority {
+        DefaultPriority,
+        HighPriority,
+        RealTimePriority
+    };
+
+    enum Role {
+        Scheduler,
+        Hook
+    };
+
+    struct Options {
+        Priority priority = DefaultPriority;
+        int schedulerCpu = -1;
+        int hookCpu = -1;
+        bool isTimerResolution = true;
+    };
+
+    static constexpr unsigned int timerResolution = 1;
+
+    static SchedulingPolicy* getInstance();
+    static bool parsePriority(const QString& name, Priority& priority);
+
+    void setOptions(const Options& newOptions);
+    Options getOptions();
+    void applyToCurrentThread(Role role);
+    void beginTimerResolution();
+    void endTimerResolution();
+    QStringList getReport();
+
+private:
+    QMutex mutex;
+    Options options;
+    QStringList report;
+    int timerResolutionUsers = 0;
+    bool isTimerResolutionHeld = false;
+    bool isPriorityClassApplied = false;
+    bool isRealTimeClass = false;
+
+    void applyPriority(const Options& current, Role role, const QString& thread);
+    void applyAffinity(int cpu, const QString& thread);
+    void addReport(const QString& message);
+};
+
+#endif // SCHEDULINGPOLICY_H
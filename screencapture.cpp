@@ -0,0 +1,429 @@
+#include "screencapture.h"
+#include <QDeadlineTimer>
+
+/**
+ * @brief Shared screen capture service used by every screen-aware feature.
+ *
+ * @details Consumers register the regions they need; the service grabs the union of all regions at a
+ * configurable rate on its own thread into a small pool of reusable buffers. Consumers obtain the newest frame
+ * as a reference-counted CaptureFrame and read their region through view(), which wraps the buffer memory
+ * without copying. A buffer is only rewritten once no CaptureFrame refers to it, and buffers are only
+ * (re)allocated when the captured region grows, so steady-state capturing neither allocates nor copies per frame.
+ * The achieved capture rate and the average cost of one grab are published once per second.
+ */
+
+ScreenCapture* ScreenCapture::instance = nullptr;
+
+ScreenCapture* ScreenCapture::getInstance()
+{
+    if (!instance)
+    {
+        instance = new ScreenCapture();
+    }
+    return instance;
+}
+
+ScreenCapture::ScreenCapture(QObject *parent) : QObject(parent),
+    captureThread(new QThread()),
+    captureTimer(new QTimer(this)),
+    frameSource(new GdiFrameSource()),
+    latestIndex(-1),
+    nextRegionId(1),
+    frameSequence(0),
+    frameRate(60),
+    windowFrames(0),
+    windowCost(0),
+    windowStart(0),
+    captureRate(0.0),
+    frameCost(0.0)
+{
+    captureTimer->setTimerType(Qt::PreciseTimer);
+    connect(captureTimer, &QTimer::timeout, this, &ScreenCapture::captureFrame);
+
+    moveToThread(captureThread);
+    captureThread->start();
+}
+
+ScreenCapture::~ScreenCapture()
+{
+    if (captureThread->isRunning())
+    {
+        captureThread->quit();
+        captureThread->wait();
+    }
+
+    for (CaptureBuffer& buffer : buffers)
+    {
+        if (buffer.bits != nullptr)
+        {
+            frameSource->release(buffer);
+        }
+    }
+
+    delete frameSource;
+    delete captureThread;
+    instance = nullptr;
+}
+
+/**
+ * @brief Registers a region of interest in virtual desktop pixels.
+ *
+ * @param region The region the caller wants to read from captured frames.
+ * @return An id to pass to removeRegion() once the region is no longer needed.
+ */
+
+int ScreenCapture::addRegion(const QRect& region)
+{
+    int regionId;
+    {
+        QMutexLocker locker(&poolMutex);
+        regionId = nextRegionId++;
+        regions.insert(regionId, region);
+        captureRegion = captureRegion.united(region);
+    }
+
+    QMetaObject::invokeMethod(this, "updateTimer", Qt::QueuedConnection);
+    return regionId;
+}
+
+/**
+ * @brief Unregisters a region; capturing stops once no region is left.
+ *
+ * @param regionId The id returned by addRegion().
+ */
+
+void ScreenCapture::removeRegion(int regionId)
+{
+    {
+        QMutexLocker locker(&poolMutex);
+        regions.remove(regionId);
+        captureRegion = QRect();
+        for (const QRect& region : std::as_const(regions))
+        {
+            captureRegion = captureRegion.united(region);
+        }
+    }
+
+    QMetaObject::invokeMethod(this, "updateTimer", Qt::QueuedConnection);
+}
+
+/**
+ * @brief Sets how many frames per second are captured while any region is registered.
+ */
+
+void ScreenCapture::setFrameRate(int framesPerSecond)
+{
+    frameRate = qBound(1, framesPerSecond, 1000);
+    QMetaObject::invokeMethod(this, "updateTimer", Qt::QueuedConnection);
+}
+
+/**
+ * @brief Replaces the frame source, e.g. with a SyntheticFrameSource for tests. Takes ownership of the source.
+ *
+ * @details Must not be called while CaptureFrame objects are held or from the capture thread itself.
+ */
+
+void ScreenCapture::setFrameSource(FrameSource *source)
+{
+    QMetaObject::invokeMethod(this, [this, source]()
+    {
+        QMutexLocker locker(&poolMutex);
+        for (CaptureBuffer& buffer : buffers)
+        {
+            if (buffer.bits != nullptr)
+            {
+                frameSource->release(buffer);
+            }
+        }
+        latestIndex = -1;
+
+        delete frameSource;
+        frameSource = source;
+    }, Qt::BlockingQueuedConnection);
+}
+
+/**
+ * @brief Returns the newest captured frame, or an invalid frame if nothing has been captured yet.
+ */
+
+CaptureFrame ScreenCapture::latestFrame()
+{
+    QMutexLocker locker(&poolMutex);
+    if (latestIndex < 0)
+    {
+        return CaptureFrame();
+    }
+
+    ++buffers[latestIndex].references;
+    return CaptureFrame(this, latestIndex);
+}
+
+/**
+ * @brief Returns the capture rate achieved during the last full second, in frames per second.
+ */
+
+double ScreenCapture::getCaptureRate() const
+{
+    return captureRate.load();
+}
+
+/**
+ * @brief Returns the average cost of one grab during the last full second, in milliseconds.
+ */
+
+double ScreenCapture::getFrameCost() const
+{
+    return frameCost.load();
+}
+
+/**
+ * @brief Starts, restarts or stops the capture timer; runs on the capture thread.
+ */
+
+void ScreenCapture::updateTimer()
+{
+    bool hasRegions;
+    {
+        QMutexLocker locker(&poolMutex);
+        hasRegions = !regions.isEmpty();
+    }
+
+    if (!hasRegions)
+    {
+        captureTimer->stop();
+        return;
+    }
+
+    int interval = 1000 / frameRate.load();
+    if (!captureTimer->isActive() || captureTimer->interval() != interval)
+    {
+        captureTimer->start(interval);
+    }
+}
+
+/**
+ * @brief Picks a buffer that is neither the latest frame nor referenced by a consumer and marks it as being written.
+ *
+ * @return The buffer index, or -1 if all buffers are in use.
+ */
+
+int ScreenCapture::acquireWritableBuffer()
+{
+    QMutexLocker locker(&poolMutex);
+    for (int index = 0; index < poolSize; ++index)
+    {
+        CaptureBuffer& buffer = buffers[index];
+        if (index != latestIndex && buffer.references == 0 && !buffer.isWriting)
+        {
+            buffer.isWriting = true;
+            return index;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Grabs the union of all registered regions into a free buffer and publishes it as the latest frame.
+ *
+ * @details When every buffer is held by consumers the frame is dropped instead of waiting.
+ */
+
+void ScreenCapture::captureFrame()
+{
+    QRect region;
+    {
+        QMutexLocker locker(&poolMutex);
+        region = captureRegion;
+    }
+
+    int index = acquireWritableBuffer();
+    if (region.isEmpty() || index < 0)
+    {
+        if (index >= 0)
+        {
+            QMutexLocker locker(&poolMutex);
+            buffers[index].isWriting = false;
+        }
+        return;
+    }
+
+    CaptureBuffer& buffer = buffers[index];
+    if (buffer.capacity.width() < region.width() || buffer.capacity.height() < region.height())
+    {
+        QSize capacity = region.size().expandedTo(buffer.capacity);
+        if (buffer.bits != nullptr)
+        {
+            frameSource->release(buffer);
+        }
+        frameSource->allocate(buffer, capacity);
+        buffer.isWriting = true;
+    }
+
+    qint64 grabStart = QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs();
+    bool isGrabbed = frameSource->grab(buffer, region);
+    qint64 grabEnd = QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs();
+
+    {
+        QMutexLocker locker(&poolMutex);
+        buffer.isWriting = false;
+        if (isGrabbed)
+        {
+            buffer.sequence = ++frameSequence;
+            buffer.timestamp = grabStart;
+            latestIndex = index;
+        }
+    }
+
+    if (windowFrames == 0)
+    {
+        windowStart = grabStart;
+    }
+    ++windowFrames;
+    windowCost += grabEnd - grabStart;
+
+    if (grabEnd - windowStart >= 1000000000)
+    {
+        captureRate = windowFrames * 1e9 / (grabEnd - windowStart);
+        frameCost = windowCost / 1e6 / windowFrames;
+        windowFrames = 0;
+        windowCost = 0;
+        emit metricsUpdated(captureRate.load(), frameCost.load());
+    }
+}
+
+/**
+ * @brief Adds a consumer reference to a buffer.
+ */
+
+void ScreenCapture::retainBuffer(int index)
+{
+    QMutexLocker locker(&poolMutex);
+    ++buffers[index].references;
+}
+
+/**
+ * @brief Drops a consumer reference; the buffer can be rewritten once no reference is left.
+ */
+
+void ScreenCapture::releaseBuffer(int index)
+{
+    QMutexLocker locker(&poolMutex);
+    --buffers[index].references;
+}
+
+/**
+ * @brief A reference-counted, read-only view of one captured buffer.
+ *
+ * @details Copies only add a reference. Images returned by view() point into the buffer memory and must not
+ * outlive the CaptureFrame they came from.
+ */
+
+CaptureFrame::CaptureFrame()
+    : owner(nullptr)
+    ,index(-1)
+{
+}
+
+CaptureFrame::CaptureFrame(ScreenCapture *owner, int index)
+    : owner(owner)
+    ,index(index)
+{
+}
+
+CaptureFrame::CaptureFrame(const CaptureFrame& other)
+    : owner(other.owner)
+    ,index(other.index)
+{
+    if (owner != nullptr)
+    {
+        owner->retainBuffer(index);
+    }
+}
+
+CaptureFrame& CaptureFrame::operator=(const CaptureFrame& other)
+{
+    if (this != &other)
+    {
+        if (other.owner != nullptr)
+        {
+            other.owner->retainBuffer(other.index);
+        }
+        if (owner != nullptr)
+        {
+            owner->releaseBuffer(index);
+        }
+        owner = other.owner;
+        index = other.index;
+    }
+    return *this;
+}
+
+CaptureFrame::~CaptureFrame()
+{
+    if (owner != nullptr)
+    {
+        owner->releaseBuffer(index);
+    }
+}
+
+/**
+ * @brief Checks whether the frame refers to a captured buffer.
+ */
+
+bool CaptureFrame::isValid() const
+{
+    return owner != nullptr;
+}
+
+/**
+ * @brief Returns the increasing sequence number of the frame, used to skip frames that were already processed.
+ */
+
+quint64 CaptureFrame::getSequence() const
+{
+    return isValid() ? owner->buffers[index].sequence : 0;
+}
+
+/**
+ * @brief Returns the steady clock time (QDeadlineTimer nanoseconds) at which the grab started.
+ */
+
+qint64 CaptureFrame::getTimestamp() const
+{
+    return isValid() ? owner->buffers[index].timestamp : 0;
+}
+
+/**
+ * @brief Returns the captured region in virtual desktop pixels.
+ */
+
+QRect CaptureFrame::getRegion() const
+{
+    return isValid() ? owner->buffers[index].region : QRect();
+}
+
+/**
+ * @brief Returns an image that wraps the requested region of the buffer without copying it.
+ *
+ * @param region The wanted region in virtual desktop pixels.
+ * @return The image, or a null image if the region is not fully contained in the frame.
+ */
+
+QImage CaptureFrame::view(const QRect& region) const
+{
+    if (!isValid())
+    {
+        return QImage();
+    }
+
+    const CaptureBuffer& buffer = owner->buffers[index];
+    if (!buffer.region.contains(region))
+    {
+        return QImage();
+    }
+
+    int offsetX = region.x() - buffer.region.x();
+    int offsetY = region.y() - buffer.region.y();
+    const uchar *bits = buffer.bits + offsetY * buffer.stride + offsetX * 4;
+    return QImage(bits, region.width(), region.height(), buffer.stride, QImage::Format_RGB32);
+}
@@ -0,0 +1,87 @@
+#ifndef SCREENCAPTURE_H
+#define SCREENCAPTURE_H
+
+#include "framesource.h"
+#include <QMap>
+#include <QMutex>
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <atomic>
+
+class ScreenCapture;
+
+class CaptureFrame
+{
+public:
+    CaptureFrame();
+    CaptureFrame(const CaptureFrame& other);
+    CaptureFrame& operator=(const CaptureFrame& other);
+    ~CaptureFrame();
+
+    bool isValid() const;
+    quint64 getSequence() const;
+    qint64 getTimestamp() const;
+    QRect getRegion() const;
+    QImage view(const QRect& region) const;
+
+private:
+    friend class ScreenCapture;
+    CaptureFrame(ScreenCapture *owner, int index);
+
+    ScreenCapture *owner;
+    int index;
+};
+
+class ScreenCapture : public QObject
+{
+    Q_OBJECT
+public:
+    static ScreenCapture* getInstance();
+    ~ScreenCapture();
+
+    int addRegion(const QRect& region);
+    void removeRegion(int regionId);
+    void setFrameRate(int framesPerSecond);
+    void setFrameSource(FrameSource *source);
+    CaptureFrame latestFrame();
+    double getCaptureRate() const;
+    double getFrameCost() const;
+
+private:
+    explicit ScreenCapture(QObject *parent = nullptr);
+    static ScreenCapture* instance;
+    static constexpr int poolSize = 3;
+
+    friend class CaptureFrame;
+    void retainBuffer(int index);
+    void releaseBuffer(int index);
+    int acquireWritableBuffer();
+
+    QThread *captureThread;
+    QTimer *captureTimer;
+    FrameSource *frameSource;
+    QMutex poolMutex;
+    CaptureBuffer buffers[poolSize];
+    int latestIndex;
+    QMap<int, QRect> regions;
+    QRect captureRegion;
+    int nextRegionId;
+    quint64 frameSequence;
+    std::atomic<int> frameRate;
+
+    int windowFrames;
+    qint64 windowCost;
+    qint64 windowStart;
+    std::atomic<double> captureRate;
+    std::atomic<double> frameCost;
+
+private slots:
+    void captureFrame();
+    void updateTimer();
+
+signals:
+    void metricsUpdated(double captureRate, double frameCost);
+};
+
+#endif // SCREENCAPTURE_H
@@ -0,0 +1,127 @@
+#include "screenlayout.h"
+#include <QGuiApplication>
+#include <QScreen>
+#include <Windows.h>
+#include <ShellScalingApi.h>
+
+/**
+ * @brief Caches the virtual desktop layout: every monitor with its position, size and DPI.
+ *
+ * @details The layout is read from the Windows monitor API in physical pixels, the same coordinate space as
+ * GetCursorPos() and the values stored in LineEdit_X/Y, so monitors left of or above the primary one keep their
+ * negative offsets. It is only refreshed when Qt reports a screen change; readers get an immutable snapshot,
+ * so the click path never queries the system and never takes a lock.
+ */
+
+ScreenLayout* ScreenLayout::instance = nullptr;
+
+ScreenLayout* ScreenLayout::getInstance()
+{
+    if (!instance)
+    {
+        instance = new ScreenLayout();
+    }
+    return instance;
+}
+
+ScreenLayout::ScreenLayout(QObject *parent) : QObject(parent)
+{
+    connect(qApp, &QGuiApplication::screenAdded, this, [this](QScreen *screen)
+    {
+        watchScreen(screen);
+        refresh();
+    });
+    connect(qApp, &QGuiApplication::screenRemoved, this, &ScreenLayout::refresh);
+    connect(qApp, &QGuiApplication::primaryScreenChanged, this, &ScreenLayout::refresh);
+
+    for (QScreen *screen : QGuiApplication::screens())
+    {
+        watchScreen(screen);
+    }
+    refresh();
+}
+
+/**
+ * @brief Refreshes the cache whenever the geometry or DPI of the given screen changes.
+ */
+
+void ScreenLayout::watchScreen(QScreen *screen)
+{
+    connect(screen, &QScreen::geometryChanged, this, &ScreenLayout::refresh);
+    connect(screen, &QScreen::logicalDotsPerInchChanged, this, &ScreenLayout::refresh);
+}
+
+/**
+ * @brief Returns the current layout; the snapshot stays valid even if the layout changes afterwards.
+ */
+
+std::shared_ptr<const ScreenLayout::Snapshot> ScreenLayout::snapshot() const
+{
+    return std::atomic_load(&current);
+}
+
+/**
+ * @brief Enumerates the monitors and publishes a new layout snapshot.
+ */
+
+void ScreenLayout::refresh()
+{
+    auto layout = std::make_shared<Snapshot>();
+
+    EnumDisplayMonitors(nullptr, nullptr, [](HMONITOR handle, HDC, LPRECT, LPARAM data) -> BOOL
+    {
+        MONITORINFO info = {};
+        info.cbSize = sizeof(MONITORINFO);
+        if (GetMonitorInfo(handle, &info))
+        {
+            Monitor monitor;
+            monitor.geometry = QRect(QPoint(info.rcMonitor.left, info.rcMonitor.top),
+                                     QPoint(info.rcMonitor.right - 1, info.rcMonitor.bottom - 1));
+            monitor.isPrimary = (info.dwFlags & MONITORINFOF_PRIMARY) != 0;
+
+            UINT dpiX = 96;
+            UINT dpiY = 96;
+            if (SUCCEEDED(GetDpiForMonitor(handle, MDT_EFFECTIVE_DPI, &dpiX, &dpiY)))
+            {
+                monitor.dpi = static_cast<int>(dpiX);
+            }
+
+            reinterpret_cast<Snapshot*>(data)->monitors.append(monitor);
+        }
+        return TRUE;
+    }, reinterpret_cast<LPARAM>(layout.get()));
+
+    layout->virtualDesktop = QRect(GetSystemMetrics(SM_XVIRTUALSCREEN), GetSystemMetrics(SM_YVIRTUALSCREEN),
+                                   GetSystemMetrics(SM_CXVIRTUALSCREEN), GetSystemMetrics(SM_CYVIRTUALSCREEN));
+    for (const Monitor& monitor : std::as_const(layout->monitors))
+    {
+        if (monitor.isPrimary)
+        {
+            layout->primary = monitor.geometry;
+        }
+    }
+
+    std::atomic_store(&current, std::shared_ptr<const Snapshot>(layout));
+    emit layoutChanged();
+}
+
+/**
+ * @brief Converts a virtual desktop pixel into the normalized 0..65535 coordinates used by
+ * MOUSEEVENTF_ABSOLUTE | MOUSEEVENTF_VIRTUALDESK.
+ *
+ * @param layout The layout snapshot to convert with.
+ * @param point The point in virtual desktop pixels; points outside the desktop are clamped to its edge.
+ * @return The normalized coordinates.
+ */
+
+QPoint ScreenLayout::toAbsolute(const Snapshot& layout, const QPoint& point)
+{
+    const QRect& desktop = layout.virtualDesktop;
+    int spanX = qMax(1, desktop.width() - 1);
+    int spanY = qMax(1, desktop.height() - 1);
+    qint64 offsetX = qBound(0, point.x() - desktop.x(), spanX);
+    qint64 offsetY = qBound(0, point.y() - desktop.y(), spanY);
+
+    return QPoint(static_cast<int>((offsetX * 65535 + spanX / 2) / spanX),
+                  static_cast<int>((offsetY * 65535 + spanY / 2) / spanY));
+}
@@ -0,0 +1,47 @@
+#ifndef SCREENLAYOUT_H
+#define SCREENLAYOUT_H
+
+#include <QObject>
+#include <QPoint>
+#include <QRect>
+#include <QVector>
+#include <memory>
+
+class QScreen;
+
+class ScreenLayout : public QObject
+{
+    Q_OBJECT
+public:
+    struct Monitor {
+        QRect geometry;
+        int dpi = 96;
+        bool isPrimary = false;
+    };
+
+    struct Snapshot {
+        QVector<Monitor> monitors;
+        QRect virtualDesktop;
+        QRect primary;
+    };
+
+    static ScreenLayout* getInstance();
+
+    std::shared_ptr<const Snapshot> snapshot() const;
+    static QPoint toAbsolute(const Snapshot& layout, const QPoint& point);
+
+public slots:
+    void refresh();
+
+private:
+    explicit ScreenLayout(QObject *parent = nullptr);
+    static ScreenLayout* instance;
+    std::shared_ptr<const Snapshot> current;
+
+    void watchScreen(QScreen *screen);
+
+signals:
+    void layoutChanged();
+};
+
+#endif // SCREENLAYOUT_H
@@ -0,0 +1,88 @@
+#include "stoptoken.h"
+#include "tracer.h"
+#include <QDeadlineTimer>
+
+/**
+ * @brief Lock-free stop signal shared by everything that can end a running job.
+ *
+ * @details The hotkey consumer and the GUI request a stop directly on their own thread instead of waiting for
+ * the queued signal chain to reach the engine. The engine checks isRunning() right before every injection, so
+ * nothing is injected once the request is visible, and the wake handler posts a call to the engine thread that
+ * ends a sleeping scheduler at once. The request time is kept so the engine can measure how long stopping took.
+ * The mutex only guards replacing the wake handler against a concurrent wake-up; checking the token never locks.
+ */
+
+StopToken* StopToken::getInstance()
+{
+    static StopToken instance;
+    return &instance;
+}
+
+/**
+ * @brief Sets the function called once per stop request to wake the engine; set it before the first job starts.
+ *
+ * @param handler The wake function, or nullptr to remove it. Returns only once a wake-up that is in progress on
+ * another thread has finished, so the owner of the handler can be destroyed afterwards.
+ */
+
+void StopToken::setWakeHandler(const std::function<void()>& handler)
+{
+    QMutexLocker locker(&wakeMutex);
+    wakeHandler = handler;
+}
+
+/**
+ * @brief Marks a job as running; called by the engine when it starts a job.
+ */
+
+void StopToken::arm()
+{
+    requestTime.store(0, std::memory_order_relaxed);
+    state.store(Running, std::memory_order_release);
+}
+
+/**
+ * @brief Requests the running job to stop. Safe to call from any thread; does nothing if no job runs.
+ */
+
+void StopToken::requestStop()
+{
+    int expected = Running;
+    if (state.compare_exchange_strong(expected, StopRequested, std::memory_order_acq_rel))
+    {
+        requestTime.store(QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs(), std::memory_order_release);
+        Tracer::record(Tracer::StopRequest);
+        QMutexLocker locker(&wakeMutex);
+        if (wakeHandler)
+        {
+            wakeHandler();
+        }
+    }
+}
+
+/**
+ * @brief Marks the job as ended; called by the engine when a job completes or has stopped.
+ */
+
+void StopToken::finish()
+{
+    state.store(Idle, std::memory_order_release);
+}
+
+/**
+ * @brief Checks whether the job may still inject input.
+ */
+
+bool StopToken::isRunning() const
+{
+    return state.load(std::memory_order_acquire) == Running;
+}
+
+/**
+ * @brief Returns the time of the last stop request in steady nanoseconds, or 0 if none is pending.
+ */
+
+qint64 StopToken::getRequestTime() const
+{
+    return requestTime.load(std::memory_order_acquire);
+}
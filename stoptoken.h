@@ -0,0 +1,30 @@
+#ifndef STOPTOKEN_H
+#define STOPTOKEN_H
+
+#include <QMutex>
+#include <QtGlobal>
+#include <atomic>
+#include <functional>
+
+class StopToken
+{
+public:
+    static StopToken* getInstance();
+
+    void setWakeHandler(const std::function<void()>& handler);
+    void arm();
+    void requestStop();
+    void finish();
+    bool isRunning() const;
+    qint64 getRequestTime() const;
+
+private:
+    enum State { Idle, Running, StopRequested };
+
+    std::atomic<int> state{Idle};
+    std::atomic<qint64> requestTime{0};
+    QMutex wakeMutex;
+    std::function<void()> wakeHandler;
+};
+
+#endif // STOPTOKEN_H
@@ -0,0 +1,342 @@
+#include "stressharness.h"
+#include "engineclock.h"
+#include "inputinjector.h"
+#include "inputmanager.h"
+#include "mousemanager.h"
+#include "runconfig.h"
+#include "stoptoken.h"
+#include <QCoreApplication>
+#include <QDeadlineTimer>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QJsonArray>
+#include <QMutex>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QVector>
+
+/**
+ * @brief Stress test of the start/stop state machine under storms of hotkey presses, stop requests and edits.
+ *
+ * @details The harness drives the real InputManager and its MouseManager on the engine thread. Only two things are
+ * replaced: the engine's clock by a VirtualClock, so every timer fires at once and a job clicks as fast as the engine
+ * thread can run it, and its injector by a RecordingInjector, so nothing reaches the system. Its checkpoint file is
+ * moved to a temporary directory, so the thousands of jobs do not touch the user's. The calling thread plays the main
+ * window: it answers InputManager::initializeStartProcess with updateUserData() like MainWindow::startApplication.
+ * Several storm threads then fire randomized hotkey presses (a direct StopToken::requestStop() followed by a queued
+ * toggle, like HookWorker), stop button presses and live settings edits at a fixed rate. The injections are checked on
+ * the engine thread: no run clicks more often than its repetitions and nothing is clicked once the engine has handled
+ * a stop. The calling thread checks that a job is only ever started by a press, not by a stale finished signal. The
+ * VirtualClock counts the timers armed through it, so a second timer armed while one is active is caught. At the end
+ * a final stop must leave the engine idle with no timer armed.
+ */
+
+namespace
+{
+class Violations
+{
+public:
+    void add(const QString& violation)
+    {
+        QMutexLocker locker(&mutex);
+        if (!list.contains(violation))
+        {
+            list.append(violation);
+        }
+    }
+
+    QStringList take()
+    {
+        QMutexLocker locker(&mutex);
+        return list;
+    }
+
+private:
+    QMutex mutex;
+    QStringList list;
+};
+
+struct EngineState {
+    int repetitions = 0;
+    quint64 runClicks = 0;
+    bool isStopped = true;
+    qint64 lastRequestTime = 0;
+};
+
+struct StormCounters {
+    quint64 toggles = 0;
+    quint64 stopRequests = 0;
+    quint64 configChanges = 0;
+};
+}
+
+StressHarness::StressHarness(const Options& options)
+    : options(options)
+{
+}
+
+/**
+ * @brief Runs the storm for the configured wall time, stops the job and checks that the engine came to rest.
+ *
+ * @return Counters, throughput and every invariant that was violated.
+ *
+ * @details Must be called on the thread of the application object. The InputManager is created for the run and
+ * deleted afterwards, so it must not exist yet.
+ */
+
+StressHarness::Result StressHarness::run()
+{
+    Result result;
+    Violations violations;
+    StopToken *stopToken = StopToken::getInstance();
+    InputManager *manager = InputManager::getInstance();
+    MouseManager *engine = manager->getMouseManager();
+
+    VirtualClock clock;
+    RecordingInjector injector(clock);
+    EngineState state;
+    injector.setHandler([&state, &result, &violations](const RecordingInjector::Record& record)
+    {
+        if (record.isRelease)
+        {
+            return;
+        }
+        if (state.isStopped)
+        {
+            violations.add("a stopped job clicked");
+        }
+
+        state.runClicks += record.buttonDowns;
+        result.clicks += record.buttonDowns;
+        if (state.runClicks > static_cast<quint64>(state.repetitions))
+        {
+            violations.add("a run clicked more often than its repetitions");
+        }
+    });
+    QTemporaryDir directory;
+    QString checkpointPath = directory.filePath("checkpoint.bin");
+    QMetaObject::invokeMethod(engine, [engine, &clock, &injector, checkpointPath]()
+    {
+        engine->setClock(&clock);
+        engine->setInjector(&injector);
+        engine->setCheckpointPath(checkpointPath);
+    }, Qt::BlockingQueuedConnection);
+
+    manager->changeButton("RepetitionMode", "repeat");
+    manager->changeButton("PressType", "single");
+    manager->changeButton("LocationOption", "choosen location");
+
+    QVector<QMetaObject::Connection> connections;
+    connections.append(QObject::connect(manager, &InputManager::startApplication, engine, [&state, &result](const int&, const int&, const QChar&, const int& repetitions)
+    {
+        state.repetitions = repetitions;
+        state.runClicks = 0;
+        state.isStopped = false;
+        ++result.starts;
+    }));
+    connections.append(QObject::connect(manager, &InputManager::stopApplication, engine, [&state, &result, stopToken]()
+    {
+        state.isStopped = true;
+        ++result.stops;
+        qint64 requestTime = stopToken->getRequestTime();
+        if (requestTime != 0 && requestTime != state.lastRequestTime)
+        {
+            state.lastRequestTime = requestTime;
+            qint64 latency = QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs() - requestTime;
+            result.maxStopLatency = qMax(result.maxStopLatency, latency);
+        }
+    }));
+    connections.append(QObject::connect(engine, &MouseManager::finished, manager, [&result]()
+    {
+        ++result.finishes;
+    }));
+
+    QObject controller;
+    QRandomGenerator random(options.seed);
+    int maxRepetitions = qMax(1, options.maxRepetitions);
+    bool isPressed = false;
+    connections.append(QObject::connect(manager, &InputManager::initializeStartProcess, &controller, [manager, &random, maxRepetitions, &isPressed, &violations]()
+    {
+        if (!isPressed)
+        {
+            violations.add("the job started without a start request");
+        }
+        std::shared_ptr<const RunConfig::Snapshot> config = RunConfig::getInstance()->snapshot();
+        int repetitions = 1 + random.bounded(qMax(1, maxRepetitions >> random.bounded(14)));
+        manager->updateUserData(config->timeToClick, config->addRandomTime, repetitions, config->location, config->area);
+    }));
+    auto press = [manager, &isPressed](bool isStop)
+    {
+        isPressed = true;
+        manager->updateProcessState(isStop || manager->isProcessRunning);
+        isPressed = false;
+    };
+
+    QVector<StormCounters> counters(qMax(1, options.threads));
+    QVector<QThread *> storms;
+    qint64 duration = options.duration * 1000000;
+    qint64 interval = 1000000000LL / qMax(1, options.operationsPerSecond);
+
+    QEventLoop loop;
+    int runningStorms = counters.size();
+    QElapsedTimer wallClock;
+    wallClock.start();
+    for (int i = 0; i < counters.size(); ++i)
+    {
+        StormCounters *counter = &counters[i];
+        quint64 seed = options.seed + 1 + i;
+        storms.append(QThread::create([stopToken, manager, &controller, &press, &wallClock, counter, seed, duration, interval]()
+        {
+            QRandomGenerator random(seed);
+            qint64 scheduled = 0;
+            while (wallClock.nsecsElapsed() < duration)
+            {
+                int operation = random.bounded(8);
+                if (operation < 4)
+                {
+                    stopToken->requestStop();
+                    QMetaObject::invokeMethod(&controller, [&press]()
+                    {
+                        press(false);
+                    }, Qt::QueuedConnection);
+                    ++counter->toggles;
+                } else if (operation < 6)
+                {
+                    int fixedTime = random.bounded(6);
+                    int randomTime = random.bounded(3);
+                    QPoint location(random.bounded(1920), random.bounded(1080));
+                    int area = random.bounded(50);
+                    QMetaObject::invokeMethod(&controller, [manager, fixedTime, randomTime, location, area]()
+                    {
+                        manager->updateRunConfig(fixedTime, randomTime, location, area);
+                    }, Qt::QueuedConnection);
+                    ++counter->configChanges;
+                } else
+                {
+                    QMetaObject::invokeMethod(&controller, [&press]()
+                    {
+                        press(true);
+                    }, Qt::QueuedConnection);
+                    ++counter->stopRequests;
+                }
+
+                scheduled += interval;
+                qint64 ahead = scheduled - wallClock.nsecsElapsed();
+                if (ahead > 1000000)
+                {
+                    QThread::usleep(static_cast<unsigned long>(ahead / 1000));
+                }
+            }
+        }));
+        QObject::connect(storms.last(), &QThread::finished, &loop, [&loop, &runningStorms]()
+        {
+            if (--runningStorms == 0)
+            {
+                loop.quit();
+            }
+        });
+        storms.last()->start();
+    }
+
+    loop.exec();
+    for (QThread *storm : storms)
+    {
+        storm->wait();
+        delete storm;
+    }
+    result.wallTime = wallClock.nsecsElapsed();
+
+    auto drain = [engine]()
+    {
+        for (int round = 0; round < 4; ++round)
+        {
+            QCoreApplication::processEvents();
+            QMetaObject::invokeMethod(engine, []() {}, Qt::BlockingQueuedConnection);
+        }
+    };
+
+    drain();
+    if (manager->isProcessRunning)
+    {
+        press(true);
+    }
+    drain();
+
+    quint64 clicksAtStop = 0;
+    QMetaObject::invokeMethod(engine, [&result, &clicksAtStop, stopToken, &violations]()
+    {
+        clicksAtStop = result.clicks;
+        if (stopToken->isRunning())
+        {
+            violations.add("the engine was still running after the final stop");
+        }
+    }, Qt::BlockingQueuedConnection);
+    QThread::msleep(50);
+    drain();
+
+    QMetaObject::invokeMethod(engine, [&result, &clicksAtStop, stopToken, &clock, &violations]()
+    {
+        if (result.clicks != clicksAtStop || stopToken->isRunning())
+        {
+            violations.add("the job restarted after the final stop");
+        }
+        if (clock.getMaxActiveTimers() > 1)
+        {
+            violations.add("a second timer was armed while one was active");
+        }
+        if (clock.getActiveTimers() != 0)
+        {
+            violations.add("a timer was still armed after the final stop");
+        }
+    }, Qt::BlockingQueuedConnection);
+    if (manager->isProcessRunning)
+    {
+        violations.add("the input manager considered the job running after the final stop");
+    }
+
+    for (const QMetaObject::Connection& connection : connections)
+    {
+        QObject::disconnect(connection);
+    }
+    QMetaObject::invokeMethod(engine, [engine]()
+    {
+        engine->setClock(nullptr);
+        engine->setInjector(nullptr);
+    }, Qt::BlockingQueuedConnection);
+    delete manager;
+
+    for (const StormCounters& counter : counters)
+    {
+        result.toggles += counter.toggles;
+        result.stopRequests += counter.stopRequests;
+        result.configChanges += counter.configChanges;
+    }
+    result.operations = result.toggles + result.stopRequests + result.configChanges;
+    result.violations = violations.take();
+    return result;
+}
+
+/**
+ * @brief Converts the result into a JSON object, including the achieved operation rate.
+ */
+
+QJsonObject StressHarness::Result::toJson() const
+{
+    double wallSeconds = qMax<qint64>(1, wallTime) / 1e9;
+
+    QJsonObject json;
+    json["operations"] = static_cast<double>(operations);
+    json["operationsPerSecond"] = operations / wallSeconds;
+    json["toggles"] = static_cast<double>(toggles);
+    json["stopRequests"] = static_cast<double>(stopRequests);
+    json["configChanges"] = static_cast<double>(configChanges);
+    json["starts"] = static_cast<double>(starts);
+    json["stops"] = static_cast<double>(stops);
+    json["finishes"] = static_cast<double>(finishes);
+    json["clicks"] = static_cast<double>(clicks);
+    json["maxStopLatencyMs"] = maxStopLatency / 1e6;
+    json["wallTimeMs"] = wallTime / 1e6;
+    json["violations"] = QJsonArray::fromStringList(violations);
+    return json;
+}
@@ -0,0 +1,42 @@
+#ifndef STRESSHARNESS_H
+#define STRESSHARNESS_H
+
+#include <QJsonObject>
+#include <QStringList>
+
+class StressHarness
+{
+public:
+    struct Options {
+        int threads = 4;
+        int operationsPerSecond = 2000;
+        qint64 duration = 5000;
+        quint64 seed = 1;
+        int maxRepetitions = 20000;
+    };
+
+    struct Result {
+        quint64 operations = 0;
+        quint64 toggles = 0;
+        quint64 stopRequests = 0;
+        quint64 configChanges = 0;
+        quint64 starts = 0;
+        quint64 stops = 0;
+        quint64 finishes = 0;
+        quint64 clicks = 0;
+        qint64 maxStopLatency = 0;
+        qint64 wallTime = 0;
+        QStringList violations;
+
+        QJsonObject toJson() const;
+    };
+
+    explicit StressHarness(const Options& options);
+
+    Result run();
+
+private:
+    Options options;
+};
+
+#endif // STRESSHARNESS_H
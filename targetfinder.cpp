@@ -0,0 +1,444 @@
+#include "targetfinder.h"
+#include <QElapsedTimer>
+#include <QThread>
+#include <QtMath>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TARGETFINDER_USE_SSE2
+#endif
+
+/**
+ * @brief Locates a reference image (template) inside a screen capture and reports the centre of the best match.
+ *
+ * @details The search runs coarse-to-fine over an image pyramid: the smallest level is scanned exhaustively,
+ * split into horizontal tiles that run on a private thread pool, and the best few candidates are then refined
+ * level by level inside a small window around their up-scaled position. Similarity is the normalized
+ * cross-correlation (NCC); window sums come from integral images and the template dot product uses SSE2
+ * where available. All buffers are kept between calls, so repeated searches on same-sized frames do not allocate.
+ */
+
+TargetFinder::TargetFinder(QObject *parent)
+    : QObject{parent}
+    ,minimumScore(0.8)
+    ,lastSearchTime(0.0)
+{
+    tilePool.setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
+}
+
+TargetFinder::~TargetFinder()
+{
+    tilePool.waitForDone();
+}
+
+/**
+ * @brief Sets the reference image searched for by locate() and precomputes its pyramid.
+ *
+ * @param image The template image, usually cut from an earlier screenshot.
+ * @return True if the image is usable as a template; otherwise, false.
+ */
+
+bool TargetFinder::setTemplateImage(const QImage& image)
+{
+    templatePyramid.clear();
+    templateMean.clear();
+    templateDeviation.clear();
+
+    if (image.isNull() || image.width() < minTemplateSide || image.height() < minTemplateSide)
+    {
+        return false;
+    }
+
+    GrayPlane level;
+    convertToGray(image, level);
+    templatePyramid.append(level);
+
+    while (templatePyramid.size() < maxPyramidLevels)
+    {
+        const GrayPlane& previous = templatePyramid.last();
+        if (previous.width / 2 < minTemplateSide || previous.height / 2 < minTemplateSide)
+        {
+            break;
+        }
+        GrayPlane next;
+        downsample(previous, next);
+        templatePyramid.append(next);
+    }
+
+    for (const GrayPlane& plane : templatePyramid)
+    {
+        double count = static_cast<double>(plane.width) * plane.height;
+        double sum = 0.0;
+        double sumSquared = 0.0;
+        for (quint8 value : plane.pixels)
+        {
+            sum += value;
+            sumSquared += static_cast<double>(value) * value;
+        }
+        double mean = sum / count;
+        templateMean.append(mean);
+        templateDeviation.append(qSqrt(qMax(0.0, sumSquared - count * mean * mean)));
+    }
+
+    return true;
+}
+
+/**
+ * @brief Checks whether a template has been set.
+ */
+
+bool TargetFinder::hasTemplate() const
+{
+    return !templatePyramid.isEmpty();
+}
+
+/**
+ * @brief Sets the minimal NCC score (0..1) a match needs to be reported.
+ */
+
+void TargetFinder::setMinimumScore(double score)
+{
+    minimumScore = qBound(0.0, score, 1.0);
+}
+
+/**
+ * @brief Returns the duration of the last locate() call in milliseconds.
+ */
+
+double TargetFinder::getLastSearchTime() const
+{
+    return lastSearchTime;
+}
+
+/**
+ * @brief Searches the frame for the template.
+ *
+ * @param frame The captured screen image.
+ * @param matchCenter Receives the centre of the best match in frame pixel coordinates.
+ * @param matchScore Receives the NCC score of the best match.
+ * @return True if a match scoring at least the minimal score was found; otherwise, false.
+ */
+
+bool TargetFinder::locate(const QImage& frame, QPoint& matchCenter, double& matchScore)
+{
+    QElapsedTimer searchTimer;
+    searchTimer.start();
+    matchScore = -1.0;
+
+    int levels = pyramidLevelsFor(frame);
+    if (levels == 0)
+    {
+        lastSearchTime = searchTimer.nsecsElapsed() / 1e6;
+        return false;
+    }
+
+    if (framePyramid.size() < levels)
+    {
+        framePyramid.resize(levels);
+    }
+    convertToGray(frame, framePyramid[0]);
+    for (int level = 1; level < levels; ++level)
+    {
+        downsample(framePyramid[level - 1], framePyramid[level]);
+    }
+
+    int topLevel = levels - 1;
+    QVector<Candidate> candidates;
+    searchCoarseLevel(topLevel, candidates);
+
+    Candidate best;
+    for (Candidate candidate : candidates)
+    {
+        for (int level = topLevel - 1; level >= 0; --level)
+        {
+            const GrayPlane& plane = framePyramid[level];
+            const GrayPlane& pattern = templatePyramid[level];
+            int centerX = candidate.x * 2;
+            int centerY = candidate.y * 2;
+            Candidate refined;
+
+            for (int y = qMax(0, centerY - refineRadius); y <= qMin(plane.height - pattern.height, centerY + refineRadius); ++y)
+            {
+                for (int x = qMax(0, centerX - refineRadius); x <= qMin(plane.width - pattern.width, centerX + refineRadius); ++x)
+                {
+                    double score = scoreAt(level, x, y);
+                    if (score > refined.score)
+                    {
+                        refined = {x, y, score};
+                    }
+                }
+            }
+            candidate = refined;
+        }
+
+        if (candidate.score > best.score)
+        {
+            best = candidate;
+        }
+    }
+
+    lastSearchTime = searchTimer.nsecsElapsed() / 1e6;
+
+    if (best.x < 0)
+    {
+        return false;
+    }
+
+    matchScore = best.score;
+    matchCenter = QPoint(best.x + templatePyramid[0].width / 2, best.y + templatePyramid[0].height / 2);
+    return matchScore >= minimumScore;
+}
+
+/**
+ * @brief Returns how many pyramid levels can be used for the given frame, or 0 if the template does not fit.
+ */
+
+int TargetFinder::pyramidLevelsFor(const QImage& frame) const
+{
+    int levels = 0;
+    int frameWidth = frame.width();
+    int frameHeight = frame.height();
+
+    for (const GrayPlane& pattern : templatePyramid)
+    {
+        if (pattern.width > frameWidth || pattern.height > frameHeight)
+        {
+            break;
+        }
+        ++levels;
+        frameWidth /= 2;
+        frameHeight /= 2;
+    }
+    return levels;
+}
+
+/**
+ * @brief Exhaustively scans the coarsest pyramid level, split into row tiles that run in parallel.
+ *
+ * @param level The pyramid level to scan.
+ * @param best Receives the best, mutually separated candidates ordered by descending score.
+ */
+
+void TargetFinder::searchCoarseLevel(int level, QVector<Candidate>& best)
+{
+    const GrayPlane& plane = framePyramid[level];
+    const GrayPlane& pattern = templatePyramid[level];
+    int rows = plane.height - pattern.height + 1;
+    int columns = plane.width - pattern.width + 1;
+    int separation = qMax(pattern.width, pattern.height) / 2;
+    int tileCount = qBound(1, rows / 8, tilePool.maxThreadCount());
+
+    QVector<QVector<Candidate>> tileResults(tileCount);
+
+    for (int tile = 0; tile < tileCount; ++tile)
+    {
+        int firstRow = rows * tile / tileCount;
+        int lastRow = rows * (tile + 1) / tileCount;
+        QVector<Candidate>* result = &tileResults[tile];
+
+        tilePool.start([this, level, firstRow, lastRow, columns, separation, result]()
+        {
+            result->reserve(coarseCandidates);
+            for (int y = firstRow; y < lastRow; ++y)
+            {
+                for (int x = 0; x < columns; ++x)
+                {
+                    insertCandidate(*result, {x, y, scoreAt(level, x, y)}, separation);
+                }
+            }
+        });
+    }
+    tilePool.waitForDone();
+
+    best.clear();
+    best.reserve(coarseCandidates);
+    for (const QVector<Candidate>& result : tileResults)
+    {
+        for (const Candidate& candidate : result)
+        {
+            insertCandidate(best, candidate, separation);
+        }
+    }
+}
+
+/**
+ * @brief Keeps the list sorted by score, limited to coarseCandidates entries that lie at least separation apart.
+ */
+
+void TargetFinder::insertCandidate(QVector<Candidate>& best, const Candidate& candidate, int separation)
+{
+    for (int i = 0; i < best.size(); ++i)
+    {
+        if (qAbs(best[i].x - candidate.x) < separation && qAbs(best[i].y - candidate.y) < separation)
+        {
+            if (candidate.score > best[i].score)
+            {
+                best.remove(i);
+                break;
+            }
+            return;
+        }
+    }
+
+    if (best.size() == coarseCandidates && candidate.score <= best.last().score)
+    {
+        return;
+    }
+
+    auto position = std::upper_bound(best.begin(), best.end(), candidate, [](const Candidate& a, const Candidate& b)
+    {
+        return a.score > b.score;
+    });
+    best.insert(position, candidate);
+
+    if (best.size() > coarseCandidates)
+    {
+        best.removeLast();
+    }
+}
+
+/**
+ * @brief Computes the normalized cross-correlation between the template and the frame window at (x, y).
+ *
+ * @return A score in range -1..1, 0 for flat windows.
+ */
+
+double TargetFinder::scoreAt(int level, int x, int y) const
+{
+    const GrayPlane& plane = framePyramid[level];
+    const GrayPlane& pattern = templatePyramid[level];
+    int stride = plane.width + 1;
+
+    int top = y * stride + x;
+    int bottom = (y + pattern.height) * stride + x;
+    double windowSum = static_cast<double>(plane.sum[bottom + pattern.width]) - plane.sum[bottom]
+                       - plane.sum[top + pattern.width] + plane.sum[top];
+    double windowSumSquared = static_cast<double>(plane.sumSquared[bottom + pattern.width]) - plane.sumSquared[bottom]
+                              - plane.sumSquared[top + pattern.width] + plane.sumSquared[top];
+
+    double count = static_cast<double>(pattern.width) * pattern.height;
+    double windowVariance = windowSumSquared - windowSum * windowSum / count;
+    double denominator = templateDeviation[level] * qSqrt(qMax(0.0, windowVariance));
+    if (denominator < 1e-6)
+    {
+        return 0.0;
+    }
+
+    quint64 cross = 0;
+    const quint8* frameRow = plane.pixels.constData() + y * plane.width + x;
+    const quint8* templateRow = pattern.pixels.constData();
+    for (int row = 0; row < pattern.height; ++row)
+    {
+        cross += dotProduct(frameRow, templateRow, pattern.width);
+        frameRow += plane.width;
+        templateRow += pattern.width;
+    }
+
+    return (static_cast<double>(cross) - windowSum * templateMean[level]) / denominator;
+}
+
+/**
+ * @brief Sums the element-wise products of two 8-bit rows, 16 pixels per step when SSE2 is available.
+ */
+
+quint32 TargetFinder::dotProduct(const quint8* frameRow, const quint8* templateRow, int length)
+{
+    quint32 total = 0;
+    int i = 0;
+
+#ifdef TARGETFINDER_USE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    __m128i accumulator = _mm_setzero_si128();
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i frameBytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(frameRow + i));
+        __m128i templateBytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(templateRow + i));
+        accumulator = _mm_add_epi32(accumulator, _mm_madd_epi16(_mm_unpacklo_epi8(frameBytes, zero), _mm_unpacklo_epi8(templateBytes, zero)));
+        accumulator = _mm_add_epi32(accumulator, _mm_madd_epi16(_mm_unpackhi_epi8(frameBytes, zero), _mm_unpackhi_epi8(templateBytes, zero)));
+    }
+    accumulator = _mm_add_epi32(accumulator, _mm_shuffle_epi32(accumulator, _MM_SHUFFLE(1, 0, 3, 2)));
+    accumulator = _mm_add_epi32(accumulator, _mm_shuffle_epi32(accumulator, _MM_SHUFFLE(2, 3, 0, 1)));
+    total = static_cast<quint32>(_mm_cvtsi128_si32(accumulator));
+#endif
+
+    for (; i < length; ++i)
+    {
+        total += static_cast<quint32>(frameRow[i]) * templateRow[i];
+    }
+    return total;
+}
+
+/**
+ * @brief Converts an image into an 8-bit grayscale plane with integral images, reusing the plane's buffers.
+ */
+
+void TargetFinder::convertToGray(const QImage& image, GrayPlane& plane)
+{
+    QImage gray = image.format() == QImage::Format_Grayscale8 ? image : image.convertToFormat(QImage::Format_Grayscale8);
+
+    plane.width = gray.width();
+    plane.height = gray.height();
+    plane.pixels.resize(plane.width * plane.height);
+
+    for (int y = 0; y < plane.height; ++y)
+    {
+        std::copy_n(gray.constScanLine(y), plane.width, plane.pixels.data() + y * plane.width);
+    }
+    buildIntegrals(plane);
+}
+
+/**
+ * @brief Halves the source plane with a 2x2 box filter into the target plane.
+ */
+
+void TargetFinder::downsample(const GrayPlane& source, GrayPlane& target)
+{
+    target.width = source.width / 2;
+    target.height = source.height / 2;
+    target.pixels.resize(target.width * target.height);
+
+    for (int y = 0; y < target.height; ++y)
+    {
+        const quint8* upper = source.pixels.constData() + (2 * y) * source.width;
+        const quint8* lower = upper + source.width;
+        quint8* out = target.pixels.data() + y * target.width;
+        for (int x = 0; x < target.width; ++x)
+        {
+            out[x] = static_cast<quint8>((upper[2 * x] + upper[2 * x + 1] + lower[2 * x] + lower[2 * x + 1] + 2) / 4);
+        }
+    }
+    buildIntegrals(target);
+}
+
+/**
+ * @brief Builds the summed-area tables of values and squared values used for O(1) window statistics.
+ */
+
+void TargetFinder::buildIntegrals(GrayPlane& plane)
+{
+    int stride = plane.width + 1;
+    plane.sum.resize(stride * (plane.height + 1));
+    plane.sumSquared.resize(stride * (plane.height + 1));
+    std::fill_n(plane.sum.data(), stride, 0u);
+    std::fill_n(plane.sumSquared.data(), stride, 0ull);
+
+    for (int y = 0; y < plane.height; ++y)
+    {
+        const quint8* row = plane.pixels.constData() + y * plane.width;
+        quint32 rowSum = 0;
+        quint64 rowSumSquared = 0;
+        int above = y * stride;
+        int current = above + stride;
+
+        plane.sum[current] = 0;
+        plane.sumSquared[current] = 0;
+        for (int x = 0; x < plane.width; ++x)
+        {
+            rowSum += row[x];
+            rowSumSquared += static_cast<quint64>(row[x]) * row[x];
+            plane.sum[current + x + 1] = plane.sum[above + x + 1] + rowSum;
+            plane.sumSquared[current + x + 1] = plane.sumSquared[above + x + 1] + rowSumSquared;
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef TARGETFINDER_H
+#define TARGETFINDER_H
+
+#include <QImage>
+#include <QObject>
+#include <QPoint>
+#include <QThreadPool>
+#include <QVector>
+
+class TargetFinder : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TargetFinder(QObject *parent = nullptr);
+    ~TargetFinder();
+
+    bool setTemplateImage(const QImage& image);
+    bool hasTemplate() const;
+    void setMinimumScore(double score);
+    bool locate(const QImage& frame, QPoint& matchCenter, double& matchScore);
+    double getLastSearchTime() const;
+
+private:
+    struct GrayPlane {
+        int width = 0;
+        int height = 0;
+        QVector<quint8> pixels;
+        QVector<quint32> sum;
+        QVector<quint64> sumSquared;
+    };
+
+    struct Candidate {
+        int x = -1;
+        int y = -1;
+        double score = -1.0;
+    };
+
+    static constexpr int maxPyramidLevels = 4;
+    static constexpr int minTemplateSide = 8;
+    static constexpr int coarseCandidates = 4;
+    static constexpr int refineRadius = 2;
+
+    QVector<GrayPlane> templatePyramid;
+    QVector<GrayPlane> framePyramid;
+    QVector<double> templateMean;
+    QVector<double> templateDeviation;
+    QThreadPool tilePool;
+    double minimumScore;
+    double lastSearchTime;
+
+    static void convertToGray(const QImage& image, GrayPlane& plane);
+    static void downsample(const GrayPlane& source, GrayPlane& target);
+    static void buildIntegrals(GrayPlane& plane);
+    static quint32 dotProduct(const quint8* frameRow, const quint8* templateRow, int length);
+    double scoreAt(int level, int x, int y) const;
+    int pyramidLevelsFor(const QImage& frame) const;
+    void searchCoarseLevel(int level, QVector<Candidate>& best);
+    static void insertCandidate(QVector<Candidate>& best, const Candidate& candidate, int separation);
+};
+
+#endif // TARGETFINDER_H
@@ -0,0 +1,351 @@
+#include "tracer.h"
+#include <QCoreApplication>
+#include <QDeadlineTimer>
+#include <QHash>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <cstring>
+#include <limits>
+
+/**
+ * @brief Low-overhead binary event trace of the engine, the input listener and the scheduler.
+ *
+ * @details record() is a relaxed atomic load while tracing is off. While it is on, every thread appends
+ * fixed-size records to its own single-producer/single-consumer buffer, registered on the thread's first
+ * record, so recording takes no lock and never allocates. A writer thread drains all buffers every
+ * flushInterval and appends the records to the trace file; a buffer that is full drops records and counts
+ * them instead of blocking. exportChromeJson() converts a trace file into the Chrome trace event format,
+ * which chrome://tracing and Perfetto display.
+ */
+
+Tracer* Tracer::instance = nullptr;
+std::atomic<bool> Tracer::isEnabled{false};
+thread_local TraceBuffer* Tracer::localBuffer = nullptr;
+
+/**
+ * @brief Appends a record; called by the owning thread only.
+ *
+ * @return True if the record was queued; false if the buffer is full.
+ */
+
+bool TraceBuffer::push(const TraceRecord& record)
+{
+    quint32 write = head.load(std::memory_order_relaxed);
+    if (write - tail.load(std::memory_order_acquire) >= capacity)
+    {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    records[write % capacity] = record;
+    head.store(write + 1, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Removes the oldest record; called by the writer thread only.
+ *
+ * @return True if a record was available; otherwise, false.
+ */
+
+bool TraceBuffer::pop(TraceRecord& record)
+{
+    quint32 read = tail.load(std::memory_order_relaxed);
+    if (read == head.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    record = records[read % capacity];
+    tail.store(read + 1, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Returns the number of records lost because the writer fell behind.
+ */
+
+quint64 TraceBuffer::getDroppedCount() const
+{
+    return dropped.load(std::memory_order_relaxed);
+}
+
+Tracer* Tracer::getInstance()
+{
+    if (!instance)
+    {
+        instance = new Tracer();
+    }
+    return instance;
+}
+
+Tracer::Tracer(QObject *parent) : QObject(parent),
+    writerThread(new QThread()),
+    flushTimer(new QTimer(this))
+{
+    writerThread->setObjectName("TraceWriter");
+    flushTimer->setInterval(flushInterval);
+    connect(flushTimer, &QTimer::timeout, this, &Tracer::flush);
+    moveToThread(writerThread);
+    writerThread->start(QThread::LowPriority);
+}
+
+Tracer::~Tracer()
+{
+    stop();
+    writerThread->quit();
+    writerThread->wait();
+    delete writerThread;
+    qDeleteAll(buffers);
+    instance = nullptr;
+}
+
+/**
+ * @brief Starts writing a new trace file.
+ *
+ * @param filePath The trace file; overwritten.
+ * @return True if the file could be created; otherwise, false.
+ */
+
+bool Tracer::start(const QString& filePath)
+{
+    bool isOpen = false;
+    QMetaObject::invokeMethod(this, [this, &filePath, &isOpen]()
+    {
+        file.setFileName(filePath);
+        isOpen = file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+        if (isOpen)
+        {
+            file.write(fileMagic, sizeof(fileMagic));
+            flushTimer->start();
+        }
+    }, Qt::BlockingQueuedConnection);
+
+    isEnabled.store(isOpen, std::memory_order_relaxed);
+    return isOpen;
+}
+
+/**
+ * @brief Stops tracing and writes the remaining records.
+ */
+
+void Tracer::stop()
+{
+    if (!isEnabled.exchange(false, std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    QMetaObject::invokeMethod(this, [this]()
+    {
+        flushTimer->stop();
+        flush();
+        file.close();
+    }, Qt::BlockingQueuedConnection);
+}
+
+/**
+ * @brief Writes the records buffered so far and returns once they are in the file.
+ *
+ * @details Blocks on the writer thread, so it must not be called from there.
+ */
+
+void Tracer::drain()
+{
+    QMetaObject::invokeMethod(this, &Tracer::flush, Qt::BlockingQueuedConnection);
+}
+
+/**
+ * @brief Returns the number of records dropped by all threads.
+ */
+
+quint64 Tracer::getDroppedCount()
+{
+    QMutexLocker locker(&bufferMutex);
+    quint64 dropped = 0;
+    for (const TraceBuffer *buffer : std::as_const(buffers))
+    {
+        dropped += buffer->getDroppedCount();
+    }
+    return dropped;
+}
+
+/**
+ * @brief Appends a record to the calling thread's buffer.
+ */
+
+void Tracer::append(Type type, qint64 a, qint64 b)
+{
+    TraceBuffer *buffer = localBuffer ? localBuffer : registerThread();
+
+    TraceRecord record;
+    record.timestamp = QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs();
+    record.type = type;
+    record.thread = 0;
+    record.reserved = 0;
+    record.a = a;
+    record.b = b;
+    buffer->push(record);
+}
+
+/**
+ * @brief Creates the buffer of the calling thread and records the thread's name.
+ *
+ * @details The thread index is stored in every record by the writer, so the hot path does not need to know it.
+ * The first record of every buffer carries up to 16 characters of the thread's object name.
+ */
+
+TraceBuffer* Tracer::registerThread()
+{
+    TraceBuffer *buffer = new TraceBuffer();
+    {
+        QMutexLocker locker(&bufferMutex);
+        buffers.append(buffer);
+    }
+    localBuffer = buffer;
+
+    QByteArray name = QThread::currentThread()->objectName().toUtf8().left(16);
+    if (name.isEmpty())
+    {
+        bool isMainThread = QCoreApplication::instance() && QThread::currentThread() == QCoreApplication::instance()->thread();
+        name = isMainThread ? "Main" : "Thread";
+    }
+
+    TraceRecord record = {};
+    record.timestamp = QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs();
+    record.type = ThreadName;
+    char packed[16] = {};
+    std::memcpy(packed, name.constData(), name.size());
+    std::memcpy(&record.a, packed, 8);
+    std::memcpy(&record.b, packed + 8, 8);
+    buffer->push(record);
+    return buffer;
+}
+
+/**
+ * @brief Drains all thread buffers into the trace file; runs on the writer thread.
+ */
+
+void Tracer::flush()
+{
+    if (!file.isOpen())
+    {
+        return;
+    }
+
+    QByteArray chunk;
+    QMutexLocker locker(&bufferMutex);
+    for (int index = 0; index < buffers.size(); ++index)
+    {
+        TraceRecord record;
+        while (buffers.at(index)->pop(record))
+        {
+            record.thread = static_cast<quint16>(index);
+            chunk.append(reinterpret_cast<const char*>(&record), sizeof(record));
+        }
+    }
+    locker.unlock();
+
+    if (!chunk.isEmpty())
+    {
+        file.write(chunk);
+        file.flush();
+    }
+}
+
+/**
+ * @brief Converts a binary trace file into Chrome trace event JSON.
+ *
+ * @param tracePath The binary trace file.
+ * @param output Receives the JSON document.
+ * @param errorMessage Receives a description of the error.
+ * @return True if the trace was converted; otherwise, false.
+ *
+ * @details Records become instant events on one track per thread, with timestamps in microseconds relative to
+ * the earliest record and the record operands as named arguments. Records are ordered per thread, not globally:
+ * the file holds the flushed buffers one after another, so the earliest record is found in a first pass over the
+ * file instead of taking the first one, which would give earlier records of other threads negative timestamps.
+ */
+
+bool Tracer::exportChromeJson(const QString& tracePath, QIODevice& output, QString& errorMessage)
+{
+    QFile traceFile(tracePath);
+    if (!traceFile.open(QIODevice::ReadOnly))
+    {
+        errorMessage = QString("Cannot open trace %1").arg(tracePath);
+        return false;
+    }
+
+    QByteArray magic = traceFile.read(sizeof(fileMagic));
+    if (magic != QByteArray(fileMagic, sizeof(fileMagic)))
+    {
+        errorMessage = QString("%1 is not a trace file").arg(tracePath);
+        return false;
+    }
+
+    static const char *const names[] = {"thread", "hook event", "injected event", "timer wake", "schedule", "injection", "stop request", "user pause"};
+
+    qint64 recordsStart = traceFile.pos();
+    qint64 origin = std::numeric_limits<qint64>::max();
+    TraceRecord record;
+    while (traceFile.read(reinterpret_cast<char*>(&record), sizeof(record)) == sizeof(record))
+    {
+        origin = qMin(origin, record.timestamp);
+    }
+    traceFile.seek(recordsStart);
+
+    QTextStream out(&output);
+    out << "{\"traceEvents\":[\n";
+    bool isFirst = true;
+
+    while (traceFile.read(reinterpret_cast<char*>(&record), sizeof(record)) == sizeof(record))
+    {
+        if (!isFirst)
+        {
+            out << ",\n";
+        }
+        isFirst = false;
+
+        if (record.type == ThreadName)
+        {
+            char packed[17] = {};
+            std::memcpy(packed, &record.a, 8);
+            std::memcpy(packed + 8, &record.b, 8);
+            out << QString("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%1,\"args\":{\"name\":\"%2\"}}")
+                       .arg(record.thread).arg(QString::fromUtf8(packed).remove('"').remove('\\'));
+            continue;
+        }
+
+        QString args;
+        switch (record.type)
+        {
+        case HookEvent:
+            args = QString("\"type\":%1,\"code\":%2").arg(record.a).arg(record.b);
+            break;
+        case InjectedEvent:
+            args = QString("\"sequence\":%1,\"latencyUs\":%2").arg(record.a).arg(record.b / 1000.0, 0, 'f', 3);
+            break;
+        case TimerWake:
+            args = QString("\"latenessUs\":%1").arg(record.a / 1000.0, 0, 'f', 3);
+            break;
+        case Schedule:
+            args = QString("\"waitUs\":%1,\"leadUs\":%2").arg(record.a / 1000.0, 0, 'f', 3).arg(record.b / 1000.0, 0, 'f', 3);
+            break;
+        case Injection:
+            args = QString("\"inputs\":%1,\"release\":%2").arg(record.a).arg(record.b);
+            break;
+        case UserPause:
+            args = QString("\"paused\":%1,\"resumeInUs\":%2").arg(record.a).arg(record.b / 1000.0, 0, 'f', 3);
+            break;
+        default:
+            break;
+        }
+
+        const char *name = record.type < sizeof(names) / sizeof(names[0]) ? names[record.type] : "unknown";
+        out << QString("{\"name\":\"%1\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%2,\"ts\":%3,\"args\":{%4}}")
+                   .arg(name).arg(record.thread).arg((record.timestamp - origin) / 1000.0, 0, 'f', 3).arg(args);
+    }
+
+    out << "\n]}\n";
+    return true;
+}
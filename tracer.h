@@ -0,0 +1,91 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QFile>
+#include <QMutex>
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
+#include <atomic>
+
+struct TraceRecord {
+    qint64 timestamp;
+    quint16 type;
+    quint16 thread;
+    quint32 reserved;
+    qint64 a;
+    qint64 b;
+};
+
+class TraceBuffer
+{
+public:
+    static constexpr quint32 capacity = 16384;
+
+    bool push(const TraceRecord& record);
+    bool pop(TraceRecord& record);
+    quint64 getDroppedCount() const;
+
+private:
+    TraceRecord records[capacity];
+    std::atomic<quint32> head{0};
+    std::atomic<quint32> tail{0};
+    std::atomic<quint64> dropped{0};
+};
+
+class Tracer : public QObject
+{
+    Q_OBJECT
+public:
+    enum Type : quint16 {
+        ThreadName,
+        HookEvent,
+        InjectedEvent,
+        TimerWake,
+        Schedule,
+        Injection,
+        StopRequest,
+        UserPause
+    };
+
+    static Tracer* getInstance();
+    ~Tracer();
+
+    bool start(const QString& filePath);
+    void stop();
+    void drain();
+    quint64 getDroppedCount();
+
+    static void record(Type type, qint64 a = 0, qint64 b = 0)
+    {
+        if (isEnabled.load(std::memory_order_relaxed))
+        {
+            getInstance()->append(type, a, b);
+        }
+    }
+
+    static bool exportChromeJson(const QString& tracePath, QIODevice& output, QString& errorMessage);
+
+private:
+    explicit Tracer(QObject *parent = nullptr);
+    static Tracer* instance;
+    static std::atomic<bool> isEnabled;
+    static thread_local TraceBuffer *localBuffer;
+    static constexpr int flushInterval = 50;
+    static constexpr char fileMagic[8] = {'A', 'C', 'T', 'R', 'A', 'C', 'E', '1'};
+
+    QThread *writerThread;
+    QTimer *flushTimer;
+    QFile file;
+    QMutex bufferMutex;
+    QVector<TraceBuffer*> buffers;
+
+    void append(Type type, qint64 a, qint64 b);
+    TraceBuffer* registerThread();
+
+private slots:
+    void flush();
+};
+
+#endif // TRACER_H
@@ -0,0 +1,142 @@
+#include "useroverride.h"
+#include <QDeadlineTimer>
+
+/**
+ * @brief Detects when the operator takes over the mouse so a running job can step aside.
+ *
+ * @details The detector is an InputListener consumer for user mouse events and for the application's own injected
+ * events. Injected events only move the anchor position, so the engine's moves and clicks never count as user
+ * activity. A user movement counts once the cursor is more than moveThreshold pixels away from the anchor, which
+ * ignores sensor jitter; a user button press or release always counts. Activity only stores its time in an atomic,
+ * so no signal is emitted per event: the engine checks isActive() before every step of the VM, so no step starting
+ * after the event reaches the listener injects anything, and resumes once the mouse has been idle for the idle time.
+ */
+
+UserOverride* UserOverride::getInstance()
+{
+    static UserOverride instance;
+    return &instance;
+}
+
+/**
+ * @brief Starts or stops receiving mouse events; while watching, the listener captures mouse events.
+ */
+
+void UserOverride::setWatching(bool enabled)
+{
+    if (enabled == isWatching)
+    {
+        return;
+    }
+
+    isWatching = enabled;
+    if (enabled)
+    {
+        hasAnchor = false;
+        InputListener::getInstance()->addConsumer(this, InputListener::MouseEvents | InputListener::InjectedEvents);
+    } else
+    {
+        InputListener::getInstance()->removeConsumer(this);
+    }
+}
+
+/**
+ * @brief Sets how long the mouse has to stay idle before the job resumes.
+ *
+ * @param milliseconds The idle time in milliseconds.
+ */
+
+void UserOverride::setIdleTime(int milliseconds)
+{
+    idleTime.store(static_cast<qint64>(qMax(0, milliseconds)) * 1000000, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Forgets earlier activity, e.g. the click on the start button, and the pause state.
+ */
+
+void UserOverride::clear()
+{
+    lastActivity.store(0, std::memory_order_relaxed);
+    paused.store(false, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Checks whether the user has used the mouse within the idle time.
+ */
+
+bool UserOverride::isActive() const
+{
+    qint64 activity = lastActivity.load(std::memory_order_acquire);
+    return activity != 0 && QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs() - activity < idleTime.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Returns the steady time in nanoseconds at which the job may resume if the mouse stays idle.
+ */
+
+qint64 UserOverride::getResumeTime() const
+{
+    return lastActivity.load(std::memory_order_acquire) + idleTime.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Publishes whether the engine is paused; called by the engine when it pauses or resumes.
+ */
+
+void UserOverride::setPaused(bool paused)
+{
+    if (paused && !this->paused.load(std::memory_order_relaxed))
+    {
+        pauseCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    this->paused.store(paused, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Checks whether the running job is paused for the user.
+ */
+
+bool UserOverride::isPaused() const
+{
+    return paused.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Returns how often a job has been paused for the user since the application started.
+ */
+
+quint64 UserOverride::getPauseCount() const
+{
+    return pauseCount.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Records user activity; injected events only move the anchor.
+ */
+
+void UserOverride::inputEvent(const InputEvent& event)
+{
+    if (event.type == InputEvent::KeyDown || event.type == InputEvent::KeyUp)
+    {
+        return;
+    }
+
+    if (event.isInjected || !hasAnchor)
+    {
+        anchor = event.position;
+        hasAnchor = true;
+        if (event.isInjected || event.type == InputEvent::MouseMove)
+        {
+            return;
+        }
+    }
+
+    if (event.type == InputEvent::MouseMove && (event.position - anchor).manhattanLength() <= moveThreshold)
+    {
+        return;
+    }
+
+    anchor = event.position;
+    lastActivity.store(event.timestamp, std::memory_order_release);
+}
@@ -0,0 +1,37 @@
+#ifndef USEROVERRIDE_H
+#define USEROVERRIDE_H
+
+#include "inputlistener.h"
+#include <QPoint>
+#include <QtGlobal>
+#include <atomic>
+
+class UserOverride : public InputConsumer
+{
+public:
+    static constexpr int moveThreshold = 3;
+
+    static UserOverride* getInstance();
+
+    void setWatching(bool enabled);
+    void setIdleTime(int milliseconds);
+    void clear();
+    bool isActive() const;
+    qint64 getResumeTime() const;
+    void setPaused(bool paused);
+    bool isPaused() const;
+    quint64 getPauseCount() const;
+
+    void inputEvent(const InputEvent& event) override;
+
+private:
+    std::atomic<qint64> lastActivity{0};
+    std::atomic<qint64> idleTime{1000000000};
+    std::atomic<bool> paused{false};
+    std::atomic<quint64> pauseCount{0};
+    bool isWatching = false;
+    bool hasAnchor = false;
+    QPoint anchor;
+};
+
+#endif // USEROVERRIDE_H
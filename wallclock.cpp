@@ -0,0 +1,65 @@
+#include "wallclock.h"
+#include <chrono>
+
+/**
+ * @brief Maps wall-clock times (system time) onto the steady clock used by the scheduler.
+ *
+ * @details The system clock can jump (time synchronization, manual changes), so deadlines are always kept on the
+ * steady clock. calibrate() reads the system clock between two steady readings several times and keeps the sample
+ * with the shortest bracket; the offset is taken at its midpoint and half the bracket is the remaining uncertainty.
+ */
+
+/**
+ * @brief Measures the offset between the system clock and the steady clock.
+ */
+
+void WallClock::calibrate(const EngineClock& steadyClock)
+{
+    qint64 bestBracket = -1;
+
+    for (int i = 0; i < samples; ++i)
+    {
+        qint64 before = steadyClock.now();
+        qint64 wallTime = currentWallTime();
+        qint64 after = steadyClock.now();
+
+        qint64 bracket = after - before;
+        if (bestBracket < 0 || bracket < bestBracket)
+        {
+            bestBracket = bracket;
+            offset = wallTime - (before + bracket / 2);
+        }
+    }
+
+    uncertainty = bestBracket / 2;
+}
+
+/**
+ * @brief Converts a wall-clock time into a steady clock time.
+ *
+ * @param wallTime Nanoseconds since the Unix epoch.
+ * @return The corresponding steady clock time in nanoseconds.
+ */
+
+qint64 WallClock::toSteady(qint64 wallTime) const
+{
+    return wallTime - offset;
+}
+
+/**
+ * @brief Returns the uncertainty of the last calibration in nanoseconds.
+ */
+
+qint64 WallClock::getUncertainty() const
+{
+    return uncertainty;
+}
+
+/**
+ * @brief Returns the current system time in nanoseconds since the Unix epoch.
+ */
+
+qint64 WallClock::currentWallTime()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,22 @@
+#ifndef WALLCLOCK_H
+#define WALLCLOCK_H
+
+#include "engineclock.h"
+
+class WallClock
+{
+public:
+    void calibrate(const EngineClock& steadyClock);
+    qint64 toSteady(qint64 wallTime) const;
+    qint64 getUncertainty() const;
+
+    static qint64 currentWallTime();
+
+private:
+    static constexpr int samples = 9;
+
+    qint64 offset = 0;
+    qint64 uncertainty = 0;
+};
+
+#endif // WALLCLOCK_H
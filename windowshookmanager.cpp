@@ -10,6 +10,7 @@
  *
  * @details Acts as a centralized manager for hook-based functionalities, overseeing keyboard and mouse hook operations.
  * Initializes and manages instances of HookWorker and GlobalMouseHook, handles keyboard mapping, and grabs cursor locations.
+ * The global mouse hook only runs while a cursor location is being picked.
  */
 
 WindowsHookManager* WindowsHookManager::instance = nullptr;
@@ -26,6 +27,7 @@ WindowsHookManager* WindowsHookManager::getInstance(QObject* parent)
 WindowsHookManager::WindowsHookManager(QObject *parent) : QObject(parent),
     hookWorker(new QThread(this)),
     hookWorkerInstance(new HookWorker()),
+    mouseHookInstance(nullptr),
     shouldGrabMouse(false)
 {
     keyMap =
@@ -111,17 +113,26 @@ void WindowsHookManager::updateKeyboardVirtualKeys(const QString& key = nullptr)
 
 /**
  * @brief Prepares to retrieve the cursor's location on the screen.
+ *
+ * @details Starts the global mouse hook with the live preview of the hovered coordinates. The hook object is
+ * created on first use on this (the hook manager's) thread, so its preview timer runs here.
  */
 
 void WindowsHookManager::prepareToGetCursorLocation()
 {
-    mouseHookInstance = GlobalMouseHook::getInstance();
-    connect(mouseHookInstance, &GlobalMouseHook::leftButtonClicked, this, &WindowsHookManager::getCursorLocationOnScreen);
+    if (!mouseHookInstance)
+    {
+        mouseHookInstance = GlobalMouseHook::getInstance();
+        connect(mouseHookInstance, &GlobalMouseHook::leftButtonClicked, this, &WindowsHookManager::getCursorLocationOnScreen);
+        connect(mouseHookInstance, &GlobalMouseHook::rightButtonClicked, this, &WindowsHookManager::cancelCursorLocation);
+        connect(mouseHookInstance, &GlobalMouseHook::mouseMoved, this, &WindowsHookManager::passCursorPreview);
+    }
     shouldGrabMouse = true;
+    mouseHookInstance->start(true);
 }
 
 /**
- * @brief Retrieves the cursor's location on the screen in response to a left button click.
+ * @brief Retrieves the cursor's location on the screen in response to a left button click and removes the mouse hook.
  */
 
 void WindowsHookManager::getCursorLocationOnScreen()
@@ -129,7 +140,7 @@ void WindowsHookManager::getCursorLocationOnScreen()
     if (shouldGrabMouse)
     {
         shouldGrabMouse = false;
-        disconnect(mouseHookInstance, &GlobalMouseHook::leftButtonClicked, this, &WindowsHookManager::getCursorLocationOnScreen);
+        mouseHookInstance->stop();
 
         POINT cursorPos;
         if (GetCursorPos(&cursorPos))
@@ -138,3 +149,17 @@ void WindowsHookManager::getCursorLocationOnScreen()
         }
     }
 }
+
+/**
+ * @brief Ends picking without a new location in response to a right button click and removes the mouse hook.
+ */
+
+void WindowsHookManager::cancelCursorLocation()
+{
+    if (shouldGrabMouse)
+    {
+        shouldGrabMouse = false;
+        mouseHookInstance->stop();
+        emit cursorLocationCancelled();
+    }
+}
@@ -20,9 +20,9 @@ private:
     QMap<QString, int> keyMap;
     QThread *hookWorker;
     HookWorker *hookWorkerInstance;
-    GlobalMouseHook* mouseHook;
     GlobalMouseHook* mouseHookInstance;
     void getCursorLocationOnScreen();
+    void cancelCursorLocation();
     bool shouldGrabMouse;
 
 public slots:
@@ -33,6 +33,8 @@ public slots:
 signals:
     void keyboardEventTriggered();
     void passCursorLocation(int x, int y);
+    void passCursorPreview(int x, int y);
+    void cursorLocationCancelled();
 };
 
 #endif // WINDOWSHOOKMANAGER_H
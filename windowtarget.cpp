@@ -0,0 +1,380 @@
+#include "windowtarget.h"
+#include <QDeadlineTimer>
+
+/**
+ * @brief Delivers input straight to one window instead of injecting it at the global cursor.
+ *
+ * @details The window is identified by a handle picked in the main window or by its title and class. It is looked
+ * up when a job starts and its client area is cached; two WinEvent hooks limited to the window's process, one for
+ * destruction and one for location changes, refresh the geometry when the window moves or resizes and drop the
+ * handle when the window is destroyed, so a click costs no window lookup, only the PostMessage calls. After the
+ * window is gone it is searched again at most once per retryInterval, so a restarted application is picked up
+ * while clicks in between are skipped. Points are client coordinates of the top-level window.
+ *
+ * Mouse messages go to the deepest visible child control under their point, with the point mapped into that
+ * child's client area, because a button, edit or canvas control never sees messages posted to its parent. The
+ * child of the last point is cached and dropped when a window of the process moves or is destroyed. Key messages
+ * go to the control that has the keyboard focus in the target's thread.
+ *
+ * The WinEvent hooks are out-of-context, so their callback runs on the thread that attached the target (the
+ * engine thread) from its event loop, and the cache needs no lock.
+ */
+
+WindowTarget* WindowTarget::active = nullptr;
+
+WindowTarget::~WindowTarget()
+{
+    detach();
+}
+
+/**
+ * @brief Sets which window receives the input; takes effect on the next attach().
+ *
+ * @param title The window title, or empty to match any title.
+ * @param className The window class, or empty to match any class.
+ * @param handle A window picked on screen, or 0; used while it exists, otherwise title and class are searched.
+ */
+
+void WindowTarget::setIdentity(const QString& title, const QString& className, qint64 handle)
+{
+    this->title = title;
+    this->className = className;
+    pickedWindow = reinterpret_cast<HWND>(static_cast<quintptr>(handle));
+}
+
+/**
+ * @brief Looks up the window and starts following its changes.
+ *
+ * @return True if the window was found; otherwise, false.
+ */
+
+bool WindowTarget::attach()
+{
+    detach();
+    active = this;
+    isAttached = true;
+    return resolve();
+}
+
+/**
+ * @brief Stops following the window and forgets it.
+ */
+
+void WindowTarget::detach()
+{
+    unhook();
+    if (active == this)
+    {
+        active = nullptr;
+    }
+    window = nullptr;
+    child = nullptr;
+    processId = 0;
+    threadId = 0;
+    clientRect = QRect();
+    isAttached = false;
+}
+
+/**
+ * @brief Posts messages to the window.
+ *
+ * @param messages The window messages.
+ * @param count The number of messages.
+ * @return True if all messages were posted; false if the window is gone.
+ *
+ * @details Mouse messages are routed to the child control under their point and key messages to the focused
+ * control; other messages go to the top-level window.
+ */
+
+bool WindowTarget::post(const Message *messages, int count)
+{
+    if (!isAttached)
+    {
+        return false;
+    }
+
+    if (window == nullptr)
+    {
+        qint64 now = QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs();
+        if (now - lastResolveTime < retryInterval || !resolve())
+        {
+            return false;
+        }
+    }
+
+    HWND focus = nullptr;
+    for (int i = 0; i < count; ++i)
+    {
+        HWND receiver = window;
+        LPARAM lParam = messages[i].lParam;
+        if (messages[i].message >= WM_MOUSEFIRST && messages[i].message <= WM_MOUSELAST)
+        {
+            QPoint position;
+            receiver = childAt(QPoint(static_cast<qint16>(LOWORD(lParam)), static_cast<qint16>(HIWORD(lParam))), position);
+            lParam = MAKELPARAM(static_cast<WORD>(static_cast<qint16>(position.x())), static_cast<WORD>(static_cast<qint16>(position.y())));
+        } else if (messages[i].message >= WM_KEYFIRST && messages[i].message <= WM_KEYLAST)
+        {
+            if (focus == nullptr)
+            {
+                focus = focusWindow();
+            }
+            receiver = focus;
+        }
+
+        if (!PostMessageW(receiver, messages[i].message, messages[i].wParam, lParam))
+        {
+            child = nullptr;
+            if (!IsWindow(window))
+            {
+                window = nullptr;
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Converts a point in client coordinates into virtual desktop pixels, using the cached geometry.
+ */
+
+QPoint WindowTarget::toScreen(const QPoint& point) const
+{
+    return point + clientRect.topLeft();
+}
+
+/**
+ * @brief Converts a point in virtual desktop pixels into client coordinates, using the cached geometry.
+ */
+
+QPoint WindowTarget::fromScreen(const QPoint& point) const
+{
+    return point - clientRect.topLeft();
+}
+
+/**
+ * @brief Returns the cached client area in virtual desktop pixels; empty while the window is not found.
+ */
+
+QRect WindowTarget::getClientRect() const
+{
+    return clientRect;
+}
+
+/**
+ * @brief Describes the window for the status display.
+ */
+
+QString WindowTarget::describe() const
+{
+    if (window == nullptr)
+    {
+        return "window not found";
+    }
+
+    wchar_t text[256] = {};
+    GetWindowTextW(window, text, 256);
+    return QString("\"%1\" %2x%3 at %4, %5").arg(QString::fromWCharArray(text)).arg(clientRect.width()).arg(clientRect.height())
+        .arg(clientRect.x()).arg(clientRect.y());
+}
+
+/**
+ * @brief Builds a mouse message.
+ *
+ * @param message WM_MOUSEMOVE or a button message.
+ * @param buttons The MK_ flags of the buttons held after the message.
+ * @param point The position in client coordinates.
+ */
+
+WindowTarget::Message WindowTarget::mouseMessage(UINT message, WPARAM buttons, const QPoint& point)
+{
+    return {message, buttons, MAKELPARAM(static_cast<WORD>(static_cast<qint16>(point.x())), static_cast<WORD>(static_cast<qint16>(point.y())))};
+}
+
+/**
+ * @brief Builds a key press or release message; the target's message loop translates presses into characters.
+ */
+
+WindowTarget::Message WindowTarget::keyMessage(int virtualKey, bool isDown)
+{
+    LPARAM lParam = 1 | (static_cast<LPARAM>(MapVirtualKeyW(static_cast<UINT>(virtualKey), MAPVK_VK_TO_VSC)) << 16);
+    if (!isDown)
+    {
+        lParam |= (LPARAM(1) << 30) | (LPARAM(1) << 31);
+    }
+    return {isDown ? static_cast<UINT>(WM_KEYDOWN) : static_cast<UINT>(WM_KEYUP), static_cast<WPARAM>(virtualKey), lParam};
+}
+
+/**
+ * @brief Builds a character message for a UTF-16 code unit.
+ */
+
+WindowTarget::Message WindowTarget::charMessage(quint16 character)
+{
+    return {WM_CHAR, character, 1};
+}
+
+/**
+ * @brief Looks the window up and caches its process and geometry.
+ */
+
+bool WindowTarget::resolve()
+{
+    lastResolveTime = QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs();
+    window = nullptr;
+    if (pickedWindow != nullptr && IsWindow(pickedWindow))
+    {
+        window = pickedWindow;
+    } else if (!title.isEmpty() || !className.isEmpty())
+    {
+        window = FindWindowW(className.isEmpty() ? nullptr : reinterpret_cast<LPCWSTR>(className.utf16()),
+                             title.isEmpty() ? nullptr : reinterpret_cast<LPCWSTR>(title.utf16()));
+    }
+
+    if (window == nullptr)
+    {
+        clientRect = QRect();
+        return false;
+    }
+
+    DWORD newProcessId = 0;
+    threadId = GetWindowThreadProcessId(window, &newProcessId);
+    child = nullptr;
+    watchProcess(newProcessId);
+    refreshGeometry();
+    return true;
+}
+
+/**
+ * @brief Reads the client area of the window.
+ */
+
+void WindowTarget::refreshGeometry()
+{
+    RECT rect = {};
+    POINT origin = {0, 0};
+    if (window == nullptr || !GetClientRect(window, &rect) || !ClientToScreen(window, &origin))
+    {
+        return;
+    }
+    clientRect = QRect(origin.x, origin.y, rect.right - rect.left, rect.bottom - rect.top);
+}
+
+/**
+ * @brief Follows the destruction and location events of the process owning the window, replacing the hooks of a
+ * previous process.
+ *
+ * @details Only these two events are registered, each with its own hook, because every event in a registered
+ * range is delivered to the engine thread, and the range between them holds focus, selection, state and value
+ * changes.
+ */
+
+void WindowTarget::watchProcess(DWORD newProcessId)
+{
+    if (destroyHook != nullptr && newProcessId == processId)
+    {
+        return;
+    }
+
+    unhook();
+    processId = newProcessId;
+    destroyHook = SetWinEventHook(EVENT_OBJECT_DESTROY, EVENT_OBJECT_DESTROY, nullptr, eventProc, processId, 0, WINEVENT_OUTOFCONTEXT);
+    locationHook = SetWinEventHook(EVENT_OBJECT_LOCATIONCHANGE, EVENT_OBJECT_LOCATIONCHANGE, nullptr, eventProc, processId, 0, WINEVENT_OUTOFCONTEXT);
+}
+
+/**
+ * @brief Removes the WinEvent hooks.
+ */
+
+void WindowTarget::unhook()
+{
+    for (HWINEVENTHOOK *hook : {&destroyHook, &locationHook})
+    {
+        if (*hook != nullptr)
+        {
+            UnhookWinEvent(*hook);
+            *hook = nullptr;
+        }
+    }
+}
+
+/**
+ * @brief Finds the deepest visible, enabled child control under a point.
+ *
+ * @param point The point in client coordinates of the top-level window.
+ * @param childPosition Receives the point in client coordinates of the returned window.
+ * @return The child control, or the top-level window if there is none.
+ */
+
+HWND WindowTarget::childAt(const QPoint& point, QPoint& childPosition)
+{
+    if (child != nullptr && point == childPoint && IsWindowVisible(child))
+    {
+        childPosition = point + childOffset;
+        return child;
+    }
+
+    HWND parent = window;
+    POINT position = {point.x(), point.y()};
+    for (;;)
+    {
+        HWND next = ChildWindowFromPointEx(parent, position, CWP_SKIPINVISIBLE | CWP_SKIPDISABLED | CWP_SKIPTRANSPARENT);
+        if (next == nullptr || next == parent)
+        {
+            break;
+        }
+        MapWindowPoints(parent, next, &position, 1);
+        parent = next;
+    }
+
+    child = parent;
+    childPoint = point;
+    childOffset = QPoint(position.x, position.y) - point;
+    childPosition = QPoint(position.x, position.y);
+    return child;
+}
+
+/**
+ * @brief Returns the control with the keyboard focus in the window's thread, or the window itself.
+ */
+
+HWND WindowTarget::focusWindow() const
+{
+    GUITHREADINFO info = {};
+    info.cbSize = sizeof(info);
+    if (GetGUIThreadInfo(threadId, &info) && info.hwndFocus != nullptr
+        && (info.hwndFocus == window || IsChild(window, info.hwndFocus)))
+    {
+        return info.hwndFocus;
+    }
+    return window;
+}
+
+/**
+ * @brief WinEvent hook: refreshes the cached geometry when the window moves or resizes and drops the handle when
+ * it is destroyed. Moving or destroying any other window of the process drops the cached child control, since the
+ * control under the last point may have changed. Events of non-window objects are ignored.
+ */
+
+void CALLBACK WindowTarget::eventProc(HWINEVENTHOOK, DWORD event, HWND window, LONG objectId, LONG childId, DWORD, DWORD)
+{
+    if (active == nullptr || active->window == nullptr || objectId != OBJID_WINDOW || childId != CHILDID_SELF)
+    {
+        return;
+    }
+
+    active->child = nullptr;
+    if (window != active->window)
+    {
+        return;
+    }
+
+    if (event == EVENT_OBJECT_DESTROY)
+    {
+        active->window = nullptr;
+        active->clientRect = QRect();
+    } else
+    {
+        active->refreshGeometry();
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef WINDOWTARGET_H
+#define WINDOWTARGET_H
+
+#include <QPoint>
+#include <QRect>
+#include <QString>
+#include <Windows.h>
+
+class WindowTarget
+{
+public:
+    struct Message {
+        UINT message;
+        WPARAM wParam;
+        LPARAM lParam;
+    };
+
+    static constexpr qint64 retryInterval = 1000000000;
+
+    ~WindowTarget();
+
+    void setIdentity(const QString& title, const QString& className, qint64 handle);
+    bool attach();
+    void detach();
+    bool post(const Message *messages, int count);
+    QPoint toScreen(const QPoint& point) const;
+    QPoint fromScreen(const QPoint& point) const;
+    QRect getClientRect() const;
+    QString describe() const;
+
+    static Message mouseMessage(UINT message, WPARAM buttons, const QPoint& point);
+    static Message keyMessage(int virtualKey, bool isDown);
+    static Message charMessage(quint16 character);
+
+private:
+    static WindowTarget* active;
+    static void CALLBACK eventProc(HWINEVENTHOOK hook, DWORD event, HWND window, LONG objectId, LONG childId, DWORD threadId, DWORD time);
+
+    QString title;
+    QString className;
+    HWND pickedWindow = nullptr;
+    HWND window = nullptr;
+    DWORD processId = 0;
+    DWORD threadId = 0;
+    HWINEVENTHOOK destroyHook = nullptr;
+    HWINEVENTHOOK locationHook = nullptr;
+    QRect clientRect;
+    qint64 lastResolveTime = 0;
+    bool isAttached = false;
+    HWND child = nullptr;
+    QPoint childPoint;
+    QPoint childOffset;
+
+    bool resolve();
+    void refreshGeometry();
+    void watchProcess(DWORD newProcessId);
+    void unhook();
+    HWND childAt(const QPoint& point, QPoint& childPosition);
+    HWND focusWindow() const;
+};
+
+#endif // WINDOWTARGET_H